@@ -0,0 +1,241 @@
+//! Polyhedra shared by the benchmarks.
+//!
+//! Synthetic set packing, knapsack and configurator-like families are built
+//! deterministically at several sizes. When `BENCH_CAPTURE` points at a JSONL
+//! file of recorded `/solve` request bodies, those are added as well.
+
+// Each bench target uses a different part of this module
+#![allow(dead_code)]
+
+use rust_solver_api::models::{
+    ApiIntegerSparseMatrix, ApiObjectives, ApiShape, ApiVariable, ObjectiveOwned, SolveRequest,
+    SolverDirection, SparseLEIntegerPolyhedron,
+};
+use std::collections::HashMap;
+use std::sync::Arc;
+
+/// Variable counts of the synthetic families
+pub const SIZES: [usize; 3] = [100, 1_000, 5_000];
+
+/// Objectives per request in multi-objective benchmarks
+pub const MULTI_OBJECTIVES: usize = 16;
+
+pub struct Fixture {
+    pub name: String,
+    pub polyhedron: SparseLEIntegerPolyhedron,
+    pub direction: SolverDirection,
+    /// Objectives of recorded requests; synthetic fixtures generate theirs
+    recorded: Option<ApiObjectives>,
+}
+
+impl Fixture {
+    /// `count` objectives for this polyhedron, the recorded ones if any
+    pub fn objectives(&self, count: usize) -> ApiObjectives {
+        match &self.recorded {
+            Some(objectives) => objectives.clone(),
+            None => random_objectives(&self.polyhedron.variables, count).into(),
+        }
+    }
+
+    /// The fixture as a complete solve request
+    pub fn request(&self) -> SolveRequest {
+        SolveRequest {
+            polyhedron: Arc::new(self.polyhedron.clone()),
+            objectives: self.objectives(1),
+            direction: self.direction,
+            hint: None,
+            time_limit_ms: None,
+            mip_gap: None,
+        }
+    }
+}
+
+/// Small deterministic generator so fixtures are identical across runs
+struct Lcg(u64);
+
+impl Lcg {
+    fn next(&mut self) -> u64 {
+        self.0 = self
+            .0
+            .wrapping_mul(6_364_136_223_846_793_005)
+            .wrapping_add(1_442_695_040_888_963_407);
+        self.0 >> 33
+    }
+
+    fn below(&mut self, n: usize) -> usize {
+        (self.next() % n as u64) as usize
+    }
+}
+
+/// Sparse constraint rows collected in coordinate form
+#[derive(Default)]
+struct Rows {
+    rows: Vec<i32>,
+    cols: Vec<i32>,
+    vals: Vec<i32>,
+    b: Vec<i32>,
+}
+
+impl Rows {
+    fn push(&mut self, entries: &[(usize, i32)], rhs: i32) {
+        let row = self.b.len() as i32;
+        for &(col, val) in entries {
+            self.rows.push(row);
+            self.cols.push(col as i32);
+            self.vals.push(val);
+        }
+        self.b.push(rhs);
+    }
+
+    fn into_polyhedron(self, variables: Vec<ApiVariable>) -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                shape: ApiShape {
+                    nrows: self.b.len(),
+                    ncols: variables.len(),
+                },
+                rows: self.rows,
+                cols: self.cols,
+                vals: self.vals,
+            },
+            b: self.b,
+            variables,
+        }
+    }
+}
+
+fn binaries(n: usize) -> Vec<ApiVariable> {
+    (0..n)
+        .map(|i| ApiVariable {
+            id: format!("x{}", i),
+            bound: (0, 1),
+        })
+        .collect()
+}
+
+/// Sets over `n / 2` elements, each set covering three of them; every
+/// element may be picked at most once
+fn set_packing(n: usize, rng: &mut Lcg) -> SparseLEIntegerPolyhedron {
+    let elements = (n / 2).max(1);
+    let mut members: Vec<Vec<(usize, i32)>> = vec![Vec::new(); elements];
+    for set in 0..n {
+        for _ in 0..3 {
+            members[rng.below(elements)].push((set, 1));
+        }
+    }
+
+    let mut rows = Rows::default();
+    for mut entries in members {
+        entries.sort_unstable();
+        entries.dedup();
+        if !entries.is_empty() {
+            rows.push(&entries, 1);
+        }
+    }
+    rows.into_polyhedron(binaries(n))
+}
+
+/// Integer items (0..=3 copies each) in four knapsacks of half the total weight
+fn knapsack(n: usize, rng: &mut Lcg) -> SparseLEIntegerPolyhedron {
+    let mut rows = Rows::default();
+    for _ in 0..4 {
+        let weights: Vec<(usize, i32)> = (0..n).map(|i| (i, 1 + rng.below(20) as i32)).collect();
+        let capacity = weights.iter().map(|&(_, w)| w).sum::<i32>() / 2;
+        rows.push(&weights, capacity);
+    }
+    let variables = (0..n)
+        .map(|i| ApiVariable {
+            id: format!("x{}", i),
+            bound: (0, 3),
+        })
+        .collect();
+    rows.into_polyhedron(variables)
+}
+
+/// Feature groups of eight binaries with exactly-one choices, plus random
+/// requires (`a <= b`) and excludes (`a + b <= 1`) rules between features
+fn configurator(n: usize, rng: &mut Lcg) -> SparseLEIntegerPolyhedron {
+    let mut rows = Rows::default();
+    for start in (0..n).step_by(8) {
+        let group: Vec<usize> = (start..(start + 8).min(n)).collect();
+        let pick: Vec<(usize, i32)> = group.iter().map(|&i| (i, 1)).collect();
+        let at_least: Vec<(usize, i32)> = group.iter().map(|&i| (i, -1)).collect();
+        rows.push(&pick, 1);
+        rows.push(&at_least, -1);
+    }
+    for _ in 0..n / 2 {
+        let (a, b) = (rng.below(n), rng.below(n));
+        if a / 8 == b / 8 {
+            continue;
+        }
+        if rng.below(2) == 0 {
+            rows.push(&[(a, 1), (b, -1)], 0);
+        } else {
+            rows.push(&[(a, 1), (b, 1)], 1);
+        }
+    }
+    rows.into_polyhedron(binaries(n))
+}
+
+/// Objectives with random integer weights on a quarter of the variables
+pub fn random_objectives(variables: &[ApiVariable], count: usize) -> Vec<ObjectiveOwned> {
+    let mut rng = Lcg(count as u64 ^ variables.len() as u64);
+    (0..count)
+        .map(|_| {
+            let mut objective = HashMap::new();
+            for _ in 0..(variables.len() / 4).max(1) {
+                let variable = &variables[rng.below(variables.len())];
+                objective.insert(variable.id.clone(), (1 + rng.below(10)) as f64);
+            }
+            objective
+        })
+        .collect()
+}
+
+/// Synthetic fixtures at every size in `SIZES`, then any recorded requests
+pub fn fixtures() -> Vec<Fixture> {
+    let families: [(&str, fn(usize, &mut Lcg) -> SparseLEIntegerPolyhedron); 3] = [
+        ("set_packing", set_packing),
+        ("knapsack", knapsack),
+        ("configurator", configurator),
+    ];
+
+    let mut fixtures = Vec::new();
+    for (family, build) in families {
+        for n in SIZES {
+            fixtures.push(Fixture {
+                name: format!("{}/{}", family, n),
+                polyhedron: build(n, &mut Lcg(n as u64)),
+                direction: SolverDirection::Maximize,
+                recorded: None,
+            });
+        }
+    }
+    fixtures.extend(recorded());
+    fixtures
+}
+
+/// Requests from the `BENCH_CAPTURE` file, one JSON request body per line
+fn recorded() -> Vec<Fixture> {
+    let Ok(path) = std::env::var("BENCH_CAPTURE") else {
+        return Vec::new();
+    };
+    let capture = std::fs::read_to_string(&path)
+        .unwrap_or_else(|e| panic!("Failed to read BENCH_CAPTURE {}: {}", path, e));
+
+    capture
+        .lines()
+        .filter(|line| !line.trim().is_empty())
+        .enumerate()
+        .map(|(i, line)| {
+            let request: SolveRequest = serde_json::from_str(line)
+                .unwrap_or_else(|e| panic!("Invalid request on line {}: {}", i + 1, e));
+            Fixture {
+                name: format!("recorded/{}", i + 1),
+                polyhedron: request.polyhedron,
+                direction: request.direction,
+                recorded: Some(request.objectives),
+            }
+        })
+        .collect()
+}
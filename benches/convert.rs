@@ -0,0 +1,86 @@
+//! Request handling outside the solvers: fingerprinting, validation and the
+//! conversions in `convert.rs`.
+
+mod common;
+
+use criterion::{black_box, criterion_group, criterion_main, BatchSize, BenchmarkId, Criterion};
+use rust_solver_api::convert::{copy_glpk_polyhedron, into_glpk_polyhedron, to_column_values};
+use rust_solver_api::domain::columns::ColumnIndex;
+use rust_solver_api::domain::fingerprint::Fingerprint;
+use rust_solver_api::domain::validate::validate_solve_request;
+use std::collections::HashMap;
+
+fn request_handling(c: &mut Criterion) {
+    let fixtures = common::fixtures();
+
+    let mut group = c.benchmark_group("request");
+    for fixture in &fixtures {
+        let request = fixture.request();
+        group.bench_function(BenchmarkId::new("validate", &fixture.name), |b| {
+            b.iter(|| validate_solve_request(black_box(&request)).is_ok())
+        });
+        group.bench_function(BenchmarkId::new("fingerprint", &fixture.name), |b| {
+            b.iter(|| Fingerprint::of(black_box(&fixture.polyhedron)))
+        });
+        group.bench_function(BenchmarkId::new("resolve_objectives", &fixture.name), |b| {
+            b.iter_batched(
+                || fixture.objectives(common::MULTI_OBJECTIVES),
+                |objectives| {
+                    ColumnIndex::new(&fixture.polyhedron.variables)
+                        .resolve(objectives)
+                        .is_ok()
+                },
+                BatchSize::LargeInput,
+            )
+        });
+    }
+    group.finish();
+}
+
+fn conversions(c: &mut Criterion) {
+    let fixtures = common::fixtures();
+
+    let mut group = c.benchmark_group("convert");
+    for fixture in &fixtures {
+        let polyhedron = &fixture.polyhedron;
+        group.bench_function(
+            BenchmarkId::new("into_glpk_polyhedron", &fixture.name),
+            |b| {
+                b.iter_batched(
+                    || (polyhedron.a.clone(), polyhedron.b.clone()),
+                    |(a, b)| {
+                        into_glpk_polyhedron(a, b, &polyhedron.variables)
+                            .a
+                            .vals
+                            .len()
+                    },
+                    BatchSize::LargeInput,
+                )
+            },
+        );
+
+        let glpk = into_glpk_polyhedron(
+            polyhedron.a.clone(),
+            polyhedron.b.clone(),
+            &polyhedron.variables,
+        );
+        group.bench_function(
+            BenchmarkId::new("copy_glpk_polyhedron", &fixture.name),
+            |b| b.iter(|| copy_glpk_polyhedron(black_box(&glpk)).a.vals.len()),
+        );
+
+        let hint: HashMap<String, i32> = polyhedron
+            .variables
+            .iter()
+            .step_by(2)
+            .map(|v| (v.id.clone(), 1))
+            .collect();
+        group.bench_function(BenchmarkId::new("to_column_values", &fixture.name), |b| {
+            b.iter(|| to_column_values(&polyhedron.variables, black_box(&hint)))
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, request_handling, conversions);
+criterion_main!(benches);
@@ -0,0 +1,122 @@
+//! Solver backends through the `Solver` trait: cold solves without a model
+//! cache, cache-hit solves on a warmed cache and multi-objective requests.
+//!
+//! HiGHS and Gurobi are included when their features are enabled, e.g.
+//! `cargo bench --bench solvers --features highs-solver`.
+
+mod common;
+
+use common::{Fixture, MULTI_OBJECTIVES};
+use criterion::{criterion_group, criterion_main, BatchSize, BenchmarkId, Criterion};
+use rust_solver_api::domain::fingerprint::Fingerprint;
+use rust_solver_api::domain::model_cache::ModelCacheConfig;
+use rust_solver_api::domain::solver::{SolveOptions, Solver};
+use rust_solver_api::domain::solver_factory::{create_solver_with_cache, SolverType};
+use std::sync::Arc;
+
+fn cached(solver_type: SolverType) -> Box<dyn Solver> {
+    create_solver_with_cache(solver_type, Some(ModelCacheConfig::with_capacity(64)), 1)
+        .unwrap_or_else(|e| panic!("{}", e.details))
+}
+
+/// Solve `objectives` objectives of `fixture`, cloning the inputs outside the measurement
+fn bench_solve(
+    c: &mut Criterion,
+    group_name: &str,
+    solver: &dyn Solver,
+    fixtures: &[Fixture],
+    objectives: usize,
+    options: SolveOptions,
+) {
+    let mut group = c.benchmark_group(group_name);
+    group.sample_size(10);
+    for fixture in fixtures {
+        let fingerprint = Fingerprint::of(&fixture.polyhedron);
+        let objectives = fixture.objectives(objectives);
+        group.bench_function(BenchmarkId::new(solver.name(), &fixture.name), |b| {
+            b.iter_batched(
+                || (Arc::new(fixture.polyhedron.clone()), objectives.clone()),
+                |(polyhedron, objectives)| {
+                    solver.solve(
+                        polyhedron,
+                        fingerprint,
+                        objectives,
+                        fixture.direction,
+                        options.clone(),
+                    )
+                },
+                BatchSize::LargeInput,
+            )
+        });
+    }
+    group.finish();
+}
+
+fn cold_solves(c: &mut Criterion) {
+    let fixtures = common::fixtures();
+    for solver_type in SolverType::backends() {
+        let solver = create_solver_with_cache(solver_type, None, 1)
+            .unwrap_or_else(|e| panic!("{}", e.details));
+        bench_solve(
+            c,
+            "cold",
+            solver.as_ref(),
+            &fixtures,
+            1,
+            SolveOptions::default(),
+        );
+    }
+}
+
+fn cache_hit_solves(c: &mut Criterion) {
+    let fixtures = common::fixtures();
+    for solver_type in SolverType::backends() {
+        // Solve every fixture once so the measured solves hit the model cache
+        let solver = cached(solver_type);
+        for fixture in &fixtures {
+            let _ = solver.solve(
+                Arc::new(fixture.polyhedron.clone()),
+                Fingerprint::of(&fixture.polyhedron),
+                fixture.objectives(1),
+                fixture.direction,
+                SolveOptions::default(),
+            );
+        }
+        bench_solve(
+            c,
+            "cache_hit",
+            solver.as_ref(),
+            &fixtures,
+            1,
+            SolveOptions::default(),
+        );
+    }
+}
+
+fn multi_objective_solves(c: &mut Criterion) {
+    let fixtures = common::fixtures();
+    for solver_type in SolverType::backends() {
+        let solver = cached(solver_type);
+        for parallelism in [1, 4] {
+            bench_solve(
+                c,
+                &format!("multi_objective/parallelism_{}", parallelism),
+                solver.as_ref(),
+                &fixtures,
+                MULTI_OBJECTIVES,
+                SolveOptions {
+                    parallelism,
+                    ..SolveOptions::default()
+                },
+            );
+        }
+    }
+}
+
+criterion_group!(
+    benches,
+    cold_solves,
+    cache_hit_solves,
+    multi_objective_solves
+);
+criterion_main!(benches);
@@ -1,4 +1,4 @@
-use glpk_api_sdk::{GlpkClient, SolveRequestBuilder, SolverDirection, Variable};
+use glpk_api_sdk::{GlpkClient, SolutionValues, SolveRequestBuilder, SolverDirection, Variable};
 
 #[tokio::main]
 async fn main() -> Result<(), Box<dyn std::error::Error>> {
@@ -57,8 +57,10 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
         println!("  Status: {:?}", solution.status);
         println!("  Objective value: {}", solution.objective);
         println!("  Variables:");
-        for (var, value) in &solution.solution {
-            println!("    {} = {}", var, value);
+        if let SolutionValues::Named(values) = &solution.solution {
+            for (var, value) in values {
+                println!("    {} = {}", var, value);
+            }
         }
         if let Some(ref error) = solution.error {
             println!("  Error: {}", error);
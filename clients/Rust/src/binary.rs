@@ -0,0 +1,341 @@
+//! Compact binary wire format understood by the API's `/solve` endpoint.
+//!
+//! Requests send `A`, `b` and the bounds as raw little-endian `i32` arrays,
+//! avoiding the cost of decimal JSON arrays for large polyhedra. Objectives
+//! and hints refer to variables by their index in the request. See the
+//! server's `src/binary.rs` for the byte layout.
+
+use crate::error::{GlpkError, Result};
+use crate::types::{
+    Objectives, Solution, SolutionValues, SolveRequest, SolveResponse, SolverDirection, Status,
+};
+use std::collections::HashMap;
+
+/// Content type of the binary wire format
+pub const CONTENT_TYPE: &str = "application/x-solver-binary";
+
+const REQUEST_MAGIC: &[u8; 4] = b"SLVQ";
+const RESPONSE_MAGIC: &[u8; 4] = b"SLVR";
+const VERSION: u8 = 1;
+/// Request version that carries the solve limits, only sent when one is set
+const LIMITS_VERSION: u8 = 2;
+
+fn put_u32(out: &mut Vec<u8>, value: u32) {
+    out.extend_from_slice(&value.to_le_bytes());
+}
+
+fn put_i32s(out: &mut Vec<u8>, values: &[i32]) {
+    put_u32(out, values.len() as u32);
+    for value in values {
+        out.extend_from_slice(&value.to_le_bytes());
+    }
+}
+
+/// Encode a request in the binary wire format
+pub fn encode_request(request: &SolveRequest) -> Result<Vec<u8>> {
+    let polyhedron = &request.polyhedron;
+    let a = &polyhedron.a;
+    let index: HashMap<&str, u32> = polyhedron
+        .variables
+        .iter()
+        .enumerate()
+        .map(|(i, v)| (v.id.as_str(), i as u32))
+        .collect();
+    let variable_index = |id: &str| {
+        index.get(id).copied().ok_or_else(|| {
+            GlpkError::InvalidRequest(format!("Unknown variable {} in objective or hint", id))
+        })
+    };
+
+    let mut out = Vec::with_capacity(32 + 12 * a.vals.len() + 4 * polyhedron.b.len());
+    let has_limits = request.time_limit_ms.is_some() || request.mip_gap.is_some();
+    out.extend_from_slice(REQUEST_MAGIC);
+    out.push(if has_limits { LIMITS_VERSION } else { VERSION });
+    out.push(match request.direction {
+        SolverDirection::Maximize => 0,
+        SolverDirection::Minimize => 1,
+    });
+    put_u32(&mut out, a.shape.nrows as u32);
+    put_u32(&mut out, a.shape.ncols as u32);
+    put_i32s(&mut out, &a.rows);
+    put_i32s(&mut out, &a.cols);
+    put_i32s(&mut out, &a.vals);
+    put_i32s(&mut out, &polyhedron.b);
+
+    put_u32(&mut out, polyhedron.variables.len() as u32);
+    for variable in &polyhedron.variables {
+        put_u32(&mut out, variable.id.len() as u32);
+        out.extend_from_slice(variable.id.as_bytes());
+        out.extend_from_slice(&variable.bound.0.to_le_bytes());
+        out.extend_from_slice(&variable.bound.1.to_le_bytes());
+    }
+
+    put_u32(&mut out, request.objectives.len() as u32);
+    match &request.objectives {
+        Objectives::Named(objectives) => {
+            for objective in objectives {
+                put_u32(&mut out, objective.len() as u32);
+                for id in objective.keys() {
+                    put_u32(&mut out, variable_index(id)?);
+                }
+                put_u32(&mut out, objective.len() as u32);
+                for coefficient in objective.values() {
+                    out.extend_from_slice(&coefficient.to_le_bytes());
+                }
+            }
+        }
+        Objectives::Indexed(objectives) => {
+            for objective in objectives {
+                put_u32(&mut out, objective.len() as u32);
+                for &(column, _) in objective {
+                    if column >= polyhedron.variables.len() {
+                        return Err(GlpkError::InvalidRequest(format!(
+                            "Objective variable index {} out of range",
+                            column
+                        )));
+                    }
+                    put_u32(&mut out, column as u32);
+                }
+                put_u32(&mut out, objective.len() as u32);
+                for (_, coefficient) in objective {
+                    out.extend_from_slice(&coefficient.to_le_bytes());
+                }
+            }
+        }
+    }
+
+    match &request.hint {
+        Some(hint) => {
+            out.push(1);
+            put_u32(&mut out, hint.len() as u32);
+            for id in hint.keys() {
+                put_u32(&mut out, variable_index(id)?);
+            }
+            put_i32s(&mut out, &hint.values().copied().collect::<Vec<_>>());
+        }
+        None => out.push(0),
+    }
+
+    if has_limits {
+        match request.time_limit_ms {
+            Some(ms) => {
+                out.push(1);
+                out.extend_from_slice(&ms.to_le_bytes());
+            }
+            None => out.push(0),
+        }
+        match request.mip_gap {
+            Some(gap) => {
+                out.push(1);
+                out.extend_from_slice(&gap.to_le_bytes());
+            }
+            None => out.push(0),
+        }
+    }
+
+    Ok(out)
+}
+
+/// Cursor over a binary response body
+struct Reader<'a> {
+    buf: &'a [u8],
+}
+
+impl<'a> Reader<'a> {
+    fn take(&mut self, len: usize) -> Result<&'a [u8]> {
+        if len > self.buf.len() {
+            return Err(GlpkError::ParseError(
+                "Unexpected end of binary response".to_string(),
+            ));
+        }
+        let (head, tail) = self.buf.split_at(len);
+        self.buf = tail;
+        Ok(head)
+    }
+
+    fn u8(&mut self) -> Result<u8> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn u32(&mut self) -> Result<u32> {
+        Ok(u32::from_le_bytes(
+            self.take(4)?.try_into().expect("4 bytes"),
+        ))
+    }
+
+    fn i32(&mut self) -> Result<i32> {
+        Ok(self.u32()? as i32)
+    }
+}
+
+fn status_from_code(code: u8) -> Result<Status> {
+    Ok(match code {
+        1 => Status::Undefined,
+        2 => Status::Feasible,
+        3 => Status::Infeasible,
+        4 => Status::NoFeasible,
+        5 => Status::Optimal,
+        6 => Status::Unbounded,
+        7 => Status::SimplexFailed,
+        8 => Status::MIPFailed,
+        9 => Status::EmptySpace,
+        10 => Status::TimeLimit,
+        other => {
+            return Err(GlpkError::ParseError(format!(
+                "Unknown solution status {}",
+                other
+            )))
+        }
+    })
+}
+
+/// Decode a binary response whose values follow the order of `variable_ids`
+///
+/// With `dense`, values are returned as `SolutionValues::Dense` in that order.
+pub fn decode_response(buf: &[u8], variable_ids: &[&str], dense: bool) -> Result<SolveResponse> {
+    let mut reader = Reader { buf };
+    if reader.take(4)? != RESPONSE_MAGIC || reader.u8()? != VERSION {
+        return Err(GlpkError::ParseError(
+            "Not a binary solve response".to_string(),
+        ));
+    }
+
+    let count = reader.u32()? as usize;
+    let mut solutions = Vec::with_capacity(count.min(buf.len()));
+    for _ in 0..count {
+        let status = status_from_code(reader.u8()?)?;
+        let objective = reader.i32()?;
+        let value_count = reader.u32()? as usize;
+        if value_count != variable_ids.len() {
+            return Err(GlpkError::ParseError(format!(
+                "Expected {} solution values, got {}",
+                variable_ids.len(),
+                value_count
+            )));
+        }
+        let solution = if dense {
+            let mut values = Vec::with_capacity(value_count);
+            for _ in 0..value_count {
+                values.push(reader.i32()? as i64);
+            }
+            SolutionValues::Dense(values)
+        } else {
+            let mut values = HashMap::with_capacity(value_count);
+            for id in variable_ids {
+                values.insert(id.to_string(), reader.i32()? as i64);
+            }
+            SolutionValues::Named(values)
+        };
+        let error = match reader.u8()? {
+            0 => None,
+            _ => {
+                let len = reader.u32()? as usize;
+                Some(String::from_utf8_lossy(reader.take(len)?).into_owned())
+            }
+        };
+        solutions.push(Solution {
+            status,
+            objective,
+            solution,
+            error,
+        });
+    }
+
+    Ok(SolveResponse { solutions })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{SolveRequestBuilder, Variable};
+
+    #[test]
+    fn test_encode_request_layout() {
+        let request = SolveRequestBuilder::new()
+            .add_variable(Variable::new("x1", 0, 3))
+            .add_constraint(vec![0], vec![0], vec![1], 2)
+            .add_objective([("x1".to_string(), 1.0)].into())
+            .direction(SolverDirection::Minimize)
+            .build()
+            .unwrap();
+
+        let encoded = encode_request(&request).unwrap();
+        assert_eq!(&encoded[..4], REQUEST_MAGIC);
+        assert_eq!(encoded[4], VERSION);
+        assert_eq!(encoded[5], 1);
+        // nrows, ncols, then the three one-element A arrays
+        assert_eq!(&encoded[6..14], &[1, 0, 0, 0, 1, 0, 0, 0]);
+        assert_eq!(&encoded[14..22], &[1, 0, 0, 0, 0, 0, 0, 0]);
+        assert_eq!(*encoded.last().unwrap(), 0);
+    }
+
+    #[test]
+    fn test_encode_request_with_limits() {
+        let request = SolveRequestBuilder::new()
+            .add_variable(Variable::new("x1", 0, 3))
+            .add_constraint(vec![0], vec![0], vec![1], 2)
+            .add_objective([("x1".to_string(), 1.0)].into())
+            .direction(SolverDirection::Minimize)
+            .time_limit_ms(250)
+            .build()
+            .unwrap();
+
+        let encoded = encode_request(&request).unwrap();
+        assert_eq!(encoded[4], LIMITS_VERSION);
+        // Hint flag, time limit flag and milliseconds, MIP gap flag
+        let tail = &encoded[encoded.len() - 11..];
+        assert_eq!(tail[..2], [0, 1]);
+        assert_eq!(tail[2..10], 250u64.to_le_bytes());
+        assert_eq!(tail[10], 0);
+    }
+
+    #[test]
+    fn test_encode_request_rejects_unknown_objective_variable() {
+        let mut request = SolveRequestBuilder::new()
+            .add_variable(Variable::new("x1", 0, 3))
+            .add_constraint(vec![0], vec![0], vec![1], 2)
+            .add_objective([("x1".to_string(), 1.0)].into())
+            .direction(SolverDirection::Maximize)
+            .build()
+            .unwrap();
+        if let Objectives::Named(objectives) = &mut request.objectives {
+            objectives[0].insert("missing".to_string(), 1.0);
+        }
+        assert!(encode_request(&request).is_err());
+
+        request.objectives = Objectives::Indexed(vec![vec![(1, 1.0)]]);
+        assert!(encode_request(&request).is_err());
+    }
+
+    #[test]
+    fn test_decode_response() {
+        let mut buf = Vec::new();
+        buf.extend_from_slice(RESPONSE_MAGIC);
+        buf.push(VERSION);
+        put_u32(&mut buf, 1);
+        buf.push(5);
+        buf.extend_from_slice(&7i32.to_le_bytes());
+        put_i32s(&mut buf, &[3, 1]);
+        buf.push(0);
+
+        let response = decode_response(&buf, &["x1", "x2"], false).unwrap();
+        assert_eq!(response.solutions.len(), 1);
+        let solution = &response.solutions[0];
+        assert_eq!(solution.status, Status::Optimal);
+        assert_eq!(solution.objective, 7);
+        assert_eq!(
+            solution.solution,
+            SolutionValues::Named(HashMap::from([
+                ("x1".to_string(), 3),
+                ("x2".to_string(), 1)
+            ]))
+        );
+        assert!(solution.error.is_none());
+
+        let dense = decode_response(&buf, &["x1", "x2"], true).unwrap();
+        assert_eq!(
+            dense.solutions[0].solution,
+            SolutionValues::Dense(vec![3, 1])
+        );
+    }
+}
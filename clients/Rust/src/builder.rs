@@ -1,8 +1,9 @@
 use crate::error::{GlpkError, Result};
 use crate::types::{
-    IntegerSparseMatrix, Objective, Shape, SolveRequest, SolverDirection,
-    SparseLEIntegerPolyhedron, Variable,
+    IndexedObjective, IntegerSparseMatrix, ModelSolveRequest, Objective, Objectives, Shape,
+    SolveRequest, SolverDirection, SparseLEIntegerPolyhedron, Variable,
 };
+use std::collections::HashMap;
 
 /// Builder for constructing solve requests with a fluent API
 #[derive(Debug, Default)]
@@ -13,7 +14,11 @@ pub struct SolveRequestBuilder {
     constraint_vals: Vec<i32>,
     b: Vec<i32>,
     objectives: Vec<Objective>,
+    indexed_objectives: Vec<IndexedObjective>,
     direction: Option<SolverDirection>,
+    hint: Option<HashMap<String, i32>>,
+    time_limit_ms: Option<u64>,
+    mip_gap: Option<f64>,
 }
 
 impl SolveRequestBuilder {
@@ -170,6 +175,26 @@ impl SolveRequestBuilder {
         self
     }
 
+    /// Add an objective function keyed by variable index
+    ///
+    /// Indexes refer to the order in which variables were added. Requests
+    /// with indexed objectives get solutions as `SolutionValues::Dense`.
+    /// Indexed and named objectives cannot be mixed in one request.
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// use glpk_api_sdk::SolveRequestBuilder;
+    ///
+    /// // Maximize x0 + 2 * x1
+    /// let builder = SolveRequestBuilder::new()
+    ///     .add_indexed_objective(vec![(0, 1.0), (1, 2.0)]);
+    /// ```
+    pub fn add_indexed_objective(mut self, objective: IndexedObjective) -> Self {
+        self.indexed_objectives.push(objective);
+        self
+    }
+
     /// Set the optimization direction
     ///
     /// # Example
@@ -185,6 +210,53 @@ impl SolveRequestBuilder {
         self
     }
 
+    /// Set a known feasible assignment the solver can use as MIP start
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// use glpk_api_sdk::SolveRequestBuilder;
+    /// use std::collections::HashMap;
+    ///
+    /// let builder = SolveRequestBuilder::new()
+    ///     .hint(HashMap::from([("x1".to_string(), 1)]));
+    /// ```
+    pub fn hint(mut self, hint: HashMap<String, i32>) -> Self {
+        self.hint = Some(hint);
+        self
+    }
+
+    /// Limit the wall-clock time of the whole request, in milliseconds
+    ///
+    /// Objectives still running when it ends return their best solution so
+    /// far with `Status::TimeLimit`. The server may enforce a lower limit.
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// use glpk_api_sdk::SolveRequestBuilder;
+    ///
+    /// let builder = SolveRequestBuilder::new().time_limit_ms(5_000);
+    /// ```
+    pub fn time_limit_ms(mut self, time_limit_ms: u64) -> Self {
+        self.time_limit_ms = Some(time_limit_ms);
+        self
+    }
+
+    /// Accept solutions within this relative gap of the optimum
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// use glpk_api_sdk::SolveRequestBuilder;
+    ///
+    /// let builder = SolveRequestBuilder::new().mip_gap(0.01);
+    /// ```
+    pub fn mip_gap(mut self, mip_gap: f64) -> Self {
+        self.mip_gap = Some(mip_gap);
+        self
+    }
+
     /// Build the solve request
     ///
     /// # Errors
@@ -192,25 +264,98 @@ impl SolveRequestBuilder {
     /// Returns an error if:
     /// - No variables have been added
     /// - No objectives have been added
+    /// - Both named and indexed objectives have been added
     /// - No direction has been set
     /// - The constraint matrix dimensions don't match
-    pub fn build(self) -> Result<SolveRequest> {
+    pub fn build(mut self) -> Result<SolveRequest> {
+        self.check_variables()?;
+        let request = self.take_model_request()?;
+        let polyhedron = self.take_polyhedron()?;
+        Ok(request.with_polyhedron(polyhedron))
+    }
+
+    /// Build only the polyhedron, for `GlpkClient::register_model`
+    ///
+    /// Objectives and direction are ignored.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if no variables have been added or the constraint
+    /// matrix dimensions don't match
+    pub fn build_polyhedron(mut self) -> Result<SparseLEIntegerPolyhedron> {
+        self.take_polyhedron()
+    }
+
+    /// Build only the objectives, direction, hint and limits, for
+    /// `GlpkClient::solve_model` against a registered polyhedron
+    ///
+    /// Variables and constraints are ignored.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if no objectives have been added, both named and
+    /// indexed objectives have been added or no direction has been set
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// use glpk_api_sdk::{SolveRequestBuilder, SolverDirection};
+    ///
+    /// let request = SolveRequestBuilder::new()
+    ///     .add_objective([("x1".to_string(), 1.0)].into())
+    ///     .direction(SolverDirection::Maximize)
+    ///     .build_model_request()
+    ///     .unwrap();
+    /// ```
+    pub fn build_model_request(mut self) -> Result<ModelSolveRequest> {
+        self.take_model_request()
+    }
+
+    fn check_variables(&self) -> Result<()> {
         if self.variables.is_empty() {
             return Err(GlpkError::InvalidRequest(
                 "At least one variable is required".to_string(),
             ));
         }
+        Ok(())
+    }
 
-        if self.objectives.is_empty() {
+    fn take_model_request(&mut self) -> Result<ModelSolveRequest> {
+        if self.objectives.is_empty() && self.indexed_objectives.is_empty() {
             return Err(GlpkError::InvalidRequest(
                 "At least one objective is required".to_string(),
             ));
         }
 
+        let objectives = match (
+            self.objectives.is_empty(),
+            self.indexed_objectives.is_empty(),
+        ) {
+            (false, false) => {
+                return Err(GlpkError::InvalidRequest(
+                    "Named and indexed objectives cannot be mixed".to_string(),
+                ))
+            }
+            (true, _) => Objectives::Indexed(std::mem::take(&mut self.indexed_objectives)),
+            (false, _) => Objectives::Named(std::mem::take(&mut self.objectives)),
+        };
+
         let direction = self.direction.ok_or_else(|| {
             GlpkError::InvalidRequest("Direction (maximize/minimize) must be set".to_string())
         })?;
 
+        Ok(ModelSolveRequest {
+            objectives,
+            direction,
+            hint: self.hint.take(),
+            time_limit_ms: self.time_limit_ms,
+            mip_gap: self.mip_gap,
+        })
+    }
+
+    fn take_polyhedron(&mut self) -> Result<SparseLEIntegerPolyhedron> {
+        self.check_variables()?;
+
         let nrows = self.b.len();
         let ncols = self.variables.len();
 
@@ -224,22 +369,16 @@ impl SolveRequestBuilder {
         }
 
         let matrix = IntegerSparseMatrix {
-            rows: self.constraint_rows,
-            cols: self.constraint_cols,
-            vals: self.constraint_vals,
+            rows: std::mem::take(&mut self.constraint_rows),
+            cols: std::mem::take(&mut self.constraint_cols),
+            vals: std::mem::take(&mut self.constraint_vals),
             shape: Shape { nrows, ncols },
         };
 
-        let polyhedron = SparseLEIntegerPolyhedron {
+        Ok(SparseLEIntegerPolyhedron {
             a: matrix,
-            b: self.b,
-            variables: self.variables,
-        };
-
-        Ok(SolveRequest {
-            polyhedron,
-            objectives: self.objectives,
-            direction,
+            b: std::mem::take(&mut self.b),
+            variables: std::mem::take(&mut self.variables),
         })
     }
 }
@@ -290,4 +429,49 @@ mod tests {
 
         assert!(result.is_err());
     }
+
+    #[test]
+    fn test_builder_indexed_objectives() {
+        let request = SolveRequestBuilder::new()
+            .add_variable(Variable::new("x1", 0, 100))
+            .add_indexed_objective(vec![(0, 1.0)])
+            .direction(SolverDirection::Maximize)
+            .build()
+            .unwrap();
+        assert_eq!(
+            request.objectives,
+            Objectives::Indexed(vec![vec![(0, 1.0)]])
+        );
+
+        let mixed = SolveRequestBuilder::new()
+            .add_variable(Variable::new("x1", 0, 100))
+            .add_objective([("x1".to_string(), 1.0)].into())
+            .add_indexed_objective(vec![(0, 1.0)])
+            .direction(SolverDirection::Maximize)
+            .build();
+        assert!(mixed.is_err());
+    }
+
+    #[test]
+    fn test_builder_splits_polyhedron_and_model_request() {
+        let builder = || {
+            SolveRequestBuilder::new()
+                .add_variable(Variable::new("x1", 0, 100))
+                .add_constraint(vec![0], vec![0], vec![1], 10)
+                .add_objective([("x1".to_string(), 1.0)].into())
+                .direction(SolverDirection::Maximize)
+        };
+        let polyhedron = builder().build_polyhedron().unwrap();
+        assert_eq!(polyhedron.b, vec![10]);
+        assert_eq!(polyhedron.variables.len(), 1);
+
+        let request = builder().build_model_request().unwrap();
+        assert_eq!(request.direction, SolverDirection::Maximize);
+        assert_eq!(request.objectives.len(), 1);
+
+        assert!(SolveRequestBuilder::new()
+            .add_objective([("x1".to_string(), 1.0)].into())
+            .build_model_request()
+            .is_err());
+    }
 }
@@ -1,6 +1,47 @@
+use crate::binary;
 use crate::error::{GlpkError, Result};
-use crate::types::{SolveRequest, SolveResponse};
-use reqwest::{Client, Url};
+use crate::ndjson;
+use crate::types::{
+    BatchItem, BatchResult, ModelHandle, ModelSolveRequest, SolveRequest, SolveResponse,
+    SparseLEIntegerPolyhedron, StreamedSolution,
+};
+use futures_util::stream::{self, Stream, StreamExt, TryStreamExt};
+use reqwest::header::{ACCEPT, CONTENT_ENCODING, CONTENT_TYPE};
+use reqwest::{Client, RequestBuilder, Response, Url};
+use serde::{Deserialize, Serialize};
+use std::io::Write;
+use std::time::Duration;
+
+/// Idle connections kept per host, enough for `solve_many` to reuse them
+const POOL_MAX_IDLE_PER_HOST: usize = 32;
+/// Bodies smaller than this are sent uncompressed
+const COMPRESS_MIN_BYTES: usize = 1024;
+const NDJSON: &str = "application/x-ndjson";
+
+/// Encoding used for `/solve` request and response bodies
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum WireFormat {
+    /// Compact little-endian binary format (default)
+    #[default]
+    Binary,
+    /// JSON, for servers that predate the binary format
+    Json,
+}
+
+/// Content encoding of request bodies
+///
+/// Responses are decompressed regardless, using whatever encoding the
+/// server picked from the `Accept-Encoding` the client sends.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Compression {
+    /// Uncompressed (default), for servers that predate compressed requests
+    #[default]
+    None,
+    /// gzip at its fastest level
+    Gzip,
+    /// zstd at its default level, the better choice for large polyhedra
+    Zstd,
+}
 
 /// HTTP client for interacting with the GLPK REST API
 #[derive(Debug, Clone)]
@@ -8,6 +49,8 @@ pub struct GlpkClient {
     client: Client,
     base_url: Url,
     api_key: Option<String>,
+    wire_format: WireFormat,
+    compression: Compression,
 }
 
 impl GlpkClient {
@@ -25,14 +68,16 @@ impl GlpkClient {
     /// let client = GlpkClient::new("http://localhost:9000").unwrap();
     /// ```
     pub fn new(base_url: impl AsRef<str>) -> Result<Self> {
-        let base_url = Url::parse(base_url.as_ref())
-            .map_err(|e| GlpkError::InvalidUrl(e.to_string()))?;
+        Self::with_client(base_url, pooled_client().build()?)
+    }
 
-        Ok(Self {
-            client: Client::new(),
-            base_url,
-            api_key: None,
-        })
+    /// Create a new GLPK API client that talks HTTP/2 without negotiation
+    ///
+    /// Use this for `http://` servers, which speak cleartext HTTP/2 but
+    /// cannot negotiate it. Concurrent requests, such as those of
+    /// `solve_many`, are then multiplexed over a single connection.
+    pub fn new_http2(base_url: impl AsRef<str>) -> Result<Self> {
+        Self::with_client(base_url, pooled_client().http2_prior_knowledge().build()?)
     }
 
     /// Create a new GLPK API client with custom reqwest client
@@ -46,6 +91,8 @@ impl GlpkClient {
             client,
             base_url,
             api_key: None,
+            wire_format: WireFormat::default(),
+            compression: Compression::default(),
         })
     }
 
@@ -67,6 +114,38 @@ impl GlpkClient {
         self
     }
 
+    /// Set the encoding used for solve requests and responses
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// use glpk_api_sdk::{GlpkClient, WireFormat};
+    ///
+    /// let client = GlpkClient::new("http://localhost:9000")
+    ///     .unwrap()
+    ///     .with_wire_format(WireFormat::Json);
+    /// ```
+    pub fn with_wire_format(mut self, wire_format: WireFormat) -> Self {
+        self.wire_format = wire_format;
+        self
+    }
+
+    /// Set the content encoding of request bodies
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// use glpk_api_sdk::{Compression, GlpkClient};
+    ///
+    /// let client = GlpkClient::new("http://localhost:9000")
+    ///     .unwrap()
+    ///     .with_compression(Compression::Zstd);
+    /// ```
+    pub fn with_compression(mut self, compression: Compression) -> Self {
+        self.compression = compression;
+        self
+    }
+
     /// Check the health of the API server
     ///
     /// # Example
@@ -127,9 +206,272 @@ impl GlpkClient {
         let url = self.base_url.join("/solve")
             .map_err(|e| GlpkError::InvalidUrl(e.to_string()))?;
 
-        let mut req_builder = self.client.post(url).json(&request);
+        let req_builder = self.solve_body(self.client.post(url), &request)?;
+        let req_builder = match self.wire_format {
+            WireFormat::Binary => req_builder.header(ACCEPT, binary::CONTENT_TYPE),
+            WireFormat::Json => req_builder,
+        };
+
+        let response = self.send(req_builder).await?;
+
+        if self.wire_format == WireFormat::Binary {
+            let body = response.bytes().await?;
+            let variable_ids: Vec<&str> = request
+                .polyhedron
+                .variables
+                .iter()
+                .map(|v| v.id.as_str())
+                .collect();
+            return binary::decode_response(
+                &body,
+                &variable_ids,
+                request.objectives.is_indexed(),
+            );
+        }
+
+        let solve_response: SolveResponse = response
+            .json()
+            .await
+            .map_err(|e| GlpkError::ParseError(e.to_string()))?;
+
+        Ok(solve_response)
+    }
+
+    /// Solve many requests, with at most `concurrency` in flight at a time
+    ///
+    /// Results are returned in the order of `requests`. A request that
+    /// fails does not stop the others; its slot carries the error.
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// # use glpk_api_sdk::{GlpkClient, SolveRequest};
+    /// # async fn example(requests: Vec<SolveRequest>) -> Result<(), Box<dyn std::error::Error>> {
+    /// let client = GlpkClient::new_http2("http://localhost:9000")?;
+    ///
+    /// for response in client.solve_many(requests, 8).await {
+    ///     println!("{:?}", response?.solutions);
+    /// }
+    /// # Ok(())
+    /// # }
+    /// ```
+    pub async fn solve_many(
+        &self,
+        requests: Vec<SolveRequest>,
+        concurrency: usize,
+    ) -> Vec<Result<SolveResponse>> {
+        stream::iter(requests)
+            .map(|request| self.solve(request))
+            .buffered(concurrency.max(1))
+            .collect()
+            .await
+    }
+
+    /// Solve a request through `/solve/stream`, yielding each objective's
+    /// solution as soon as the server has it
+    ///
+    /// Solutions arrive in completion order and carry the index of their
+    /// objective. An error after the first solution ends the stream.
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// # use glpk_api_sdk::{GlpkClient, SolveRequest};
+    /// # use futures_util::StreamExt;
+    /// # async fn example(request: SolveRequest) -> Result<(), Box<dyn std::error::Error>> {
+    /// let client = GlpkClient::new("http://localhost:9000")?;
+    ///
+    /// let mut solutions = client.solve_stream(&request).await?;
+    /// while let Some(streamed) = solutions.next().await {
+    ///     let streamed = streamed?;
+    ///     println!("{}: {:?}", streamed.index, streamed.solution.status);
+    /// }
+    /// # Ok(())
+    /// # }
+    /// ```
+    pub async fn solve_stream(
+        &self,
+        request: &SolveRequest,
+    ) -> Result<impl Stream<Item = Result<StreamedSolution>> + Unpin> {
+        let url = self.base_url.join("/solve/stream")
+            .map_err(|e| GlpkError::InvalidUrl(e.to_string()))?;
+
+        let req_builder = self.solve_body(self.client.post(url), request)?.header(ACCEPT, NDJSON);
+        let response = self.send(req_builder).await?;
+        Ok(Box::pin(
+            ndjson::parse_stream(response.bytes_stream())
+                .map(|line| line.and_then(StreamLine::into_result)),
+        ))
+    }
+
+    /// Solve many independent problems in a single request
+    ///
+    /// The server solves the items concurrently and answers in completion
+    /// order, so the results are matched to the items by their ids. An item
+    /// that fails does not fail the batch; its result carries the error.
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// # use glpk_api_sdk::{BatchItem, GlpkClient, SolveRequest};
+    /// # async fn example(requests: Vec<SolveRequest>) -> Result<(), Box<dyn std::error::Error>> {
+    /// let client = GlpkClient::new("http://localhost:9000")?;
+    ///
+    /// let items = requests
+    ///     .into_iter()
+    ///     .enumerate()
+    ///     .map(|(i, request)| BatchItem::new(i.to_string(), request))
+    ///     .collect();
+    ///
+    /// for result in client.solve_batch(items).await? {
+    ///     match result.solutions {
+    ///         Some(solutions) => println!("{}: {:?}", result.id, solutions),
+    ///         None => println!("{} failed: {:?}", result.id, result.error),
+    ///     }
+    /// }
+    /// # Ok(())
+    /// # }
+    /// ```
+    pub async fn solve_batch(&self, items: Vec<BatchItem>) -> Result<Vec<BatchResult>> {
+        self.solve_batch_stream(&items).await?.try_collect().await
+    }
+
+    /// Like `solve_batch`, but yields each result as soon as it arrives
+    pub async fn solve_batch_stream(
+        &self,
+        items: &[BatchItem],
+    ) -> Result<impl Stream<Item = Result<BatchResult>> + Unpin> {
+        let url = self.base_url.join("/solve/batch")
+            .map_err(|e| GlpkError::InvalidUrl(e.to_string()))?;
+
+        let req_builder = self.json_body(self.client.post(url), items)?.header(ACCEPT, NDJSON);
+        let response = self.send(req_builder).await?;
+        Ok(Box::pin(ndjson::parse_stream(response.bytes_stream())))
+    }
 
-        // Add API key header if set
+    /// Upload a polyhedron once to solve it repeatedly by id
+    ///
+    /// The server builds and caches the model and keeps it until
+    /// `delete_model` or until it has not been used for `ttl_ms`
+    /// (the server default when `None`).
+    ///
+    /// # Example
+    ///
+    /// ```no_run
+    /// # use glpk_api_sdk::{GlpkClient, SolveRequestBuilder, SolverDirection, Variable};
+    /// # async fn example() -> Result<(), Box<dyn std::error::Error>> {
+    /// let client = GlpkClient::new("http://localhost:9000")?;
+    ///
+    /// let polyhedron = SolveRequestBuilder::new()
+    ///     .add_variable(Variable::new("x1", 0, 1))
+    ///     .add_variable(Variable::new("x2", 0, 1))
+    ///     .add_constraint(vec![0, 0], vec![0, 1], vec![1, 1], 1)
+    ///     .build_polyhedron()?;
+    /// let model = client.register_model(&polyhedron, None).await?;
+    ///
+    /// for variable in ["x1", "x2"] {
+    ///     let request = SolveRequestBuilder::new()
+    ///         .add_objective([(variable.to_string(), 1.0)].into())
+    ///         .direction(SolverDirection::Maximize)
+    ///         .build_model_request()?;
+    ///     let response = client.solve_model(&model.id, &request).await?;
+    ///     println!("{}: {:?}", variable, response.solutions);
+    /// }
+    ///
+    /// client.delete_model(&model.id).await?;
+    /// # Ok(())
+    /// # }
+    /// ```
+    pub async fn register_model(
+        &self,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        ttl_ms: Option<u64>,
+    ) -> Result<ModelHandle> {
+        let url = self.base_url.join("/models")
+            .map_err(|e| GlpkError::InvalidUrl(e.to_string()))?;
+
+        let body = serde_json::json!({ "polyhedron": polyhedron, "ttl_ms": ttl_ms });
+        let response = self.send(self.json_body(self.client.post(url), &body)?).await?;
+        response
+            .json()
+            .await
+            .map_err(|e| GlpkError::ParseError(e.to_string()))
+    }
+
+    /// Solve objectives against a model registered with `register_model`
+    ///
+    /// Fails with `GlpkError::NotFound` once the model was deleted or expired.
+    pub async fn solve_model(
+        &self,
+        id: &str,
+        request: &ModelSolveRequest,
+    ) -> Result<SolveResponse> {
+        let url = self.base_url.join(&format!("/models/{}/solve", id))
+            .map_err(|e| GlpkError::InvalidUrl(e.to_string()))?;
+
+        let response = self.send(self.json_body(self.client.post(url), request)?).await?;
+        response
+            .json()
+            .await
+            .map_err(|e| GlpkError::ParseError(e.to_string()))
+    }
+
+    /// Drop a registered model, returning whether the server still had it
+    pub async fn delete_model(&self, id: &str) -> Result<bool> {
+        let url = self.base_url.join(&format!("/models/{}", id))
+            .map_err(|e| GlpkError::InvalidUrl(e.to_string()))?;
+
+        match self.send(self.client.delete(url)).await {
+            Ok(_) => Ok(true),
+            Err(GlpkError::NotFound) => Ok(false),
+            Err(e) => Err(e),
+        }
+    }
+
+    /// Attach a solve request in the client's wire format
+    fn solve_body(
+        &self,
+        req_builder: RequestBuilder,
+        request: &SolveRequest,
+    ) -> Result<RequestBuilder> {
+        match self.wire_format {
+            WireFormat::Binary => {
+                self.body(req_builder, binary::CONTENT_TYPE, binary::encode_request(request)?)
+            }
+            WireFormat::Json => self.json_body(req_builder, request),
+        }
+    }
+
+    /// Attach `value` as a JSON body
+    fn json_body<T: Serialize + ?Sized>(
+        &self,
+        req_builder: RequestBuilder,
+        value: &T,
+    ) -> Result<RequestBuilder> {
+        let body = serde_json::to_vec(value)
+            .map_err(|e| GlpkError::InvalidRequest(e.to_string()))?;
+        self.body(req_builder, "application/json", body)
+    }
+
+    /// Attach `body`, compressed if the client is configured to and it is large enough
+    fn body(
+        &self,
+        req_builder: RequestBuilder,
+        content_type: &str,
+        body: Vec<u8>,
+    ) -> Result<RequestBuilder> {
+        let req_builder = req_builder.header(CONTENT_TYPE, content_type);
+        if body.len() < COMPRESS_MIN_BYTES {
+            return Ok(req_builder.body(body));
+        }
+        Ok(match compress(self.compression, body)? {
+            (Some(encoding), body) => req_builder.header(CONTENT_ENCODING, encoding).body(body),
+            (None, body) => req_builder.body(body),
+        })
+    }
+
+    /// Send a request with the API key, if set, turning error statuses into errors
+    async fn send(&self, mut req_builder: RequestBuilder) -> Result<Response> {
         if let Some(ref api_key) = self.api_key {
             req_builder = req_builder.header("X-API-Key", api_key);
         }
@@ -145,16 +487,62 @@ impl GlpkClient {
 
             return Err(match status.as_u16() {
                 401 | 403 => GlpkError::AuthenticationFailed,
+                404 => GlpkError::NotFound,
                 _ => GlpkError::ApiError(error_text),
             });
         }
 
-        let solve_response: SolveResponse = response
-            .json()
-            .await
-            .map_err(|e| GlpkError::ParseError(e.to_string()))?;
+        Ok(response)
+    }
+}
 
-        Ok(solve_response)
+/// Connection pool settings shared by the client constructors
+///
+/// Idle connections are kept long enough to be reused between bursts of
+/// solves, and HTTP/2 windows grow with the large bodies of big polyhedra.
+fn pooled_client() -> reqwest::ClientBuilder {
+    Client::builder()
+        .pool_max_idle_per_host(POOL_MAX_IDLE_PER_HOST)
+        .pool_idle_timeout(Duration::from_secs(90))
+        .tcp_nodelay(true)
+        .http2_adaptive_window(true)
+        .http2_keep_alive_interval(Duration::from_secs(30))
+        .http2_keep_alive_while_idle(true)
+}
+
+/// Encode `body`, returning its `Content-Encoding` if it was compressed
+fn compress(
+    compression: Compression,
+    body: Vec<u8>,
+) -> Result<(Option<&'static str>, Vec<u8>)> {
+    let failed =
+        |e: std::io::Error| GlpkError::InvalidRequest(format!("Compression failed: {}", e));
+    match compression {
+        Compression::None => Ok((None, body)),
+        Compression::Gzip => {
+            let mut encoder =
+                flate2::write::GzEncoder::new(Vec::new(), flate2::Compression::fast());
+            encoder.write_all(&body).map_err(failed)?;
+            Ok((Some("gzip"), encoder.finish().map_err(failed)?))
+        }
+        Compression::Zstd => Ok((Some("zstd"), zstd::bulk::compress(&body, 0).map_err(failed)?)),
+    }
+}
+
+/// One line of a `/solve/stream` response: a solution, or the error that ended the solve
+#[derive(Deserialize)]
+#[serde(untagged)]
+enum StreamLine {
+    Solution(StreamedSolution),
+    Error { error: String },
+}
+
+impl StreamLine {
+    fn into_result(self) -> Result<StreamedSolution> {
+        match self {
+            StreamLine::Solution(streamed) => Ok(streamed),
+            StreamLine::Error { error } => Err(GlpkError::ApiError(error)),
+        }
     }
 }
 
@@ -176,6 +564,58 @@ mod tests {
         assert_eq!(client.api_key, Some("test-key".to_string()));
     }
 
+    #[tokio::test]
+    async fn test_parse_batch_results() {
+        let body = concat!(
+            r#"{"id": "a", "solutions": [{"status": "Optimal", "objective": 1, "solution": {"x": 1}, "error": null}]}"#,
+            "\n",
+            r#"{"id": "b", "error": "Objective contains missing variable y"}"#,
+            "\n",
+        );
+        let chunks = body.as_bytes().chunks(7).map(Ok::<_, GlpkError>);
+        let results: Vec<BatchResult> = ndjson::parse_stream(stream::iter(chunks))
+            .try_collect()
+            .await
+            .unwrap();
+        assert_eq!(results.len(), 2);
+        assert_eq!(results[0].solutions.as_ref().unwrap()[0].objective, 1);
+        assert_eq!(results[1].id, "b");
+        assert!(results[1].solutions.is_none());
+        assert!(results[1].error.is_some());
+    }
+
+    #[test]
+    fn test_stream_line_errors() {
+        let line: StreamLine = ndjson::parse_line(br#"{"error": "Solve failed"}"#).unwrap();
+        assert!(matches!(line.into_result(), Err(GlpkError::ApiError(e)) if e == "Solve failed"));
+
+        let line: StreamLine = ndjson::parse_line(
+            br#"{"index": 1, "solution": {"status": "Optimal", "objective": 2, "solution": {"x": 1}, "error": null}}"#,
+        )
+        .unwrap();
+        let streamed = line.into_result().unwrap();
+        assert_eq!((streamed.index, streamed.solution.objective), (1, 2));
+    }
+
+    #[test]
+    fn test_compress_round_trips() {
+        use std::io::Read;
+
+        let body = br#"{"polyhedron": {"b": [1, 1, 1, 1]}}"#.repeat(64);
+        let (encoding, gzipped) = compress(Compression::Gzip, body.clone()).unwrap();
+        assert_eq!(encoding, Some("gzip"));
+        let mut decoded = Vec::new();
+        flate2::read::GzDecoder::new(&gzipped[..]).read_to_end(&mut decoded).unwrap();
+        assert_eq!(decoded, body);
+
+        let (encoding, zstded) = compress(Compression::Zstd, body.clone()).unwrap();
+        assert_eq!(encoding, Some("zstd"));
+        assert!(zstded.len() < body.len() / 10);
+        assert_eq!(zstd::decode_all(&zstded[..]).unwrap(), body);
+
+        assert_eq!(compress(Compression::None, body.clone()).unwrap(), (None, body));
+    }
+
     #[test]
     fn test_invalid_url() {
         let client = GlpkClient::new("not a valid url");
@@ -29,4 +29,8 @@ pub enum GlpkError {
     /// Authentication failed
     #[error("Authentication failed")]
     AuthenticationFailed,
+
+    /// The requested resource does not exist, e.g. an expired registered model
+    #[error("Not found")]
+    NotFound,
 }
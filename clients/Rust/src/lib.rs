@@ -28,15 +28,19 @@
 //! }
 //! ```
 
+pub mod binary;
 pub mod types;
 pub mod client;
 pub mod builder;
 pub mod error;
+pub mod ndjson;
 
-pub use client::GlpkClient;
+pub use client::{Compression, GlpkClient, WireFormat};
 pub use types::{
     SolveRequest, SolveResponse, Variable, IntegerSparseMatrix, Shape,
     SparseLEIntegerPolyhedron, SolverDirection, Solution, Status,
+    Objective, IndexedObjective, Objectives, SolutionValues, BatchItem, BatchResult,
+    ModelSolveRequest, ModelHandle, StreamedSolution,
 };
 pub use builder::SolveRequestBuilder;
 pub use error::{GlpkError, Result};
@@ -0,0 +1,119 @@
+//! Incremental parsing of NDJSON response bodies
+//!
+//! Lines are decoded as their last byte arrives, so callers see each
+//! result while the rest of the body is still being produced.
+
+use crate::error::{GlpkError, Result};
+use futures_util::stream::{self, Stream, StreamExt};
+use serde::de::DeserializeOwned;
+use std::collections::VecDeque;
+
+/// Splits body chunks into lines, holding a partial line until the rest arrives
+#[derive(Debug, Default)]
+pub struct LineBuffer {
+    pending: Vec<u8>,
+}
+
+impl LineBuffer {
+    /// Append `chunk` and return the non-blank lines it completed
+    pub fn push(&mut self, chunk: &[u8]) -> Vec<Vec<u8>> {
+        self.pending.extend_from_slice(chunk);
+        let Some(end) = self.pending.iter().rposition(|&b| b == b'\n') else {
+            return Vec::new();
+        };
+        let rest = self.pending.split_off(end + 1);
+        let complete = std::mem::replace(&mut self.pending, rest);
+        complete
+            .split(|&b| b == b'\n')
+            .filter(|line| !is_blank(line))
+            .map(<[u8]>::to_vec)
+            .collect()
+    }
+
+    /// The last line of a body that does not end in a newline
+    pub fn finish(&mut self) -> Option<Vec<u8>> {
+        let rest = std::mem::take(&mut self.pending);
+        (!is_blank(&rest)).then_some(rest)
+    }
+}
+
+fn is_blank(line: &[u8]) -> bool {
+    line.iter().all(u8::is_ascii_whitespace)
+}
+
+/// Parse one NDJSON line
+pub fn parse_line<T: DeserializeOwned>(line: &[u8]) -> Result<T> {
+    serde_json::from_slice(line).map_err(|e| GlpkError::ParseError(e.to_string()))
+}
+
+/// Parse a body stream into one value per line
+///
+/// A transport error ends the stream after it is yielded.
+pub fn parse_stream<T, S, B, E>(body: S) -> impl Stream<Item = Result<T>>
+where
+    T: DeserializeOwned,
+    S: Stream<Item = std::result::Result<B, E>>,
+    B: AsRef<[u8]>,
+    GlpkError: From<E>,
+{
+    let state = (Box::pin(body), LineBuffer::default(), VecDeque::<Vec<u8>>::new(), false);
+    stream::unfold(state, |(mut body, mut buffer, mut lines, mut done)| async move {
+        loop {
+            if let Some(line) = lines.pop_front() {
+                return Some((parse_line(&line), (body, buffer, lines, done)));
+            }
+            if done {
+                return None;
+            }
+            match body.next().await {
+                Some(Ok(chunk)) => lines.extend(buffer.push(chunk.as_ref())),
+                Some(Err(e)) => return Some((Err(e.into()), (body, buffer, lines, true))),
+                None => {
+                    done = true;
+                    lines.extend(buffer.finish());
+                }
+            }
+        }
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use serde::Deserialize;
+
+    #[derive(Debug, Deserialize, PartialEq)]
+    struct Line {
+        index: usize,
+    }
+
+    #[test]
+    fn test_line_buffer_joins_split_lines() {
+        let mut buffer = LineBuffer::default();
+        assert!(buffer.push(b"{\"index\": ").is_empty());
+        assert_eq!(buffer.push(b"0}\n\n{\"ind"), vec![b"{\"index\": 0}".to_vec()]);
+        assert_eq!(buffer.push(b"ex\": 1}\n"), vec![b"{\"index\": 1}".to_vec()]);
+        assert_eq!(buffer.finish(), None);
+        buffer.push(b"{\"index\": 2}");
+        assert_eq!(buffer.finish(), Some(b"{\"index\": 2}".to_vec()));
+    }
+
+    #[tokio::test]
+    async fn test_parse_stream_yields_each_line() {
+        let chunks = ["{\"index\"", ": 0}\n{\"index\": 1}\n{\"in", "dex\": 2}"];
+        let body = stream::iter(chunks.map(|chunk| Ok::<_, GlpkError>(chunk.as_bytes())));
+        let lines: Vec<Line> = parse_stream(body)
+            .map(|line| line.unwrap())
+            .collect()
+            .await;
+        assert_eq!(lines, [0, 1, 2].map(|index| Line { index }));
+    }
+
+    #[tokio::test]
+    async fn test_parse_stream_reports_bad_lines() {
+        let body = stream::iter([Ok::<_, GlpkError>(&b"{\"index\": 0}\nnot json\n"[..])]);
+        let lines: Vec<Result<Line>> = parse_stream(body).collect().await;
+        assert!(lines[0].is_ok());
+        assert!(matches!(lines[1], Err(GlpkError::ParseError(_))));
+    }
+}
@@ -82,15 +82,115 @@ pub enum SolverDirection {
 /// Objective function as a mapping from variable names to coefficients
 pub type Objective = HashMap<String, f64>;
 
+/// Objective function as `(variable index, coefficient)` pairs, where the
+/// index is the position of the variable in the polyhedron
+pub type IndexedObjective = Vec<(usize, f64)>;
+
+/// Objective functions keyed by variable name, or by variable index
+///
+/// Indexed objectives make the server return `SolutionValues::Dense`, which
+/// avoids hashing variable names for large problems.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+#[serde(untagged)]
+pub enum Objectives {
+    /// Objectives keyed by variable name
+    Named(Vec<Objective>),
+    /// Objectives keyed by variable index
+    Indexed(Vec<IndexedObjective>),
+}
+
+impl Objectives {
+    /// Number of objective functions
+    pub fn len(&self) -> usize {
+        match self {
+            Objectives::Named(objectives) => objectives.len(),
+            Objectives::Indexed(objectives) => objectives.len(),
+        }
+    }
+
+    /// Whether there are no objective functions
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Whether the objectives are keyed by variable index
+    pub fn is_indexed(&self) -> bool {
+        matches!(self, Objectives::Indexed(_))
+    }
+}
+
+impl From<Vec<Objective>> for Objectives {
+    fn from(objectives: Vec<Objective>) -> Self {
+        Objectives::Named(objectives)
+    }
+}
+
+impl From<Vec<IndexedObjective>> for Objectives {
+    fn from(objectives: Vec<IndexedObjective>) -> Self {
+        Objectives::Indexed(objectives)
+    }
+}
+
 /// Request to solve one or more linear programming problems
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct SolveRequest {
     /// The constraint polyhedron
     pub polyhedron: SparseLEIntegerPolyhedron,
     /// One or more objective functions to optimize
-    pub objectives: Vec<Objective>,
+    pub objectives: Objectives,
+    /// Whether to maximize or minimize
+    pub direction: SolverDirection,
+    /// Optional known feasible assignment used as MIP start
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub hint: Option<HashMap<String, i32>>,
+    /// Optional wall-clock limit of the whole request in milliseconds
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub time_limit_ms: Option<u64>,
+    /// Optional relative MIP gap at which an objective counts as solved
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub mip_gap: Option<f64>,
+}
+
+/// Objectives, direction and limits solved against a registered polyhedron:
+/// a `SolveRequest` without its polyhedron
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct ModelSolveRequest {
+    /// One or more objective functions to optimize
+    pub objectives: Objectives,
     /// Whether to maximize or minimize
     pub direction: SolverDirection,
+    /// Optional known feasible assignment used as MIP start
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub hint: Option<HashMap<String, i32>>,
+    /// Optional wall-clock limit of the whole request in milliseconds
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub time_limit_ms: Option<u64>,
+    /// Optional relative MIP gap at which an objective counts as solved
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub mip_gap: Option<f64>,
+}
+
+impl ModelSolveRequest {
+    /// The full solve request for `polyhedron`
+    pub fn with_polyhedron(self, polyhedron: SparseLEIntegerPolyhedron) -> SolveRequest {
+        SolveRequest {
+            polyhedron,
+            objectives: self.objectives,
+            direction: self.direction,
+            hint: self.hint,
+            time_limit_ms: self.time_limit_ms,
+            mip_gap: self.mip_gap,
+        }
+    }
+}
+
+/// A polyhedron registered on the server, see `GlpkClient::register_model`
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+pub struct ModelHandle {
+    /// Id to solve the model by
+    pub id: String,
+    /// How long the server keeps the model after its last use
+    pub ttl_ms: u64,
 }
 
 /// Solution status codes
@@ -114,6 +214,18 @@ pub enum Status {
     MIPFailed = 8,
     /// Search space is empty
     EmptySpace = 9,
+    /// The time limit ran out; the solution is the best one found, if any
+    TimeLimit = 10,
+}
+
+/// Variable assignments of a solution
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(untagged)]
+pub enum SolutionValues {
+    /// Values keyed by variable name
+    Named(HashMap<String, i64>),
+    /// Values in the order of the request's variables (indexed objectives)
+    Dense(Vec<i64>),
 }
 
 /// A single solution for one objective function
@@ -124,7 +236,7 @@ pub struct Solution {
     /// Objective value achieved
     pub objective: i32,
     /// Variable assignments
-    pub solution: HashMap<String, i64>,
+    pub solution: SolutionValues,
     /// Error message, if any
     pub error: Option<String>,
 }
@@ -135,3 +247,45 @@ pub struct SolveResponse {
     /// One solution per objective function
     pub solutions: Vec<Solution>,
 }
+
+/// One line of a `/solve/stream` response
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct StreamedSolution {
+    /// Position of the solved objective in the request
+    pub index: usize,
+    /// The objective's solution
+    pub solution: Solution,
+}
+
+/// One request of a batch solve, tagged with a caller-chosen id
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct BatchItem {
+    /// Identifier echoed on the item's result
+    pub id: String,
+    /// The request to solve
+    #[serde(flatten)]
+    pub request: SolveRequest,
+}
+
+impl BatchItem {
+    /// Tag a request with an id
+    pub fn new(id: impl Into<String>, request: SolveRequest) -> Self {
+        Self {
+            id: id.into(),
+            request,
+        }
+    }
+}
+
+/// Result of one batch item: its solutions, or the error it failed with
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct BatchResult {
+    /// Id of the item this result belongs to
+    pub id: String,
+    /// One solution per objective function, if the item was solved
+    #[serde(default)]
+    pub solutions: Option<Vec<Solution>>,
+    /// Why the item was not solved
+    #[serde(default)]
+    pub error: Option<String>,
+}
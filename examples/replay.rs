@@ -0,0 +1,118 @@
+//! Replay a capture of `/solve` request bodies against a running server and
+//! report latency percentiles.
+//!
+//! ```bash
+//! cargo run --release --example replay -- requests.jsonl [concurrency] [repeat]
+//! ```
+//!
+//! Each line of the capture is one JSON request body. `REPLAY_URL` selects the
+//! server (default `http://localhost:9000`) and `API_TOKEN`, when set, is sent
+//! as the `X-API-Key` header.
+
+use std::env;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+#[tokio::main]
+async fn main() {
+    let mut args = env::args().skip(1);
+    let capture = args
+        .next()
+        .expect("usage: replay <requests.jsonl> [concurrency] [repeat]");
+    let concurrency: usize = args.next().and_then(|v| v.parse().ok()).unwrap_or(4);
+    let repeat: usize = args.next().and_then(|v| v.parse().ok()).unwrap_or(1);
+    let url = format!(
+        "{}/solve",
+        env::var("REPLAY_URL").unwrap_or_else(|_| "http://localhost:9000".to_string())
+    );
+    let token = env::var("API_TOKEN").ok();
+
+    let lines: Vec<String> = std::fs::read_to_string(&capture)
+        .expect("failed to read capture")
+        .lines()
+        .filter(|line| !line.trim().is_empty())
+        .map(str::to_string)
+        .collect();
+    let bodies = Arc::new(
+        (0..repeat)
+            .flat_map(|_| lines.iter().cloned())
+            .collect::<Vec<_>>(),
+    );
+    let next = Arc::new(AtomicUsize::new(0));
+    let client = reqwest::Client::new();
+
+    let started = Instant::now();
+    let workers: Vec<_> = (0..concurrency.max(1))
+        .map(|_| {
+            let (bodies, next, client, url, token) = (
+                bodies.clone(),
+                next.clone(),
+                client.clone(),
+                url.clone(),
+                token.clone(),
+            );
+            tokio::spawn(async move {
+                let mut latencies = Vec::new();
+                let mut errors = 0;
+                while let Some(body) = bodies.get(next.fetch_add(1, Ordering::Relaxed)) {
+                    let mut request = client
+                        .post(&url)
+                        .header("Content-Type", "application/json")
+                        .body(body.clone());
+                    if let Some(token) = &token {
+                        request = request.header("X-API-Key", token);
+                    }
+                    let sent = Instant::now();
+                    match request.send().await {
+                        Ok(response) if response.status().is_success() => {
+                            // Include reading the body in the latency
+                            if response.bytes().await.is_err() {
+                                errors += 1;
+                            }
+                        }
+                        _ => errors += 1,
+                    }
+                    latencies.push(sent.elapsed());
+                }
+                (latencies, errors)
+            })
+        })
+        .collect();
+
+    let mut latencies = Vec::with_capacity(bodies.len());
+    let mut errors = 0;
+    for worker in workers {
+        let (worker_latencies, worker_errors) = worker.await.expect("replay worker panicked");
+        latencies.extend(worker_latencies);
+        errors += worker_errors;
+    }
+    let elapsed = started.elapsed();
+
+    if latencies.is_empty() {
+        println!("no requests in {}", capture);
+        return;
+    }
+    latencies.sort();
+    let percentile = |p: f64| -> Duration {
+        let rank = ((latencies.len() as f64 * p).ceil() as usize).max(1);
+        latencies[rank.min(latencies.len()) - 1]
+    };
+    println!(
+        "requests: {} (errors: {}), concurrency: {}",
+        latencies.len(),
+        errors,
+        concurrency
+    );
+    println!(
+        "p50: {:?}  p90: {:?}  p99: {:?}  max: {:?}",
+        percentile(0.50),
+        percentile(0.90),
+        percentile(0.99),
+        latencies[latencies.len() - 1]
+    );
+    println!(
+        "throughput: {:.1} req/s",
+        latencies.len() as f64 / elapsed.as_secs_f64()
+    );
+}
@@ -0,0 +1,443 @@
+//! Compact binary wire format for `/solve`, selected by content type.
+//!
+//! All integers are little-endian. Arrays are a `u32` length followed by the
+//! raw elements, strings are a `u32` byte length followed by UTF-8 bytes.
+//!
+//! Request (`SLVQ`, version 1):
+//! - magic `b"SLVQ"`, `u8` version, `u8` direction (0 = maximize, 1 = minimize)
+//! - `u32` nrows, `u32` ncols, then `A` as three `[i32]` arrays: rows, cols, vals
+//! - `b` as `[i32]`
+//! - `u32` variable count, per variable: id string, `i32` lower, `i32` upper
+//! - `u32` objective count, per objective: `[u32]` variable indices, `[f64]` coefficients
+//! - `u8` hint flag, if 1: `[u32]` variable indices, `[i32]` values
+//!
+//! Version 2 requests append the solve limits:
+//! - `u8` time limit flag, if 1: `u64` milliseconds
+//! - `u8` MIP gap flag, if 1: `f64` relative gap
+//!
+//! Response (`SLVR`, version 1):
+//! - magic `b"SLVR"`, `u8` version, `u32` solution count, per solution:
+//!   `u8` status, `i32` objective, `[i32]` values in request variable order,
+//!   `u8` error flag and, if 1, the error string
+//!
+//! Objectives decode to `ApiObjectives::Indexed`, so solvers hand back dense
+//! values that are written out as-is.
+
+use crate::models::{
+    ApiIntegerSparseMatrix, ApiObjectives, ApiShape, ApiSolution, ApiValues, ApiVariable,
+    Assignment, IndexedObjective, SolveRequest, SolverDirection, SparseLEIntegerPolyhedron,
+};
+use std::sync::Arc;
+
+/// Content type of the binary wire format
+pub const CONTENT_TYPE: &str = "application/x-solver-binary";
+
+const REQUEST_MAGIC: &[u8; 4] = b"SLVQ";
+const RESPONSE_MAGIC: &[u8; 4] = b"SLVR";
+const VERSION: u8 = 1;
+/// Request version that carries the solve limits
+const LIMITS_VERSION: u8 = 2;
+
+#[derive(Debug)]
+pub struct DecodeError {
+    pub details: String,
+}
+
+impl DecodeError {
+    fn new(details: impl Into<String>) -> Self {
+        DecodeError {
+            details: details.into(),
+        }
+    }
+}
+
+/// Cursor over a request body
+struct Reader<'a> {
+    buf: &'a [u8],
+}
+
+impl<'a> Reader<'a> {
+    fn take(&mut self, len: usize) -> Result<&'a [u8], DecodeError> {
+        if len > self.buf.len() {
+            return Err(DecodeError::new("Unexpected end of binary request"));
+        }
+        let (head, tail) = self.buf.split_at(len);
+        self.buf = tail;
+        Ok(head)
+    }
+
+    fn u8(&mut self) -> Result<u8, DecodeError> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn u32(&mut self) -> Result<u32, DecodeError> {
+        let bytes = self.take(4)?;
+        Ok(u32::from_le_bytes(bytes.try_into().expect("4 bytes")))
+    }
+
+    fn i32(&mut self) -> Result<i32, DecodeError> {
+        Ok(self.u32()? as i32)
+    }
+
+    fn u64(&mut self) -> Result<u64, DecodeError> {
+        let bytes = self.take(8)?;
+        Ok(u64::from_le_bytes(bytes.try_into().expect("8 bytes")))
+    }
+
+    /// Value read by `read` if the preceding flag byte is set
+    fn optional<T>(
+        &mut self,
+        read: impl FnOnce(&mut Self) -> Result<T, DecodeError>,
+    ) -> Result<Option<T>, DecodeError> {
+        match self.u8()? {
+            0 => Ok(None),
+            _ => read(self).map(Some),
+        }
+    }
+
+    /// Slice of `len` elements of `width` bytes, checked before allocating
+    fn elements(&mut self, len: usize, width: usize) -> Result<&'a [u8], DecodeError> {
+        let bytes = len
+            .checked_mul(width)
+            .ok_or_else(|| DecodeError::new("Array length overflows"))?;
+        self.take(bytes)
+    }
+
+    fn len(&mut self) -> Result<usize, DecodeError> {
+        Ok(self.u32()? as usize)
+    }
+
+    fn i32s(&mut self) -> Result<Vec<i32>, DecodeError> {
+        let len = self.len()?;
+        Ok(self
+            .elements(len, 4)?
+            .chunks_exact(4)
+            .map(|c| i32::from_le_bytes(c.try_into().expect("4 bytes")))
+            .collect())
+    }
+
+    fn u32s(&mut self) -> Result<Vec<u32>, DecodeError> {
+        let len = self.len()?;
+        Ok(self
+            .elements(len, 4)?
+            .chunks_exact(4)
+            .map(|c| u32::from_le_bytes(c.try_into().expect("4 bytes")))
+            .collect())
+    }
+
+    fn f64s(&mut self) -> Result<Vec<f64>, DecodeError> {
+        let len = self.len()?;
+        Ok(self
+            .elements(len, 8)?
+            .chunks_exact(8)
+            .map(|c| f64::from_le_bytes(c.try_into().expect("8 bytes")))
+            .collect())
+    }
+
+    fn string(&mut self) -> Result<String, DecodeError> {
+        let len = self.len()?;
+        let bytes = self.take(len)?;
+        String::from_utf8(bytes.to_vec())
+            .map_err(|_| DecodeError::new("Variable id is not valid UTF-8"))
+    }
+}
+
+/// Decode a binary `SolveRequest`
+pub fn decode_request(buf: &[u8]) -> Result<SolveRequest, DecodeError> {
+    let mut reader = Reader { buf };
+    if reader.take(4)? != REQUEST_MAGIC {
+        return Err(DecodeError::new("Not a binary solve request"));
+    }
+    let version = reader.u8()?;
+    if version != VERSION && version != LIMITS_VERSION {
+        return Err(DecodeError::new(format!(
+            "Unsupported binary request version {}",
+            version
+        )));
+    }
+    let direction = match reader.u8()? {
+        0 => SolverDirection::Maximize,
+        1 => SolverDirection::Minimize,
+        other => return Err(DecodeError::new(format!("Invalid direction {}", other))),
+    };
+
+    let nrows = reader.len()?;
+    let ncols = reader.len()?;
+    let a = ApiIntegerSparseMatrix {
+        rows: reader.i32s()?,
+        cols: reader.i32s()?,
+        vals: reader.i32s()?,
+        shape: ApiShape { nrows, ncols },
+    };
+    let b = reader.i32s()?;
+
+    let variable_count = reader.len()?;
+    let mut variables = Vec::with_capacity(variable_count.min(reader.buf.len()));
+    for _ in 0..variable_count {
+        let id = reader.string()?;
+        let bound = (reader.i32()?, reader.i32()?);
+        variables.push(ApiVariable { id, bound });
+    }
+
+    let variable_id = |index: u32| {
+        variables
+            .get(index as usize)
+            .map(|v| v.id.clone())
+            .ok_or_else(|| DecodeError::new(format!("Variable index {} out of range", index)))
+    };
+
+    let objective_count = reader.len()?;
+    let mut objectives = Vec::with_capacity(objective_count.min(reader.buf.len()));
+    for _ in 0..objective_count {
+        let indices = reader.u32s()?;
+        let coefficients = reader.f64s()?;
+        if indices.len() != coefficients.len() {
+            return Err(DecodeError::new(
+                "Objective indices and coefficients differ in length",
+            ));
+        }
+        let objective = indices
+            .into_iter()
+            .zip(coefficients)
+            .map(|(index, coefficient)| {
+                if index as usize >= variables.len() {
+                    return Err(DecodeError::new(format!(
+                        "Variable index {} out of range",
+                        index
+                    )));
+                }
+                // JSON cannot express these, so no backend expects them
+                if !coefficient.is_finite() {
+                    return Err(DecodeError::new(format!(
+                        "Objective coefficient {} of variable index {} is not finite",
+                        coefficient, index
+                    )));
+                }
+                Ok((index as usize, coefficient))
+            })
+            .collect::<Result<IndexedObjective, DecodeError>>()?;
+        objectives.push(objective);
+    }
+
+    let hint = match reader.u8()? {
+        0 => None,
+        _ => {
+            let indices = reader.u32s()?;
+            let values = reader.i32s()?;
+            if indices.len() != values.len() {
+                return Err(DecodeError::new("Hint indices and values differ in length"));
+            }
+            Some(
+                indices
+                    .into_iter()
+                    .zip(values)
+                    .map(|(index, value)| Ok((variable_id(index)?, value)))
+                    .collect::<Result<Assignment, DecodeError>>()?,
+            )
+        }
+    };
+
+    let (time_limit_ms, mip_gap) = if version == LIMITS_VERSION {
+        (
+            reader.optional(Reader::u64)?,
+            reader.optional(|reader| Ok(f64::from_bits(reader.u64()?)))?,
+        )
+    } else {
+        (None, None)
+    };
+
+    if !reader.buf.is_empty() {
+        return Err(DecodeError::new("Trailing bytes after binary request"));
+    }
+
+    Ok(SolveRequest {
+        polyhedron: Arc::new(SparseLEIntegerPolyhedron { a, b, variables }),
+        objectives: ApiObjectives::Indexed(objectives),
+        direction,
+        hint,
+        time_limit_ms,
+        mip_gap,
+    })
+}
+
+fn put_u32(out: &mut Vec<u8>, value: u32) {
+    out.extend_from_slice(&value.to_le_bytes());
+}
+
+/// Encode solutions with their values laid out in `variable_ids` order
+pub fn encode_response(solutions: &[ApiSolution], variable_ids: &[String]) -> Vec<u8> {
+    let mut out = Vec::with_capacity(9 + solutions.len() * (14 + 4 * variable_ids.len()));
+    out.extend_from_slice(RESPONSE_MAGIC);
+    out.push(VERSION);
+    put_u32(&mut out, solutions.len() as u32);
+    for solution in solutions {
+        out.push(solution.status as u8);
+        out.extend_from_slice(&solution.objective.to_le_bytes());
+        put_u32(&mut out, variable_ids.len() as u32);
+        match &solution.solution {
+            ApiValues::Dense(values) => {
+                let padded = values.iter().copied().chain(std::iter::repeat(0));
+                for value in padded.take(variable_ids.len()) {
+                    out.extend_from_slice(&value.to_le_bytes());
+                }
+            }
+            ApiValues::Named(values) => {
+                for id in variable_ids {
+                    let value = values.get(id).copied().unwrap_or(0);
+                    out.extend_from_slice(&value.to_le_bytes());
+                }
+            }
+        }
+        match &solution.error {
+            Some(error) => {
+                out.push(1);
+                put_u32(&mut out, error.len() as u32);
+                out.extend_from_slice(error.as_bytes());
+            }
+            None => out.push(0),
+        }
+    }
+    out
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::Status;
+    use std::collections::HashMap;
+
+    fn put_i32s(out: &mut Vec<u8>, values: &[i32]) {
+        put_u32(out, values.len() as u32);
+        values
+            .iter()
+            .for_each(|v| out.extend_from_slice(&v.to_le_bytes()));
+    }
+
+    fn put_string(out: &mut Vec<u8>, value: &str) {
+        put_u32(out, value.len() as u32);
+        out.extend_from_slice(value.as_bytes());
+    }
+
+    // x1 + x2 <= 4, maximize 2*x1, hint x2 = 1
+    fn encode_test_request() -> Vec<u8> {
+        let mut out = Vec::new();
+        out.extend_from_slice(REQUEST_MAGIC);
+        out.push(VERSION);
+        out.push(0);
+        put_u32(&mut out, 1);
+        put_u32(&mut out, 2);
+        put_i32s(&mut out, &[0, 0]);
+        put_i32s(&mut out, &[0, 1]);
+        put_i32s(&mut out, &[1, 1]);
+        put_i32s(&mut out, &[4]);
+        put_u32(&mut out, 2);
+        for id in ["x1", "x2"] {
+            put_string(&mut out, id);
+            out.extend_from_slice(&0i32.to_le_bytes());
+            out.extend_from_slice(&3i32.to_le_bytes());
+        }
+        put_u32(&mut out, 1);
+        put_u32(&mut out, 1);
+        put_u32(&mut out, 0);
+        put_u32(&mut out, 1);
+        out.extend_from_slice(&2.0f64.to_le_bytes());
+        out.push(1);
+        put_u32(&mut out, 1);
+        put_u32(&mut out, 1);
+        put_i32s(&mut out, &[1]);
+        out
+    }
+
+    #[test]
+    fn test_decode_request() {
+        let request = decode_request(&encode_test_request()).unwrap();
+        assert!(request.direction == SolverDirection::Maximize);
+        assert_eq!(request.polyhedron.a.cols, vec![0, 1]);
+        assert_eq!(request.polyhedron.a.shape.ncols, 2);
+        assert_eq!(request.polyhedron.b, vec![4]);
+        assert_eq!(request.polyhedron.variables[1].id, "x2");
+        assert_eq!(request.polyhedron.variables[1].bound, (0, 3));
+        assert_eq!(
+            request.objectives,
+            ApiObjectives::Indexed(vec![vec![(0, 2.0)]])
+        );
+        assert_eq!(request.hint, Some(HashMap::from([("x2".to_string(), 1)])));
+        assert_eq!(request.time_limit_ms, None);
+    }
+
+    #[test]
+    fn test_decode_request_with_limits() {
+        let mut encoded = encode_test_request();
+        encoded[4] = LIMITS_VERSION;
+        encoded.push(1);
+        encoded.extend_from_slice(&250u64.to_le_bytes());
+        encoded.push(0);
+        let request = decode_request(&encoded).unwrap();
+        assert_eq!(request.time_limit_ms, Some(250));
+        assert_eq!(request.mip_gap, None);
+
+        // Version 1 requests end after the hint
+        encoded[4] = VERSION;
+        assert!(decode_request(&encoded).is_err());
+    }
+
+    #[test]
+    fn test_non_finite_coefficient_is_rejected() {
+        let mut encoded = encode_test_request();
+        // The only coefficient precedes the 17 bytes of the hint
+        let at = encoded.len() - 17 - 8;
+        assert_eq!(encoded[at..at + 8], 2.0f64.to_le_bytes());
+        for coefficient in [f64::NAN, f64::INFINITY, f64::NEG_INFINITY] {
+            encoded[at..at + 8].copy_from_slice(&coefficient.to_le_bytes());
+            let error = decode_request(&encoded).err().unwrap();
+            assert!(error.details.ends_with("of variable index 0 is not finite"));
+        }
+    }
+
+    #[test]
+    fn test_truncated_request_is_rejected() {
+        let encoded = encode_test_request();
+        for len in [0, 5, encoded.len() - 1] {
+            assert!(decode_request(&encoded[..len]).is_err());
+        }
+    }
+
+    #[test]
+    fn test_oversized_length_is_rejected_without_allocating() {
+        let mut encoded = encode_test_request();
+        // Claim u32::MAX row indices
+        encoded[14..18].copy_from_slice(&u32::MAX.to_le_bytes());
+        assert!(decode_request(&encoded).is_err());
+    }
+
+    #[test]
+    fn test_encode_response_orders_values_by_variable() {
+        let solution = ApiSolution {
+            status: Status::Optimal,
+            objective: 6,
+            solution: ApiValues::Named(HashMap::from([
+                ("x2".to_string(), 1),
+                ("x1".to_string(), 3),
+            ])),
+            error: None,
+        };
+        let dense = ApiSolution {
+            solution: ApiValues::Dense(vec![3, 1]),
+            error: None,
+            ..solution
+        };
+        let variable_ids = ["x1".to_string(), "x2".to_string()];
+        let encoded = encode_response(&[solution], &variable_ids);
+
+        let mut expected = Vec::new();
+        expected.extend_from_slice(RESPONSE_MAGIC);
+        expected.push(VERSION);
+        put_u32(&mut expected, 1);
+        expected.push(Status::Optimal as u8);
+        expected.extend_from_slice(&6i32.to_le_bytes());
+        put_i32s(&mut expected, &[3, 1]);
+        expected.push(0);
+        assert_eq!(encoded, expected);
+        assert_eq!(encode_response(&[dense], &variable_ids), expected);
+    }
+}
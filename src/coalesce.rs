@@ -0,0 +1,304 @@
+//! Single-flight deduplication of identical solve requests, with an optional
+//! short-lived cache of their results.
+//!
+//! Requests are keyed by `SolveKey`. The first request for a key (the leader)
+//! runs the solve; identical requests arriving while it runs (followers) wait
+//! for its outcome instead of taking a solver permit of their own.
+
+use crate::domain::fingerprint::SolveKey;
+use crate::metrics;
+use crate::models::ApiSolution;
+use crate::scheduler::Rejection;
+use lru::LruCache;
+use parking_lot::Mutex;
+use std::collections::HashMap;
+use std::future::Future;
+use std::num::NonZeroUsize;
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+use tokio::sync::watch;
+
+/// Why a solve produced no solutions
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub enum SolveFailure {
+    /// Rejected by the solver (answered with 422 and these details)
+    Input(String),
+    /// Not admitted by the scheduler (answered with 429 or 503)
+    Rejected(Rejection),
+    /// Anything else, e.g. a failed permit or a panicked solver thread
+    Internal,
+}
+
+pub type SolveOutcome = Result<Arc<Vec<ApiSolution>>, SolveFailure>;
+
+/// Coalescing and result cache settings
+#[derive(Clone, Copy, Debug)]
+pub struct CoalesceConfig {
+    /// Let identical in-flight requests share one solve
+    pub coalesce: bool,
+    /// How long successful results are served from the cache (zero disables it)
+    pub result_ttl: Duration,
+    /// Maximum number of cached results
+    pub result_capacity: usize,
+}
+
+struct CachedResult {
+    solved_at: Instant,
+    solutions: Arc<Vec<ApiSolution>>,
+}
+
+type Flight = watch::Receiver<Option<SolveOutcome>>;
+
+pub struct Coalescer {
+    coalesce: bool,
+    in_flight: Mutex<HashMap<SolveKey, Flight>>,
+    results: Option<Mutex<LruCache<SolveKey, CachedResult>>>,
+    result_ttl: Duration,
+}
+
+enum Joined {
+    Cached(Arc<Vec<ApiSolution>>),
+    Follower(Flight),
+    Leader(Option<watch::Sender<Option<SolveOutcome>>>),
+}
+
+/// Removes a leader's flight when it finishes or is cancelled
+struct FlightGuard<'a> {
+    coalescer: &'a Coalescer,
+    key: SolveKey,
+}
+
+impl Drop for FlightGuard<'_> {
+    fn drop(&mut self) {
+        self.coalescer.in_flight.lock().remove(&self.key);
+    }
+}
+
+impl Coalescer {
+    pub fn new(config: CoalesceConfig) -> Self {
+        let results = NonZeroUsize::new(config.result_capacity)
+            .filter(|_| !config.result_ttl.is_zero())
+            .map(|capacity| Mutex::new(LruCache::new(capacity)));
+        Coalescer {
+            coalesce: config.coalesce,
+            in_flight: Mutex::new(HashMap::new()),
+            results,
+            result_ttl: config.result_ttl,
+        }
+    }
+
+    /// Answer the request identified by `key`, calling `solve` only when no
+    /// fresh cached result and no identical in-flight solve exists.
+    ///
+    /// If the leader is cancelled (its client went away) or the scheduler
+    /// rejected it, one of its followers takes over and solves instead.
+    pub async fn run<F, Fut>(&self, key: SolveKey, solve: F) -> SolveOutcome
+    where
+        F: FnOnce() -> Fut,
+        Fut: Future<Output = SolveOutcome>,
+    {
+        let sender = loop {
+            let mut flight = match self.join(key) {
+                Joined::Cached(solutions) => return Ok(solutions),
+                Joined::Leader(sender) => break sender,
+                Joined::Follower(flight) => flight,
+            };
+            let shared = match flight.wait_for(Option::is_some).await {
+                Ok(outcome) => outcome.clone(),
+                // The leader was cancelled before it finished
+                Err(_) => None,
+            };
+            match shared {
+                // The leader's admission was its own (e.g. its priority
+                // class was full), so the follower asks for its own
+                Some(Err(SolveFailure::Rejected(_))) | None => (),
+                Some(outcome) => return outcome,
+            }
+        };
+
+        let guard = sender.as_ref().map(|_| FlightGuard {
+            coalescer: self,
+            key,
+        });
+        let outcome = solve().await;
+        if let (Some(results), Ok(solutions)) = (&self.results, &outcome) {
+            results.lock().put(
+                key,
+                CachedResult {
+                    solved_at: Instant::now(),
+                    solutions: solutions.clone(),
+                },
+            );
+        }
+        // Followers sent back to `join` must not find this flight again
+        drop(guard);
+        if let Some(sender) = sender {
+            sender.send_replace(Some(outcome.clone()));
+        }
+        outcome
+    }
+
+    fn join(&self, key: SolveKey) -> Joined {
+        if let Some(results) = &self.results {
+            let mut results = results.lock();
+            match results.get(&key) {
+                Some(cached) if cached.solved_at.elapsed() < self.result_ttl => {
+                    metrics::global().result_cache_hit();
+                    return Joined::Cached(cached.solutions.clone());
+                }
+                Some(_) => {
+                    results.pop(&key);
+                }
+                None => (),
+            }
+        }
+
+        if !self.coalesce {
+            return Joined::Leader(None);
+        }
+        let mut in_flight = self.in_flight.lock();
+        if let Some(flight) = in_flight.get(&key) {
+            metrics::global().solve_coalesced();
+            return Joined::Follower(flight.clone());
+        }
+        let (sender, flight) = watch::channel(None);
+        in_flight.insert(key, flight);
+        Joined::Leader(Some(sender))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::fingerprint::Fingerprint;
+    use crate::domain::solver::SolveLimits;
+    use crate::models::{
+        ApiIntegerSparseMatrix, ApiShape, SolverDirection, SparseLEIntegerPolyhedron,
+    };
+    use std::sync::atomic::{AtomicUsize, Ordering};
+    use tokio::sync::oneshot;
+
+    fn create_test_key() -> SolveKey {
+        let polyhedron = SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![],
+                cols: vec![],
+                vals: vec![],
+                shape: ApiShape { nrows: 0, ncols: 0 },
+            },
+            b: vec![],
+            variables: vec![],
+        };
+        SolveKey::of(
+            Fingerprint::of(&polyhedron),
+            &vec![].into(),
+            SolverDirection::Maximize,
+            None,
+            SolveLimits::default(),
+        )
+    }
+
+    fn config(coalesce: bool, result_ttl: Duration) -> CoalesceConfig {
+        CoalesceConfig {
+            coalesce,
+            result_ttl,
+            result_capacity: 8,
+        }
+    }
+
+    #[tokio::test]
+    async fn test_followers_share_the_leader_solve() {
+        let coalescer = Coalescer::new(config(true, Duration::ZERO));
+        let key = create_test_key();
+        let solves = &AtomicUsize::new(0);
+        let (release, gate) = oneshot::channel::<()>();
+
+        let leader = coalescer.run(key, || async move {
+            solves.fetch_add(1, Ordering::SeqCst);
+            let _ = gate.await;
+            Ok(Arc::new(vec![]))
+        });
+        let follower = coalescer.run(key, || async move {
+            solves.fetch_add(1, Ordering::SeqCst);
+            Ok(Arc::new(vec![]))
+        });
+        let (leader, follower, _) = tokio::join!(leader, follower, async {
+            tokio::task::yield_now().await;
+            release.send(())
+        });
+
+        assert!(leader.is_ok() && follower.is_ok());
+        assert_eq!(solves.load(Ordering::SeqCst), 1);
+        assert!(coalescer.in_flight.lock().is_empty());
+    }
+
+    #[tokio::test]
+    async fn test_failures_are_shared_but_not_cached() {
+        let coalescer = Coalescer::new(config(true, Duration::from_secs(60)));
+        let key = create_test_key();
+
+        let failed = coalescer
+            .run(key, || async {
+                Err(SolveFailure::Input("bad".to_string()))
+            })
+            .await;
+        assert_eq!(failed.err(), Some(SolveFailure::Input("bad".to_string())));
+
+        let solves = &AtomicUsize::new(0);
+        for _ in 0..2 {
+            let solved = coalescer
+                .run(key, || async move {
+                    solves.fetch_add(1, Ordering::SeqCst);
+                    Ok(Arc::new(vec![]))
+                })
+                .await;
+            assert!(solved.is_ok());
+        }
+        // The second request is served from the result cache
+        assert_eq!(solves.load(Ordering::SeqCst), 1);
+    }
+
+    #[tokio::test]
+    async fn test_followers_retry_after_a_rejected_leader() {
+        let coalescer = Coalescer::new(config(true, Duration::ZERO));
+        let key = create_test_key();
+        let solves = &AtomicUsize::new(0);
+        let (release, gate) = oneshot::channel::<()>();
+
+        let leader = coalescer.run(key, || async move {
+            let _ = gate.await;
+            Err(SolveFailure::Rejected(Rejection::QueueFull {
+                retry_after: Duration::from_secs(1),
+            }))
+        });
+        let follower = coalescer.run(key, || async move {
+            solves.fetch_add(1, Ordering::SeqCst);
+            Ok(Arc::new(vec![]))
+        });
+        let (leader, follower, _) = tokio::join!(leader, follower, async {
+            tokio::task::yield_now().await;
+            release.send(())
+        });
+
+        assert!(matches!(leader, Err(SolveFailure::Rejected(_))));
+        assert!(follower.is_ok());
+        assert_eq!(solves.load(Ordering::SeqCst), 1);
+        assert!(coalescer.in_flight.lock().is_empty());
+    }
+
+    #[tokio::test]
+    async fn test_disabled_coalescing_solves_every_request() {
+        let coalescer = Coalescer::new(config(false, Duration::ZERO));
+        let key = create_test_key();
+        let solves = &AtomicUsize::new(0);
+        for _ in 0..2 {
+            let _ = coalescer
+                .run(key, || async move {
+                    solves.fetch_add(1, Ordering::SeqCst);
+                    Ok(Arc::new(vec![]))
+                })
+                .await;
+        }
+        assert_eq!(solves.load(Ordering::SeqCst), 2);
+    }
+}
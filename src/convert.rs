@@ -1,10 +1,11 @@
 use crate::models::{
-    ApiIntegerSparseMatrix, ApiSolution, ObjectiveOwned, SparseLEIntegerPolyhedron, Status,
+    ApiIntegerSparseMatrix, ApiSolution, ApiValues, ApiVariable, Assignment, IndexedObjective,
+    ObjectiveOwned, Status,
 };
 use std::collections::HashMap;
 
 use glpk_rust::{
-    Bound, IntegerSparseMatrix as GlpkMatrix, Solution, SparseLEIntegerPolyhedron as GlpkPoly,
+    IntegerSparseMatrix as GlpkMatrix, Solution, SparseLEIntegerPolyhedron as GlpkPoly,
     Status as GlpkStatus, Variable as GlpkVar,
 };
 
@@ -12,33 +13,102 @@ pub fn to_borrowed_objective(obj: &ObjectiveOwned) -> HashMap<&str, f64> {
     obj.iter().map(|(k, v)| (k.as_str(), *v)).collect()
 }
 
-/// Convert an API LE polyhedron to a GLPK LE polyhedron by building borrowed variables.
-pub fn to_glpk_polyhedron<'a>(le: &'a SparseLEIntegerPolyhedron) -> GlpkPoly<'a> {
-    let a = to_glpk_matrix(&le.a);
-    let b: Vec<Bound> = le.b.iter().map(|&v| (0, v)).collect();
+/// Borrow the variable ids of an indexed objective for GLPK.
+///
+/// Columns must already be validated against `variables`.
+pub fn to_borrowed_indexed_objective<'a>(
+    obj: &IndexedObjective,
+    variables: &'a [ApiVariable],
+) -> HashMap<&'a str, f64> {
+    obj.iter()
+        .map(|&(col, coeff)| (variables[col].id.as_str(), coeff))
+        .collect()
+}
+
+/// Solution values in variable order, keyed by variable id unless `dense`
+pub fn to_api_values(variables: &[ApiVariable], values: Vec<i32>, dense: bool) -> ApiValues {
+    if dense {
+        return ApiValues::Dense(values);
+    }
+    ApiValues::Named(
+        variables
+            .iter()
+            .zip(values)
+            .map(|(v, value)| (v.id.clone(), value))
+            .collect(),
+    )
+}
+
+/// Solution of an objective that was not solved because the time limit ran out
+pub fn timed_out_solution(variables: &[ApiVariable], dense: bool) -> ApiSolution {
+    ApiSolution {
+        status: Status::TimeLimit,
+        objective: 0,
+        solution: to_api_values(variables, vec![0; variables.len()], dense),
+        error: None,
+    }
+}
 
-    let variables: Vec<GlpkVar<'a>> = le
-        .variables
+/// Convert an assignment to dense column values in variable order.
+///
+/// Variables missing from the assignment default to 0, moved into their bounds.
+pub fn to_column_values(variables: &[ApiVariable], assignment: &Assignment) -> Vec<f64> {
+    variables
         .iter()
-        .map(|v| GlpkVar {
-            id: v.id.as_str(), // borrow directly from ApiVariable
-            bound: v.bound,
+        .map(|v| {
+            let (lower, upper) = v.bound;
+            let value = assignment
+                .get(&v.id)
+                .copied()
+                .unwrap_or_else(|| 0.max(lower).min(upper));
+            value as f64
         })
-        .collect();
+        .collect()
+}
+
+/// Consume the matrix and right-hand side of an API polyhedron into a GLPK
+/// polyhedron without copying `A`. Variable ids are borrowed from `variables`.
+pub fn into_glpk_polyhedron(
+    a: ApiIntegerSparseMatrix,
+    b: Vec<i32>,
+    variables: &[ApiVariable],
+) -> GlpkPoly<'_> {
+    let ApiIntegerSparseMatrix {
+        rows, cols, vals, ..
+    } = a;
 
     GlpkPoly {
-        a,
-        b,
-        variables,
+        a: GlpkMatrix { rows, cols, vals },
+        b: b.into_iter().map(|v| (0, v)).collect(),
+        variables: variables
+            .iter()
+            .map(|v| GlpkVar {
+                id: v.id.as_str(), // borrow directly from ApiVariable
+                bound: v.bound,
+            })
+            .collect(),
         double_bound: false,
     }
 }
 
-fn to_glpk_matrix(m: &ApiIntegerSparseMatrix) -> GlpkMatrix {
-    GlpkMatrix {
-        rows: m.rows.clone(),
-        cols: m.cols.clone(),
-        vals: m.vals.clone(),
+/// Copy a GLPK polyhedron for another solver thread
+pub fn copy_glpk_polyhedron<'a>(p: &GlpkPoly<'a>) -> GlpkPoly<'a> {
+    GlpkPoly {
+        a: GlpkMatrix {
+            rows: p.a.rows.clone(),
+            cols: p.a.cols.clone(),
+            vals: p.a.vals.clone(),
+        },
+        b: p.b.clone(),
+        variables: p
+            .variables
+            .iter()
+            .map(|v| GlpkVar {
+                id: v.id,
+                bound: v.bound,
+            })
+            .collect(),
+        double_bound: p.double_bound,
     }
 }
 
@@ -59,17 +129,28 @@ impl From<GlpkStatus> for Status {
     }
 }
 
-impl From<Solution> for ApiSolution {
-    fn from(s: Solution) -> Self {
-        ApiSolution {
-            status: s.status.into(),
-            objective: s.objective as i32, // Match current api contract
-            solution: s
-                .solution
+/// Convert a GLPK solution, laying its values out in variable order when `dense`
+pub fn from_glpk_solution(s: Solution, variables: &[ApiVariable], dense: bool) -> ApiSolution {
+    let solution = if dense {
+        ApiValues::Dense(
+            variables
+                .iter()
+                .map(|v| s.solution.get(v.id.as_str()).copied().unwrap_or(0))
+                .collect(),
+        )
+    } else {
+        ApiValues::Named(
+            s.solution
                 .into_iter()
                 .map(|(k, v)| (k.to_string(), v))
                 .collect(),
-            error: s.error,
-        }
+        )
+    };
+
+    ApiSolution {
+        status: s.status.into(),
+        objective: s.objective as i32, // Match current api contract
+        solution,
+        error: s.error,
     }
 }
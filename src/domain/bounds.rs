@@ -0,0 +1,142 @@
+use crate::metrics;
+use crate::models::SparseLEIntegerPolyhedron;
+
+/// Right-hand sides and variable bounds a cached model currently holds.
+///
+/// Models are cached per matrix structure (`Fingerprint::structure`), so a
+/// checked-out replica may hold the `b` and bounds of an earlier request.
+/// Kept with the model to find the rows and columns that need updating.
+#[derive(Debug)]
+pub struct ModelBounds {
+    rhs: Vec<i32>,
+    bounds: Vec<(i32, i32)>,
+}
+
+/// Rows and columns whose values differ from the ones a model holds
+#[derive(Debug, Default, PartialEq, Eq)]
+pub struct BoundChanges {
+    pub rows: Vec<usize>,
+    pub cols: Vec<usize>,
+}
+
+impl BoundChanges {
+    pub fn is_empty(&self) -> bool {
+        self.rows.is_empty() && self.cols.is_empty()
+    }
+}
+
+impl ModelBounds {
+    pub fn new(polyhedron: &SparseLEIntegerPolyhedron) -> Self {
+        ModelBounds {
+            rhs: polyhedron.b.clone(),
+            bounds: polyhedron.variables.iter().map(|v| v.bound).collect(),
+        }
+    }
+
+    /// Rows and columns where `polyhedron` differs from the held values.
+    ///
+    /// The polyhedron must have the structure the model was built from.
+    pub fn changes(&self, polyhedron: &SparseLEIntegerPolyhedron) -> BoundChanges {
+        let rows = self
+            .rhs
+            .iter()
+            .zip(&polyhedron.b)
+            .enumerate()
+            .filter(|(_, (held, wanted))| held != wanted)
+            .map(|(row, _)| row)
+            .collect();
+        let cols = self
+            .bounds
+            .iter()
+            .zip(&polyhedron.variables)
+            .enumerate()
+            .filter(|(_, (held, variable))| **held != variable.bound)
+            .map(|(col, _)| col)
+            .collect();
+        BoundChanges { rows, cols }
+    }
+
+    /// Record `changes` of `polyhedron` once the model holds them
+    pub fn commit(&mut self, polyhedron: &SparseLEIntegerPolyhedron, changes: &BoundChanges) {
+        for &row in &changes.rows {
+            self.rhs[row] = polyhedron.b[row];
+        }
+        for &col in &changes.cols {
+            self.bounds[col] = polyhedron.variables[col].bound;
+        }
+        if !changes.is_empty() {
+            metrics::global().model_patched();
+        }
+    }
+
+    /// Record the `b` and bounds of `polyhedron`, returning what changed.
+    ///
+    /// For models whose updates cannot fail; the others `commit` the
+    /// `changes` once they are applied.
+    pub fn update(&mut self, polyhedron: &SparseLEIntegerPolyhedron) -> BoundChanges {
+        let changes = self.changes(polyhedron);
+        self.commit(polyhedron, &changes);
+        changes
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::{ApiIntegerSparseMatrix, ApiShape, ApiVariable};
+
+    fn create_test_polyhedron() -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0, 1],
+                cols: vec![0, 1],
+                vals: vec![1, 1],
+                shape: ApiShape { nrows: 2, ncols: 2 },
+            },
+            b: vec![1, 1],
+            variables: vec![
+                ApiVariable {
+                    id: "x".to_string(),
+                    bound: (0, 1),
+                },
+                ApiVariable {
+                    id: "y".to_string(),
+                    bound: (0, 1),
+                },
+            ],
+        }
+    }
+
+    #[test]
+    fn test_update_reports_only_changed_entries() {
+        let mut polyhedron = create_test_polyhedron();
+        let mut bounds = ModelBounds::new(&polyhedron);
+        assert!(bounds.update(&polyhedron).is_empty());
+
+        polyhedron.b[1] = 0;
+        polyhedron.variables[0].bound = (1, 1);
+        assert_eq!(
+            bounds.update(&polyhedron),
+            BoundChanges {
+                rows: vec![1],
+                cols: vec![0],
+            }
+        );
+        // Applied changes are remembered
+        assert!(bounds.update(&polyhedron).is_empty());
+    }
+
+    #[test]
+    fn test_changes_are_held_only_once_committed() {
+        let mut polyhedron = create_test_polyhedron();
+        let mut bounds = ModelBounds::new(&polyhedron);
+        polyhedron.b[0] = 0;
+
+        let changes = bounds.changes(&polyhedron);
+        assert_eq!(changes.rows, vec![0]);
+        // A failed update leaves the model's old values recorded
+        assert_eq!(bounds.changes(&polyhedron), changes);
+        bounds.commit(&polyhedron, &changes);
+        assert!(bounds.changes(&polyhedron).is_empty());
+    }
+}
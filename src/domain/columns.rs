@@ -0,0 +1,120 @@
+use crate::domain::validate::{validate_objectives_indexed, SolveInputError};
+use crate::models::{ApiObjectives, ApiVariable, ObjectiveOwned};
+use std::collections::HashMap;
+
+/// Objective as `(column, coefficient)` pairs, zero coefficients dropped
+pub type SparseObjective = Vec<(usize, f64)>;
+
+/// Variable id to column position of one polyhedron.
+///
+/// Built once per model and stored with it, so cache hits validate and
+/// resolve objectives without rebuilding a set of variable ids.
+#[derive(Debug)]
+pub struct ColumnIndex {
+    columns: HashMap<String, usize>,
+}
+
+impl ColumnIndex {
+    pub fn new(variables: &[ApiVariable]) -> Self {
+        ColumnIndex {
+            columns: variables
+                .iter()
+                .enumerate()
+                .map(|(col, v)| (v.id.clone(), col))
+                .collect(),
+        }
+    }
+
+    /// Resolve objectives to column form, failing on the first unknown
+    /// variable id or out of range or repeated column
+    pub fn resolve(
+        &self,
+        objectives: ApiObjectives,
+    ) -> Result<Vec<SparseObjective>, SolveInputError> {
+        match objectives {
+            ApiObjectives::Named(objectives) => self.resolve_named(&objectives),
+            ApiObjectives::Indexed(mut objectives) => {
+                validate_objectives_indexed(self.columns.len(), &objectives)?;
+                for objective in &mut objectives {
+                    objective.retain(|&(_, coeff)| coeff != 0.0);
+                }
+                Ok(objectives)
+            }
+        }
+    }
+
+    fn resolve_named(
+        &self,
+        objectives: &[ObjectiveOwned],
+    ) -> Result<Vec<SparseObjective>, SolveInputError> {
+        objectives
+            .iter()
+            .map(|objective| {
+                let mut resolved = Vec::with_capacity(objective.len());
+                for (id, &coeff) in objective {
+                    let col = self.columns.get(id).ok_or_else(|| SolveInputError {
+                        details: format!("Objective contains missing variable {}", id),
+                    })?;
+                    if coeff != 0.0 {
+                        resolved.push((*col, coeff));
+                    }
+                }
+                Ok(resolved)
+            })
+            .collect()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn create_test_index() -> ColumnIndex {
+        ColumnIndex::new(&[
+            ApiVariable {
+                id: "x1".to_string(),
+                bound: (0, 1),
+            },
+            ApiVariable {
+                id: "x2".to_string(),
+                bound: (0, 1),
+            },
+        ])
+    }
+
+    #[test]
+    fn test_resolve_maps_ids_to_columns() {
+        let index = create_test_index();
+        let objectives = vec![HashMap::from([
+            ("x2".to_string(), 2.0),
+            ("x1".to_string(), 0.0),
+        ])];
+        assert_eq!(
+            index.resolve(objectives.into()).ok().unwrap(),
+            vec![vec![(1, 2.0)]]
+        );
+    }
+
+    #[test]
+    fn test_resolve_keeps_indexed_objectives() {
+        let index = create_test_index();
+        let objectives = ApiObjectives::Indexed(vec![vec![(1, 2.0), (0, 0.0)]]);
+        assert_eq!(
+            index.resolve(objectives).ok().unwrap(),
+            vec![vec![(1, 2.0)]]
+        );
+
+        let out_of_range = ApiObjectives::Indexed(vec![vec![(2, 1.0)]]);
+        assert!(index.resolve(out_of_range).is_err());
+
+        let repeated = ApiObjectives::Indexed(vec![vec![(0, 3.0), (0, -1.0)]]);
+        assert!(index.resolve(repeated).is_err());
+    }
+
+    #[test]
+    fn test_resolve_rejects_missing_variable() {
+        let index = create_test_index();
+        let objectives = vec![HashMap::from([("missing".to_string(), 0.0)])];
+        assert!(index.resolve(objectives.into()).is_err());
+    }
+}
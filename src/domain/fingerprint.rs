@@ -0,0 +1,476 @@
+use crate::domain::solver::SolveLimits;
+use crate::models::{
+    ApiObjectives, Assignment, IndexedObjective, ObjectiveOwned, SolverDirection,
+    SparseLEIntegerPolyhedron,
+};
+use std::collections::hash_map::{DefaultHasher, RandomState};
+use std::hash::{BuildHasher, Hash, Hasher};
+use std::sync::OnceLock;
+
+/// Compact content fingerprint of a polyhedron.
+///
+/// Used as the model cache key instead of the polyhedron itself, so cache
+/// lookups hash and compare a fixed-size value regardless of model size.
+///
+/// A fingerprint holds two independent hashes of the content: a fast 128-bit
+/// hash with fixed seeds, stable across restarts and shown by `Display`,
+/// and a SipHash keyed per process from OS randomness. Keys only match if
+/// both hashes, the shape and the non-zero count are equal, so colliding
+/// polyhedra cannot be crafted from the public seeds alone.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub struct Fingerprint {
+    hash: u128,
+    /// Hash of the matrix and variable ids only, see `structure`
+    structure: u128,
+    /// Keyed hashes verifying `hash` and `structure`
+    check: u64,
+    structure_check: u64,
+    nrows: usize,
+    ncols: usize,
+    nnz: usize,
+}
+
+impl Fingerprint {
+    /// Compute the fingerprint of a polyhedron in a single pass over its data
+    pub fn of(polyhedron: &SparseLEIntegerPolyhedron) -> Self {
+        let mut hasher = DualHasher::new();
+        polyhedron.a.hash(&mut hasher);
+        hasher.write_usize(polyhedron.variables.len());
+        for variable in &polyhedron.variables {
+            variable.id.hash(&mut hasher);
+        }
+        let (structure, structure_check) = hasher.finish();
+
+        // The full hashes continue from the structure hashes
+        polyhedron.b.hash(&mut hasher);
+        for variable in &polyhedron.variables {
+            variable.bound.hash(&mut hasher);
+        }
+        let (hash, check) = hasher.finish();
+
+        Fingerprint {
+            hash,
+            structure,
+            check,
+            structure_check,
+            nrows: polyhedron.a.shape.nrows,
+            ncols: polyhedron.a.shape.ncols,
+            nnz: polyhedron.a.vals.len(),
+        }
+    }
+
+    /// Identifier of the polyhedron within this process, covering both hashes
+    pub fn id(&self) -> String {
+        format!("{:032x}{:016x}", self.hash, self.check)
+    }
+
+    /// Rough memory of one solver model of this polyhedron: the matrix with
+    /// 8-byte values and 4-byte indices, kept column- and row-wise, plus
+    /// bounds, costs and bookkeeping per row and column
+    pub fn model_bytes(&self) -> usize {
+        self.nnz * 2 * (8 + 4) + (self.nrows + self.ncols) * 64
+    }
+
+    /// Fingerprint of the polyhedron's matrix and variable ids, ignoring `b`
+    /// and the variable bounds.
+    ///
+    /// Models are cached under this key, so requests that only change
+    /// right-hand sides or bounds reuse a model and update it in place.
+    pub fn structure(&self) -> Fingerprint {
+        Fingerprint {
+            hash: self.structure,
+            check: self.structure_check,
+            ..*self
+        }
+    }
+
+    /// Spread fingerprints over `shards` buckets by their content hash
+    pub fn shard(&self, shards: usize) -> usize {
+        (self.hash % shards as u128) as usize
+    }
+}
+
+impl std::fmt::Display for Fingerprint {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "{:032x}", self.hash)
+    }
+}
+
+/// Fingerprint of a whole solve request: the polyhedron plus everything
+/// else that decides its solutions.
+///
+/// Named objectives and the hint are hashed in id order, so two requests
+/// that only differ in JSON key order share a key.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub struct SolveKey {
+    polyhedron: Fingerprint,
+    rest: (u128, u64),
+}
+
+impl SolveKey {
+    pub fn of(
+        polyhedron: Fingerprint,
+        objectives: &ApiObjectives,
+        direction: SolverDirection,
+        hint: Option<&Assignment>,
+        limits: SolveLimits,
+    ) -> Self {
+        let mut hasher = DualHasher::new();
+        match objectives {
+            ApiObjectives::Named(objectives) => {
+                hasher.write_u8(0);
+                for objective in objectives {
+                    hash_named_objective(&mut hasher, objective);
+                }
+            }
+            ApiObjectives::Indexed(objectives) => {
+                hasher.write_u8(1);
+                for objective in objectives {
+                    hash_indexed_objective(&mut hasher, objective);
+                }
+            }
+        }
+        hash_direction(&mut hasher, direction);
+        if let Some(hint) = hint {
+            let mut values: Vec<_> = hint.iter().collect();
+            values.sort_unstable();
+            values.hash(&mut hasher);
+        }
+        limits
+            .time_limit
+            .map(|limit| limit.as_nanos())
+            .hash(&mut hasher);
+        limits.mip_gap.map(f64::to_bits).hash(&mut hasher);
+
+        SolveKey {
+            polyhedron,
+            rest: hasher.finish(),
+        }
+    }
+}
+
+/// Fingerprint of a single objective of a request, identifying one solution
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub struct ObjectiveKey {
+    polyhedron: Fingerprint,
+    objective: (u128, u64),
+}
+
+impl ObjectiveKey {
+    pub fn named(
+        polyhedron: Fingerprint,
+        objective: &ObjectiveOwned,
+        direction: SolverDirection,
+    ) -> Self {
+        let mut hasher = DualHasher::new();
+        hasher.write_u8(0);
+        hash_named_objective(&mut hasher, objective);
+        hash_direction(&mut hasher, direction);
+        ObjectiveKey {
+            polyhedron,
+            objective: hasher.finish(),
+        }
+    }
+
+    pub fn indexed(
+        polyhedron: Fingerprint,
+        objective: &IndexedObjective,
+        direction: SolverDirection,
+    ) -> Self {
+        let mut hasher = DualHasher::new();
+        hasher.write_u8(1);
+        hash_indexed_objective(&mut hasher, objective);
+        hash_direction(&mut hasher, direction);
+        ObjectiveKey {
+            polyhedron,
+            objective: hasher.finish(),
+        }
+    }
+}
+
+/// Hash a named objective in id order
+fn hash_named_objective(hasher: &mut DualHasher, objective: &ObjectiveOwned) {
+    let mut terms: Vec<_> = objective.iter().collect();
+    terms.sort_unstable_by(|a, b| a.0.cmp(b.0));
+    hasher.write_usize(terms.len());
+    for (id, coeff) in terms {
+        id.hash(hasher);
+        hasher.write_u64(coeff.to_bits());
+    }
+}
+
+fn hash_indexed_objective(hasher: &mut DualHasher, objective: &IndexedObjective) {
+    hasher.write_usize(objective.len());
+    for &(col, coeff) in objective {
+        hasher.write_usize(col);
+        hasher.write_u64(coeff.to_bits());
+    }
+}
+
+fn hash_direction(hasher: &mut DualHasher, direction: SolverDirection) {
+    hasher.write_u8(match direction {
+        SolverDirection::Maximize => 0,
+        SolverDirection::Minimize => 1,
+    });
+}
+
+/// Feeds everything to a `FingerprintHasher` and a per-process keyed SipHash
+struct DualHasher {
+    public: FingerprintHasher,
+    keyed: DefaultHasher,
+}
+
+impl DualHasher {
+    fn new() -> Self {
+        static KEYS: OnceLock<RandomState> = OnceLock::new();
+        DualHasher {
+            public: FingerprintHasher::new(),
+            keyed: KEYS.get_or_init(RandomState::new).build_hasher(),
+        }
+    }
+
+    /// Both digests of everything written so far; writing may continue
+    fn finish(&self) -> (u128, u64) {
+        (self.public.finish128(), self.keyed.finish())
+    }
+}
+
+impl Hasher for DualHasher {
+    fn write(&mut self, bytes: &[u8]) {
+        self.public.write(bytes);
+        self.keyed.write(bytes);
+    }
+
+    fn finish(&self) -> u64 {
+        self.keyed.finish()
+    }
+}
+
+/// Two-lane 64-bit multiply/rotate hasher producing a 128-bit digest.
+///
+/// Not cryptographic; it only needs to be fast over large integer slices
+/// (the derived `Hash` for `Vec<i32>` feeds the whole slice in one `write`)
+/// and well distributed enough for cache keys.
+struct FingerprintHasher {
+    lo: u64,
+    hi: u64,
+    len: u64,
+}
+
+const SEED_LO: u64 = 0x243f_6a88_85a3_08d3;
+const SEED_HI: u64 = 0x1319_8a2e_0370_7344;
+const MUL_LO: u64 = 0x9e37_79b9_7f4a_7c15;
+const MUL_HI: u64 = 0xc2b2_ae3d_27d4_eb4f;
+
+impl FingerprintHasher {
+    fn new() -> Self {
+        FingerprintHasher {
+            lo: SEED_LO,
+            hi: SEED_HI,
+            len: 0,
+        }
+    }
+
+    #[inline]
+    fn mix_word(&mut self, word: u64) {
+        self.lo = (self.lo ^ word).wrapping_mul(MUL_LO).rotate_left(29);
+        self.hi = (self.hi ^ word.rotate_left(32))
+            .wrapping_mul(MUL_HI)
+            .rotate_left(31);
+    }
+
+    fn finish128(&self) -> u128 {
+        let lo = avalanche(self.lo ^ self.len);
+        let hi = avalanche(self.hi ^ self.len.rotate_left(17) ^ lo);
+        ((hi as u128) << 64) | (avalanche(lo ^ hi) as u128)
+    }
+}
+
+/// Final 64-bit mixer (from MurmurHash3's fmix64)
+#[inline]
+fn avalanche(mut x: u64) -> u64 {
+    x ^= x >> 33;
+    x = x.wrapping_mul(0xff51_afd7_ed55_8ccd);
+    x ^= x >> 33;
+    x = x.wrapping_mul(0xc4ce_b9fe_1a85_ec53);
+    x ^= x >> 33;
+    x
+}
+
+impl Hasher for FingerprintHasher {
+    fn write(&mut self, bytes: &[u8]) {
+        let mut chunks = bytes.chunks_exact(8);
+        for chunk in &mut chunks {
+            self.mix_word(u64::from_le_bytes(chunk.try_into().unwrap()));
+        }
+
+        let tail = chunks.remainder();
+        if !tail.is_empty() {
+            let mut buf = [0u8; 8];
+            buf[..tail.len()].copy_from_slice(tail);
+            // Tag the partial word with its length so e.g. "a" and "a\0" differ
+            self.mix_word(u64::from_le_bytes(buf) ^ ((tail.len() as u64) << 59));
+        }
+
+        self.len = self.len.wrapping_add(bytes.len() as u64);
+    }
+
+    fn finish(&self) -> u64 {
+        self.finish128() as u64
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::{ApiIntegerSparseMatrix, ApiShape, ApiVariable};
+    use std::collections::HashMap;
+
+    fn create_test_polyhedron() -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0, 0, 1],
+                cols: vec![0, 1, 1],
+                vals: vec![1, 2, 1],
+                shape: ApiShape { nrows: 2, ncols: 2 },
+            },
+            b: vec![10, 5],
+            variables: vec![
+                ApiVariable {
+                    id: "x".to_string(),
+                    bound: (0, 10),
+                },
+                ApiVariable {
+                    id: "y".to_string(),
+                    bound: (0, 10),
+                },
+            ],
+        }
+    }
+
+    #[test]
+    fn test_fingerprint_is_deterministic() {
+        let polyhedron = create_test_polyhedron();
+        assert_eq!(
+            Fingerprint::of(&polyhedron),
+            Fingerprint::of(&polyhedron.clone())
+        );
+    }
+
+    #[test]
+    fn test_fingerprint_changes_with_content() {
+        let polyhedron = create_test_polyhedron();
+        let base = Fingerprint::of(&polyhedron);
+
+        let mut changed_val = polyhedron.clone();
+        changed_val.a.vals[2] = 2;
+        assert_ne!(base, Fingerprint::of(&changed_val));
+
+        let mut changed_b = polyhedron.clone();
+        changed_b.b[0] = 11;
+        assert_ne!(base, Fingerprint::of(&changed_b));
+
+        let mut changed_id = polyhedron.clone();
+        changed_id.variables[1].id = "z".to_string();
+        assert_ne!(base, Fingerprint::of(&changed_id));
+
+        let mut changed_bound = polyhedron;
+        changed_bound.variables[0].bound = (0, 9);
+        assert_ne!(base, Fingerprint::of(&changed_bound));
+    }
+
+    #[test]
+    fn test_keyed_check_tells_public_collisions_apart() {
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+        let mut forged = Fingerprint::of(&polyhedron.clone());
+        forged.check ^= 1;
+        assert_eq!(forged.to_string(), fingerprint.to_string());
+        assert_ne!(forged, fingerprint);
+        assert_ne!(forged.id(), fingerprint.id());
+
+        forged = fingerprint;
+        forged.structure_check ^= 1;
+        assert_ne!(forged.structure(), fingerprint.structure());
+    }
+
+    #[test]
+    fn test_structure_ignores_rhs_and_bounds() {
+        let polyhedron = create_test_polyhedron();
+        let base = Fingerprint::of(&polyhedron).structure();
+
+        let mut changed = polyhedron.clone();
+        changed.b[0] = 11;
+        changed.variables[0].bound = (0, 9);
+        assert_eq!(base, Fingerprint::of(&changed).structure());
+
+        let mut changed_val = polyhedron.clone();
+        changed_val.a.vals[2] = 2;
+        assert_ne!(base, Fingerprint::of(&changed_val).structure());
+
+        let mut changed_id = polyhedron;
+        changed_id.variables[1].id = "z".to_string();
+        assert_ne!(base, Fingerprint::of(&changed_id).structure());
+    }
+
+    #[test]
+    fn test_solve_key_ignores_objective_order_of_ids() {
+        let fingerprint = Fingerprint::of(&create_test_polyhedron());
+        let key = |objective: Vec<(&str, f64)>, direction| {
+            let objective: HashMap<String, f64> = objective
+                .into_iter()
+                .map(|(id, coeff)| (id.to_string(), coeff))
+                .collect();
+            SolveKey::of(
+                fingerprint,
+                &vec![objective].into(),
+                direction,
+                None,
+                SolveLimits::default(),
+            )
+        };
+
+        let base = key(vec![("x", 1.0), ("y", 2.0)], SolverDirection::Maximize);
+        assert_eq!(
+            base,
+            key(vec![("y", 2.0), ("x", 1.0)], SolverDirection::Maximize)
+        );
+        assert_ne!(
+            base,
+            key(vec![("x", 1.0), ("y", 3.0)], SolverDirection::Maximize)
+        );
+        assert_ne!(
+            base,
+            key(vec![("x", 1.0), ("y", 2.0)], SolverDirection::Minimize)
+        );
+        assert_ne!(
+            base,
+            SolveKey::of(
+                fingerprint,
+                &ApiObjectives::Indexed(vec![vec![(0, 1.0), (1, 2.0)]]),
+                SolverDirection::Maximize,
+                None,
+                SolveLimits::default()
+            )
+        );
+    }
+
+    #[test]
+    fn test_solve_key_includes_limits() {
+        let fingerprint = Fingerprint::of(&create_test_polyhedron());
+        let key = |mip_gap| {
+            SolveKey::of(
+                fingerprint,
+                &ApiObjectives::Indexed(vec![vec![(0, 1.0)]]),
+                SolverDirection::Maximize,
+                None,
+                SolveLimits {
+                    time_limit: None,
+                    mip_gap,
+                },
+            )
+        };
+        assert_eq!(key(Some(0.1)), key(Some(0.1)));
+        assert_ne!(key(None), key(Some(0.1)));
+    }
+}
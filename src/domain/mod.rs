@@ -1,4 +1,13 @@
+pub mod bounds;
+pub mod columns;
+pub mod fingerprint;
+pub mod model_cache;
+pub mod parallel;
+pub mod portfolio;
+pub mod reduction;
+pub mod solution_cache;
 pub mod solver;
 pub mod solver_factory;
 pub mod solvers;
-mod validate;
+pub mod sparse;
+pub mod validate;
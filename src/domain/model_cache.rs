@@ -0,0 +1,744 @@
+use crate::domain::fingerprint::Fingerprint;
+use crate::domain::validate::SolveInputError;
+use crate::metrics;
+use std::collections::HashMap;
+use std::ops::{Deref, DerefMut};
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+use parking_lot::{Condvar, Mutex, RwLock};
+
+/// Model cache sizing
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ModelCacheConfig {
+    /// Maximum number of model replicas kept across all cached polyhedra
+    pub capacity: usize,
+    /// Maximum number of independent replicas per polyhedron
+    pub replicas_per_model: usize,
+    /// Maximum estimated memory of all cached replicas, see `Fingerprint::model_bytes`
+    pub budget_bytes: Option<usize>,
+}
+
+impl ModelCacheConfig {
+    /// Cache holding up to `capacity` models with a single replica each
+    pub fn with_capacity(capacity: usize) -> Self {
+        ModelCacheConfig {
+            capacity,
+            replicas_per_model: 1,
+            budget_bytes: None,
+        }
+    }
+}
+
+/// A bounded pool of independent solver instances for one polyhedron.
+///
+/// Replicas are built on demand when every existing replica is checked out
+/// and the pool is below its limit; otherwise callers wait for a replica to
+/// be returned. With a limit of one this also makes concurrent misses on the
+/// same polyhedron wait for a single build instead of each building a model.
+pub struct ModelPool<M> {
+    state: Mutex<PoolState<M>>,
+    returned: Condvar,
+    max_replicas: usize,
+}
+
+struct PoolState<M> {
+    idle: Vec<M>,
+    /// Replicas that exist or are being built, idle or checked out
+    replicas: usize,
+}
+
+impl<M> ModelPool<M> {
+    pub fn new(max_replicas: usize) -> Self {
+        ModelPool {
+            state: Mutex::new(PoolState {
+                idle: Vec::new(),
+                replicas: 0,
+            }),
+            returned: Condvar::new(),
+            max_replicas: max_replicas.max(1),
+        }
+    }
+
+    /// Number of replicas currently owned by this pool
+    pub fn replicas(&self) -> usize {
+        self.state.lock().replicas
+    }
+
+    /// Check out a replica for exclusive use, building one with `build` if needed.
+    ///
+    /// The replica goes back to the pool when the returned guard is dropped.
+    pub fn checkout<F>(self: &Arc<Self>, build: F) -> Result<PooledModel<M>, SolveInputError>
+    where
+        F: FnOnce() -> Result<M, SolveInputError>,
+    {
+        self.checkout_within(self.max_replicas, build)
+    }
+
+    /// Like `checkout`, but lets the pool grow to `replicas` replicas.
+    ///
+    /// Used by parallel objective workers beyond the first, so a request
+    /// solving on `replicas` threads gets a replica per thread. The extra
+    /// replicas are returned to the pool and reused by later requests.
+    pub fn checkout_spare<F>(
+        self: &Arc<Self>,
+        replicas: usize,
+        build: F,
+    ) -> Result<PooledModel<M>, SolveInputError>
+    where
+        F: FnOnce() -> Result<M, SolveInputError>,
+    {
+        self.checkout_within(self.max_replicas.max(replicas), build)
+    }
+
+    fn checkout_within<F>(
+        self: &Arc<Self>,
+        max_replicas: usize,
+        build: F,
+    ) -> Result<PooledModel<M>, SolveInputError>
+    where
+        F: FnOnce() -> Result<M, SolveInputError>,
+    {
+        {
+            let mut state = self.state.lock();
+            loop {
+                if let Some(model) = state.idle.pop() {
+                    return Ok(self.guard(model));
+                }
+                if state.replicas < max_replicas {
+                    // Reserve the slot before building outside the lock
+                    state.replicas += 1;
+                    break;
+                }
+                self.returned.wait(&mut state);
+            }
+        }
+
+        match build() {
+            Ok(model) => Ok(self.guard(model)),
+            Err(e) => {
+                self.state.lock().replicas -= 1;
+                self.returned.notify_one();
+                Err(e)
+            }
+        }
+    }
+
+    fn guard(self: &Arc<Self>, model: M) -> PooledModel<M> {
+        PooledModel {
+            pool: Arc::clone(self),
+            model: Some(model),
+        }
+    }
+}
+
+/// Exclusive handle to a pooled model replica
+pub struct PooledModel<M> {
+    pool: Arc<ModelPool<M>>,
+    model: Option<M>,
+}
+
+impl<M> Deref for PooledModel<M> {
+    type Target = M;
+
+    fn deref(&self) -> &M {
+        self.model
+            .as_ref()
+            .expect("pooled model present until drop")
+    }
+}
+
+impl<M> DerefMut for PooledModel<M> {
+    fn deref_mut(&mut self) -> &mut M {
+        self.model
+            .as_mut()
+            .expect("pooled model present until drop")
+    }
+}
+
+impl<M> Drop for PooledModel<M> {
+    fn drop(&mut self) {
+        if let Some(model) = self.model.take() {
+            self.pool.state.lock().idle.push(model);
+            self.pool.returned.notify_one();
+        }
+    }
+}
+
+/// Count a cache checkout as a hit, or as a miss when it had to build.
+///
+/// Spare checkouts only count the replicas they add to an already checked
+/// out model, so the miss rate does not grow with parallelism.
+fn record_checkout(built: bool, spare: bool) {
+    match (built, spare) {
+        (true, false) => metrics::global().cache_miss(),
+        (false, false) => metrics::global().cache_hit(),
+        (true, true) => metrics::global().cache_spare_build(),
+        (false, true) => {}
+    }
+}
+
+/// Number of independently locked parts of a model cache
+const SHARDS: usize = 16;
+
+/// A cached polyhedron with its GDSF bookkeeping.
+///
+/// The counters are atomics so a hit only needs its shard's read lock.
+struct CacheEntry<M> {
+    pool: Arc<ModelPool<M>>,
+    /// Checkouts since the entry was inserted
+    hits: AtomicU64,
+    /// Nanoseconds the most recent build of a replica took
+    build_nanos: AtomicU64,
+    /// GDSF priority as `f64` bits, the lowest is evicted first
+    priority: AtomicU64,
+    /// Outstanding `ModelCache::pin` calls; pinned entries are never evicted
+    pins: AtomicUsize,
+}
+
+impl<M> CacheEntry<M> {
+    fn new(max_replicas: usize) -> Self {
+        CacheEntry {
+            pool: Arc::new(ModelPool::new(max_replicas)),
+            hits: AtomicU64::new(0),
+            build_nanos: AtomicU64::new(0),
+            priority: AtomicU64::new(0),
+            pins: AtomicUsize::new(0),
+        }
+    }
+
+    fn priority(&self) -> f64 {
+        f64::from_bits(self.priority.load(Ordering::Relaxed))
+    }
+
+    /// Count a checkout and refresh the priority from the cache clock
+    fn touch(&self, fingerprint: &Fingerprint, clock: f64, build_time: Option<Duration>) {
+        let hits = self.hits.fetch_add(1, Ordering::Relaxed) + 1;
+        if let Some(build_time) = build_time {
+            self.build_nanos
+                .store(build_time.as_nanos() as u64, Ordering::Relaxed);
+        }
+        let bytes = self.pool.replicas().max(1) * fingerprint.model_bytes().max(1);
+        // Builds too fast to time still cost something
+        let cost = (self.build_nanos.load(Ordering::Relaxed) as f64 / 1e9).max(1e-6);
+        let priority = clock + hits as f64 * cost / bytes as f64;
+        self.priority.store(priority.to_bits(), Ordering::Relaxed);
+    }
+}
+
+type Shard<M> = RwLock<HashMap<Fingerprint, Arc<CacheEntry<M>>>>;
+
+/// Cost-aware cache of model pools keyed by polyhedron fingerprint.
+///
+/// Entries are evicted by Greedy-Dual-Size-Frequency: an entry's priority is
+/// the cache clock at its last use plus `hits * build cost / bytes`, so
+/// small, frequently used and slow to build models stay resident longest.
+/// Evicting an entry advances the clock to its priority, which lets entries
+/// that stopped being used age out.
+///
+/// Entries are spread over shards with their own lock. A hit only takes its
+/// shard's read lock; inserting takes the shard's write lock, and eviction
+/// runs only after a build since hits never grow the cache. Concurrent
+/// misses on one polyhedron are deduplicated by its `ModelPool`.
+///
+/// Both budgets count replicas: a hot polyhedron with four replicas uses
+/// four slots of `capacity` and four times its estimated bytes.
+pub struct ModelCache<M> {
+    shards: Vec<Shard<M>>,
+    /// GDSF inflation value as `f64` bits: the priority of the last evicted entry
+    clock: AtomicU64,
+    /// Serializes evictions, which scan every shard
+    eviction: Mutex<()>,
+    config: ModelCacheConfig,
+}
+
+impl<M> ModelCache<M> {
+    pub fn new(config: ModelCacheConfig) -> Self {
+        ModelCache {
+            shards: (0..SHARDS).map(|_| RwLock::new(HashMap::new())).collect(),
+            clock: AtomicU64::new(0),
+            eviction: Mutex::new(()),
+            config,
+        }
+    }
+
+    /// Check out a replica of the model for `fingerprint`, building it if needed
+    pub fn checkout<F>(
+        &self,
+        fingerprint: Fingerprint,
+        build: F,
+    ) -> Result<PooledModel<M>, SolveInputError>
+    where
+        F: FnOnce() -> Result<M, SolveInputError>,
+    {
+        let entry = self.entry(fingerprint);
+        let mut build_time = None;
+        let model = entry.pool.checkout(|| {
+            let start = Instant::now();
+            let model = build();
+            build_time = Some(start.elapsed());
+            model
+        });
+        self.checked_out(fingerprint, &entry, model, build_time, false)
+    }
+
+    /// Check out a replica for a parallel objective worker, growing the
+    /// pool to `replicas`, see `ModelPool::checkout_spare`
+    pub fn checkout_spare<F>(
+        &self,
+        fingerprint: Fingerprint,
+        replicas: usize,
+        build: F,
+    ) -> Result<PooledModel<M>, SolveInputError>
+    where
+        F: FnOnce() -> Result<M, SolveInputError>,
+    {
+        let entry = self.entry(fingerprint);
+        let mut build_time = None;
+        let model = entry.pool.checkout_spare(replicas, || {
+            let start = Instant::now();
+            let model = build();
+            build_time = Some(start.elapsed());
+            model
+        });
+        self.checked_out(fingerprint, &entry, model, build_time, true)
+    }
+
+    /// The entry for `fingerprint`, inserting an empty one on first use
+    fn entry(&self, fingerprint: Fingerprint) -> Arc<CacheEntry<M>> {
+        let shard = &self.shards[fingerprint.shard(SHARDS)];
+        if let Some(entry) = shard.read().get(&fingerprint) {
+            return Arc::clone(entry);
+        }
+        Arc::clone(
+            shard
+                .write()
+                .entry(fingerprint)
+                .or_insert_with(|| Arc::new(CacheEntry::new(self.config.replicas_per_model))),
+        )
+    }
+
+    fn checked_out(
+        &self,
+        fingerprint: Fingerprint,
+        entry: &Arc<CacheEntry<M>>,
+        model: Result<PooledModel<M>, SolveInputError>,
+        build_time: Option<Duration>,
+        spare: bool,
+    ) -> Result<PooledModel<M>, SolveInputError> {
+        record_checkout(build_time.is_some(), spare);
+        let model = model.inspect_err(|_| self.remove_unused(fingerprint, entry))?;
+        // The request's first checkout already counted as a use of the entry
+        if !spare || build_time.is_some() {
+            let clock = f64::from_bits(self.clock.load(Ordering::Relaxed));
+            entry.touch(&fingerprint, clock, build_time);
+        }
+        if build_time.is_some() {
+            self.evict_over_budget(fingerprint);
+        }
+        Ok(model)
+    }
+
+    /// Drop the entry for `fingerprint` if it holds no replica and no pin,
+    /// so polyhedra whose build failed do not stay in the cache
+    fn remove_unused(&self, fingerprint: Fingerprint, entry: &Arc<CacheEntry<M>>) {
+        let mut shard = self.shards[fingerprint.shard(SHARDS)].write();
+        let unused = entry.pool.replicas() == 0 && entry.pins.load(Ordering::Relaxed) == 0;
+        if unused
+            && shard
+                .get(&fingerprint)
+                .is_some_and(|held| Arc::ptr_eq(held, entry))
+        {
+            shard.remove(&fingerprint);
+        }
+    }
+
+    /// Keep the pool for `fingerprint` cached until a matching `unpin`.
+    ///
+    /// Pins nest. Pinned pools still count against the budgets, so a cache
+    /// of only pinned pools may stay over budget.
+    pub fn pin(&self, fingerprint: Fingerprint) {
+        self.entry(fingerprint).pins.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Release one `pin` of the pool for `fingerprint`
+    pub fn unpin(&self, fingerprint: Fingerprint) {
+        if let Some(entry) = self.shards[fingerprint.shard(SHARDS)]
+            .read()
+            .get(&fingerprint)
+        {
+            let _ = entry
+                .pins
+                .fetch_update(Ordering::Relaxed, Ordering::Relaxed, |pins| {
+                    pins.checked_sub(1)
+                });
+        }
+    }
+
+    /// Cached fingerprints, highest priority first
+    pub fn fingerprints(&self) -> Vec<Fingerprint> {
+        let mut entries: Vec<(Fingerprint, f64)> = self
+            .shards
+            .iter()
+            .flat_map(|shard| {
+                shard
+                    .read()
+                    .iter()
+                    .map(|(fingerprint, entry)| (*fingerprint, entry.priority()))
+                    .collect::<Vec<_>>()
+            })
+            .collect();
+        entries.sort_unstable_by(|a, b| b.1.total_cmp(&a.1));
+        entries
+            .into_iter()
+            .map(|(fingerprint, _)| fingerprint)
+            .collect()
+    }
+
+    /// Evict the lowest priority pools until the cache fits both budgets.
+    ///
+    /// The pool for `keep` is never evicted, so a single polyhedron whose
+    /// replicas exceed the budgets on their own still stays cached. Neither
+    /// are pinned pools.
+    fn evict_over_budget(&self, keep: Fingerprint) {
+        let _evicting = self.eviction.lock();
+        let (mut replicas, mut bytes, mut len) = (0, 0, 0);
+        for shard in &self.shards {
+            for (fingerprint, entry) in shard.read().iter() {
+                let pool_replicas = entry.pool.replicas();
+                replicas += pool_replicas;
+                bytes += pool_replicas * fingerprint.model_bytes();
+                len += 1;
+            }
+        }
+
+        let budget_bytes = self.config.budget_bytes.unwrap_or(usize::MAX);
+        let mut evicted = 0;
+        while (replicas > self.config.capacity || bytes > budget_bytes) && len > 1 {
+            // Caches hold few enough polyhedra that a scan beats keeping a
+            // priority queue in sync with every hit
+            let victim = self
+                .shards
+                .iter()
+                .flat_map(|shard| {
+                    shard
+                        .read()
+                        .iter()
+                        .filter(|(fingerprint, entry)| {
+                            **fingerprint != keep && entry.pins.load(Ordering::Relaxed) == 0
+                        })
+                        .map(|(fingerprint, entry)| (*fingerprint, entry.priority()))
+                        .min_by(|a, b| a.1.total_cmp(&b.1))
+                })
+                .min_by(|a, b| a.1.total_cmp(&b.1));
+            let Some((victim, priority)) = victim else {
+                break;
+            };
+            let removed = self.shards[victim.shard(SHARDS)].write().remove(&victim);
+            if let Some(entry) = removed {
+                let pool_replicas = entry.pool.replicas();
+                replicas -= pool_replicas;
+                bytes -= pool_replicas * victim.model_bytes();
+                len -= 1;
+                let clock = f64::from_bits(self.clock.load(Ordering::Relaxed)).max(priority);
+                self.clock.store(clock.to_bits(), Ordering::Relaxed);
+                evicted += 1;
+            }
+        }
+
+        let metrics = metrics::global();
+        metrics.cache_evicted(evicted);
+        metrics.set_cache_bytes(bytes as u64);
+    }
+
+    /// Number of cached polyhedra
+    #[cfg(test)]
+    fn len(&self) -> usize {
+        self.shards.iter().map(|shard| shard.read().len()).sum()
+    }
+
+    #[cfg(test)]
+    fn contains(&self, fingerprint: Fingerprint) -> bool {
+        self.shards[fingerprint.shard(SHARDS)]
+            .read()
+            .contains_key(&fingerprint)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::{ApiIntegerSparseMatrix, ApiShape, SparseLEIntegerPolyhedron};
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    fn fingerprint(rhs: i32) -> Fingerprint {
+        Fingerprint::of(&SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0],
+                cols: vec![0],
+                vals: vec![1],
+                shape: ApiShape { nrows: 1, ncols: 1 },
+            },
+            b: vec![rhs],
+            variables: vec![],
+        })
+    }
+
+    /// Fingerprint of a `n` x `n` diagonal polyhedron
+    fn sized_fingerprint(n: usize) -> Fingerprint {
+        Fingerprint::of(&SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: (0..n as i32).collect(),
+                cols: (0..n as i32).collect(),
+                vals: vec![1; n],
+                shape: ApiShape { nrows: n, ncols: n },
+            },
+            b: vec![1; n],
+            variables: vec![],
+        })
+    }
+
+    fn byte_budget(budget_bytes: usize) -> ModelCacheConfig {
+        ModelCacheConfig {
+            capacity: usize::MAX,
+            replicas_per_model: 1,
+            budget_bytes: Some(budget_bytes),
+        }
+    }
+
+    #[test]
+    fn test_pool_reuses_returned_replica() {
+        let pool = Arc::new(ModelPool::new(2));
+        let builds = AtomicUsize::new(0);
+        let build = || {
+            builds.fetch_add(1, Ordering::SeqCst);
+            Ok(())
+        };
+
+        drop(pool.checkout(build).ok().unwrap());
+        drop(pool.checkout(build).ok().unwrap());
+        assert_eq!(builds.load(Ordering::SeqCst), 1);
+        assert_eq!(pool.replicas(), 1);
+    }
+
+    #[test]
+    fn test_pool_builds_replica_when_all_checked_out() {
+        let pool = Arc::new(ModelPool::new(2));
+        let first = pool.checkout(|| Ok(1)).ok().unwrap();
+        let second = pool.checkout(|| Ok(2)).ok().unwrap();
+        assert_eq!((*first, *second), (1, 2));
+        assert_eq!(pool.replicas(), 2);
+    }
+
+    #[test]
+    fn test_pool_spare_checkout_grows_and_keeps_replicas() {
+        let pool = Arc::new(ModelPool::new(1));
+        let builds = AtomicUsize::new(0);
+        let build = || Ok(builds.fetch_add(1, Ordering::SeqCst));
+
+        for _ in 0..3 {
+            let first = pool.checkout(build).ok().unwrap();
+            let spares: Vec<_> = (0..3)
+                .map(|_| pool.checkout_spare(4, build).ok().unwrap())
+                .collect();
+            drop((first, spares));
+        }
+        // Built once per replica, then reused by later requests
+        assert_eq!(builds.load(Ordering::SeqCst), 4);
+        assert_eq!(pool.replicas(), 4);
+    }
+
+    #[test]
+    fn test_pool_failed_build_releases_slot() {
+        let pool: Arc<ModelPool<i32>> = Arc::new(ModelPool::new(1));
+        let failed = pool.checkout(|| {
+            Err(SolveInputError {
+                details: "boom".to_string(),
+            })
+        });
+        assert!(failed.is_err());
+        assert_eq!(pool.replicas(), 0);
+        assert!(pool.checkout(|| Ok(1)).is_ok());
+    }
+
+    #[test]
+    fn test_cache_forgets_failed_builds() {
+        let cache: ModelCache<i32> = ModelCache::new(ModelCacheConfig::with_capacity(4));
+        let fail = || {
+            Err(SolveInputError {
+                details: "boom".to_string(),
+            })
+        };
+        assert!(cache.checkout(fingerprint(1), fail).is_err());
+        assert!(cache.checkout_spare(fingerprint(1), 2, fail).is_err());
+        assert_eq!(cache.len(), 0);
+
+        // A pinned entry stays for the model to be built later
+        cache.pin(fingerprint(2));
+        assert!(cache.checkout(fingerprint(2), fail).is_err());
+        assert!(cache.contains(fingerprint(2)));
+    }
+
+    #[test]
+    fn test_cache_counts_spare_checkouts_only_when_they_build() {
+        let cache: ModelCache<i32> = ModelCache::new(ModelCacheConfig::with_capacity(4));
+        let hits = || cache.entry(fingerprint(1)).hits.load(Ordering::SeqCst);
+
+        let first = cache.checkout(fingerprint(1), || Ok(1)).ok().unwrap();
+        let spare = cache
+            .checkout_spare(fingerprint(1), 2, || Ok(2))
+            .ok()
+            .unwrap();
+        assert_eq!(hits(), 2);
+        drop((first, spare));
+
+        // Reusing the grown pool is part of the same use of the entry
+        let _first = cache.checkout(fingerprint(1), || Ok(3)).ok().unwrap();
+        let _spare = cache
+            .checkout_spare(fingerprint(1), 2, || Ok(4))
+            .ok()
+            .unwrap();
+        assert_eq!(hits(), 3);
+    }
+
+    #[test]
+    fn test_cache_evicts_by_replica_count() {
+        let cache = ModelCache::new(ModelCacheConfig {
+            capacity: 2,
+            replicas_per_model: 2,
+            budget_bytes: None,
+        });
+
+        // Two concurrent replicas of the first polyhedron fill the budget
+        let a1 = cache.checkout(fingerprint(1), || Ok(1)).ok().unwrap();
+        let a2 = cache.checkout(fingerprint(1), || Ok(1)).ok().unwrap();
+        drop((a1, a2));
+        assert_eq!(cache.len(), 1);
+
+        // A second polyhedron pushes the first one out
+        drop(cache.checkout(fingerprint(2), || Ok(2)).ok().unwrap());
+        assert_eq!(cache.len(), 1);
+
+        let builds = AtomicUsize::new(0);
+        drop(
+            cache
+                .checkout(fingerprint(2), || {
+                    builds.fetch_add(1, Ordering::SeqCst);
+                    Ok(2)
+                })
+                .ok()
+                .unwrap(),
+        );
+        assert_eq!(builds.load(Ordering::SeqCst), 0);
+    }
+
+    #[test]
+    fn test_cache_keeps_pinned_model() {
+        let cache = ModelCache::new(ModelCacheConfig::with_capacity(1));
+        cache.pin(fingerprint(1));
+        drop(cache.checkout(fingerprint(1), || Ok(1)).ok().unwrap());
+
+        // Over budget, but the pinned pool stays
+        drop(cache.checkout(fingerprint(2), || Ok(2)).ok().unwrap());
+        assert!(cache.contains(fingerprint(1)));
+
+        // Once unpinned it is evicted like any other pool
+        cache.unpin(fingerprint(1));
+        drop(cache.checkout(fingerprint(3), || Ok(3)).ok().unwrap());
+        assert!(!cache.contains(fingerprint(1)));
+    }
+
+    #[test]
+    fn test_cache_evicts_by_byte_budget() {
+        let small = sized_fingerprint(1);
+        let large = sized_fingerprint(1000);
+        let cache = ModelCache::new(byte_budget(large.model_bytes() + small.model_bytes()));
+
+        drop(cache.checkout(small, || Ok(())).ok().unwrap());
+        drop(cache.checkout(large, || Ok(())).ok().unwrap());
+        assert_eq!(cache.len(), 2);
+
+        // A third model no longer fits next to the large one
+        drop(
+            cache
+                .checkout(sized_fingerprint(2), || Ok(()))
+                .ok()
+                .unwrap(),
+        );
+        assert!(!cache.contains(large));
+        assert!(cache.contains(small));
+    }
+
+    #[test]
+    fn test_cache_keeps_frequently_used_model() {
+        let (hot, cold, new) = (
+            sized_fingerprint(10),
+            sized_fingerprint(11),
+            sized_fingerprint(12),
+        );
+        let cache = ModelCache::new(byte_budget(
+            hot.model_bytes() + cold.model_bytes() + new.model_bytes() - 1,
+        ));
+
+        for _ in 0..5 {
+            drop(cache.checkout(hot, || Ok(())).ok().unwrap());
+        }
+        // The cold model is the most recently used one, LRU would evict `hot`
+        drop(cache.checkout(cold, || Ok(())).ok().unwrap());
+        drop(cache.checkout(new, || Ok(())).ok().unwrap());
+        assert!(cache.contains(hot));
+        assert!(!cache.contains(cold));
+    }
+
+    #[test]
+    fn test_cache_keeps_expensive_model() {
+        let (slow, fast) = (sized_fingerprint(10), sized_fingerprint(11));
+        let cache = ModelCache::new(byte_budget(slow.model_bytes() + fast.model_bytes()));
+
+        let build_slowly = || {
+            std::thread::sleep(Duration::from_millis(20));
+            Ok(())
+        };
+        drop(cache.checkout(slow, build_slowly).ok().unwrap());
+        drop(cache.checkout(fast, || Ok(())).ok().unwrap());
+        drop(
+            cache
+                .checkout(sized_fingerprint(1), || Ok(()))
+                .ok()
+                .unwrap(),
+        );
+        assert!(cache.contains(slow));
+        assert!(!cache.contains(fast));
+    }
+
+    #[test]
+    fn test_fingerprints_by_priority() {
+        let (hot, cold) = (fingerprint(1), fingerprint(2));
+        let cache = ModelCache::new(ModelCacheConfig::with_capacity(4));
+        drop(cache.checkout(cold, || Ok(())).ok().unwrap());
+        for _ in 0..3 {
+            drop(cache.checkout(hot, || Ok(())).ok().unwrap());
+        }
+        assert_eq!(cache.fingerprints(), vec![hot, cold]);
+    }
+
+    #[test]
+    fn test_concurrent_misses_build_once() {
+        let cache = ModelCache::new(ModelCacheConfig::with_capacity(4));
+        let builds = AtomicUsize::new(0);
+        std::thread::scope(|scope| {
+            for _ in 0..8 {
+                scope.spawn(|| {
+                    let model = cache.checkout(fingerprint(1), || {
+                        builds.fetch_add(1, Ordering::SeqCst);
+                        std::thread::sleep(Duration::from_millis(10));
+                        Ok(())
+                    });
+                    assert!(model.is_ok());
+                });
+            }
+        });
+        assert_eq!(builds.load(Ordering::SeqCst), 1);
+    }
+}
@@ -0,0 +1,131 @@
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+
+/// Run `solve` for every item (with its index) on up to `workers` scoped
+/// threads.
+///
+/// Each worker calls `init` once (e.g. to check out its own model replica)
+/// and then keeps claiming the next unsolved item from a shared counter, so
+/// fast workers pick up the slack of slow ones instead of idling on a fixed
+/// partition. Items are claimed in order, but may finish out of order. With a
+/// single worker everything runs on the calling thread. The first error
+/// stops further items from being claimed and is returned.
+pub fn for_each_claimed<T, S, E, I, F>(
+    items: &[T],
+    workers: usize,
+    init: I,
+    solve: F,
+) -> Result<(), E>
+where
+    T: Sync,
+    E: Send,
+    I: Fn(usize) -> Result<S, E> + Sync,
+    F: Fn(&mut S, usize, &T) -> Result<(), E> + Sync,
+{
+    let workers = workers.clamp(1, items.len().max(1));
+    if workers == 1 {
+        let mut state = init(0)?;
+        return items
+            .iter()
+            .enumerate()
+            .try_for_each(|(idx, item)| solve(&mut state, idx, item));
+    }
+
+    let next = AtomicUsize::new(0);
+    let failed = AtomicBool::new(false);
+
+    let run_worker = |worker: usize| -> Result<(), E> {
+        let mut slot = None;
+        loop {
+            let idx = next.fetch_add(1, Ordering::Relaxed);
+            if idx >= items.len() || failed.load(Ordering::Relaxed) {
+                return Ok(());
+            }
+            // Initialise lazily so workers that never get an item cost nothing
+            if slot.is_none() {
+                slot = Some(init(worker).inspect_err(|_| {
+                    failed.store(true, Ordering::Relaxed);
+                })?);
+            }
+            let state = slot.as_mut().expect("worker state initialised");
+            solve(state, idx, &items[idx]).inspect_err(|_| {
+                failed.store(true, Ordering::Relaxed);
+            })?;
+        }
+    };
+
+    std::thread::scope(|scope| {
+        let handles: Vec<_> = (1..workers)
+            .map(|worker| scope.spawn(move || run_worker(worker)))
+            .collect();
+        let mut result = run_worker(0);
+        for handle in handles {
+            let worker_result = handle.join().expect("objective worker panicked");
+            result = result.and(worker_result);
+        }
+        result
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_every_item_is_solved_once_with_its_index() {
+        let items: Vec<usize> = (0..100).collect();
+        let seen: Vec<AtomicUsize> = items.iter().map(|_| AtomicUsize::new(0)).collect();
+        let result: Result<(), ()> = for_each_claimed(
+            &items,
+            4,
+            |_| Ok(()),
+            |_, idx, &item| {
+                assert_eq!(idx, item);
+                seen[idx].fetch_add(1, Ordering::SeqCst);
+                Ok(())
+            },
+        );
+        assert!(result.is_ok());
+        assert!(seen.iter().all(|count| count.load(Ordering::SeqCst) == 1));
+    }
+
+    #[test]
+    fn test_each_worker_initialises_own_state() {
+        let items: Vec<u64> = (0..8).collect();
+        let inits = AtomicUsize::new(0);
+        let solved = AtomicUsize::new(0);
+        let result: Result<(), ()> = for_each_claimed(
+            &items,
+            3,
+            |_| {
+                inits.fetch_add(1, Ordering::SeqCst);
+                Ok(0u64)
+            },
+            |calls, _, _| {
+                *calls += 1;
+                solved.fetch_add(1, Ordering::SeqCst);
+                Ok(())
+            },
+        );
+        assert!(result.is_ok());
+        assert_eq!(solved.load(Ordering::SeqCst), 8);
+        assert!(inits.load(Ordering::SeqCst) <= 3);
+    }
+
+    #[test]
+    fn test_error_is_returned() {
+        let items: Vec<u64> = (0..10).collect();
+        let result: Result<(), String> = for_each_claimed(
+            &items,
+            2,
+            |_| Ok(()),
+            |_, _, &item| {
+                if item == 5 {
+                    Err("failed".to_string())
+                } else {
+                    Ok(())
+                }
+            },
+        );
+        assert_eq!(result.unwrap_err(), "failed");
+    }
+}
@@ -0,0 +1,620 @@
+//! Racing several solver backends on the same request.
+//!
+//! Every objective is answered by whichever backend solves it first; once
+//! all objectives have an answer the backends still running are cancelled.
+//! Wins are counted per model shape, and shapes one backend keeps winning
+//! are sent to that backend alone, with an occasional race to re-check.
+
+use crate::domain::fingerprint::Fingerprint;
+use crate::domain::solver::{SolutionSink, SolveOptions, Solver};
+use crate::domain::validate::SolveInputError;
+use crate::models::{
+    ApiObjectives, ApiSolution, SolverDirection, SparseLEIntegerPolyhedron, Status,
+};
+use parking_lot::Mutex;
+use std::collections::{HashMap, HashSet};
+use std::panic::{self, AssertUnwindSafe};
+use std::sync::{mpsc, Arc};
+use std::thread;
+
+/// Objectives raced on a shape before its leader may be used alone
+const LEARN_AFTER: u64 = 32;
+
+/// Every this many requests of a learned shape are raced anyway
+const EXPLORE_EVERY: u64 = 16;
+
+/// Threads of each racer when `threads` are shared by `racers` backends;
+/// the solvers' default (0) shares every core
+fn racer_threads(threads: usize, racers: usize) -> usize {
+    let threads = if threads == 0 {
+        std::thread::available_parallelism().map_or(1, |n| n.get())
+    } else {
+        threads
+    };
+    (threads / racers).max(1)
+}
+
+/// Model size bucket: the bit lengths of the column and non-zero counts
+type Shape = (u32, u32);
+
+fn shape_of(polyhedron: &SparseLEIntegerPolyhedron) -> Shape {
+    let bits = |n: usize| usize::BITS - n.leading_zeros();
+    (
+        bits(polyhedron.a.shape.ncols),
+        bits(polyhedron.a.vals.len()),
+    )
+}
+
+/// A final answer ends the race for its objective; anything else (time
+/// limits, failures) only counts once every backend has reported
+fn is_final(solution: &ApiSolution) -> bool {
+    solution.error.is_none()
+        && matches!(
+            solution.status,
+            Status::Optimal | Status::Infeasible | Status::Unbounded
+        )
+}
+
+#[derive(Debug, Default)]
+struct ShapeHistory {
+    /// Requests seen, raced or not
+    requests: u64,
+    /// Objectives decided by a final answer in a race
+    raced: u64,
+    /// Decided objectives per backend
+    wins: Vec<u64>,
+}
+
+impl ShapeHistory {
+    /// Backend to use alone for the next request, `None` to race
+    fn leader(&mut self) -> Option<usize> {
+        self.requests += 1;
+        if self.raced < LEARN_AFTER || self.requests.is_multiple_of(EXPLORE_EVERY) {
+            return None;
+        }
+        let (leader, &wins) = self
+            .wins
+            .iter()
+            .enumerate()
+            .max_by_key(|&(_, wins)| *wins)?;
+        // A clear majority of three in four decided objectives
+        (4 * wins >= 3 * self.raced).then_some(leader)
+    }
+}
+
+#[derive(Default)]
+struct Objective {
+    answered: bool,
+    reports: usize,
+    fallback: Option<ApiSolution>,
+}
+
+/// Message from a racer thread to the thread running the race
+enum Report {
+    Solution(usize, usize, ApiSolution),
+    Done(Result<(), SolveInputError>),
+}
+
+/// Solver that races its backends on every request
+pub struct PortfolioSolver {
+    solvers: Vec<Arc<dyn Solver>>,
+    name: String,
+    history: Mutex<HashMap<Shape, ShapeHistory>>,
+}
+
+impl PortfolioSolver {
+    pub fn new(solvers: Vec<Box<dyn Solver>>) -> Self {
+        assert!(!solvers.is_empty(), "a portfolio needs a solver");
+        let names: Vec<&str> = solvers.iter().map(|solver| solver.name()).collect();
+        let name = format!("Portfolio({})", names.join(", "));
+        PortfolioSolver {
+            solvers: solvers.into_iter().map(Arc::from).collect(),
+            name,
+            history: Mutex::new(HashMap::new()),
+        }
+    }
+
+    /// Solve on every backend at once, each objective answered by the first
+    /// final solution any backend finds.
+    ///
+    /// Backends that fail drop out of the race; the first error is returned
+    /// only when every backend failed before answering all objectives.
+    /// Every racer runs with `options.threads`, see `solve_each`.
+    ///
+    /// Racers run on detached threads, so the race returns once every
+    /// objective is answered. Backends that only notice cancellation between
+    /// objectives (GLPK without a model cache) finish their current step in
+    /// the background.
+    fn race(
+        &self,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
+        direction: SolverDirection,
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<Vec<usize>, SolveInputError> {
+        let racers = self.solvers.len();
+        let count = objectives.count();
+        // Cancelled when every objective is answered, or with the request
+        let race = options.cancel.child();
+        let options = SolveOptions {
+            cancel: race.clone(),
+            ..options
+        };
+
+        let (reports, received) = mpsc::channel();
+        let mut results: Vec<Result<(), SolveInputError>> = Vec::with_capacity(racers);
+        let mut running = 0;
+        for (racer, solver) in self.solvers.iter().enumerate() {
+            let solver = solver.clone();
+            let polyhedron = polyhedron.clone();
+            let objectives = objectives.clone();
+            let options = options.clone();
+            let reports = reports.clone();
+            let spawned = thread::Builder::new()
+                .name("portfolio-racer".to_string())
+                .spawn(move || {
+                    let result = panic::catch_unwind(AssertUnwindSafe(|| {
+                        solver.solve_each(
+                            polyhedron,
+                            fingerprint,
+                            objectives,
+                            direction,
+                            options,
+                            &|idx, solution| {
+                                let _ = reports.send(Report::Solution(racer, idx, solution));
+                            },
+                        )
+                    }))
+                    .unwrap_or_else(|_| {
+                        Err(SolveInputError {
+                            details: "Portfolio solver thread panicked".to_string(),
+                        })
+                    });
+                    let _ = reports.send(Report::Done(result));
+                });
+            match spawned {
+                Ok(_) => running += 1,
+                Err(e) => results.push(Err(SolveInputError {
+                    details: format!("Failed to start portfolio solver thread: {}", e),
+                })),
+            }
+        }
+        drop(reports);
+
+        let mut objectives: Vec<Objective> = (0..count).map(|_| Objective::default()).collect();
+        let mut unanswered = count;
+        let mut wins = vec![0; racers];
+        while unanswered > 0 && running > 0 {
+            let Ok(report) = received.recv() else {
+                break;
+            };
+            let (racer, idx, solution) = match report {
+                Report::Solution(racer, idx, solution) => (racer, idx, solution),
+                Report::Done(result) => {
+                    running -= 1;
+                    results.push(result);
+                    continue;
+                }
+            };
+            let objective = &mut objectives[idx];
+            if objective.answered {
+                continue;
+            }
+            objective.reports += 1;
+            let answer = if is_final(&solution) {
+                wins[racer] += 1;
+                Some(solution)
+            } else if objective.reports == racers {
+                Some(objective.fallback.take().unwrap_or(solution))
+            } else {
+                objective.fallback.get_or_insert(solution);
+                None
+            };
+            if let Some(solution) = answer {
+                objective.answered = true;
+                unanswered -= 1;
+                on_solution(idx, solution);
+            }
+        }
+        race.cancel();
+
+        // Objectives some backend gave up on while another failed outright
+        if unanswered > 0 {
+            let fallbacks: Vec<(usize, ApiSolution)> = objectives
+                .into_iter()
+                .enumerate()
+                .filter(|(_, objective)| !objective.answered)
+                .filter_map(|(idx, objective)| Some((idx, objective.fallback?)))
+                .collect();
+            if fallbacks.len() < unanswered {
+                let error = results.into_iter().find_map(Result::err);
+                return Err(error.unwrap_or_else(|| SolveInputError {
+                    details: "Portfolio solvers left objectives unanswered".to_string(),
+                }));
+            }
+            for (idx, solution) in fallbacks {
+                on_solution(idx, solution);
+            }
+        }
+        Ok(wins)
+    }
+}
+
+impl Solver for PortfolioSolver {
+    fn solve_each(
+        &self,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
+        direction: SolverDirection,
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<(), SolveInputError> {
+        if self.solvers.len() == 1 {
+            return self.solvers[0].solve_each(
+                polyhedron,
+                fingerprint,
+                objectives,
+                direction,
+                options,
+                on_solution,
+            );
+        }
+
+        // Racers share the request's threads, since it holds one slot. A
+        // learned leader gets the same share, so it runs the configuration
+        // its wins were measured with.
+        let options = SolveOptions {
+            threads: racer_threads(options.threads, self.solvers.len()),
+            ..options
+        };
+        let shape = shape_of(&polyhedron);
+        let leader = self.history.lock().entry(shape).or_default().leader();
+        if let Some(leader) = leader {
+            return self.solvers[leader].solve_each(
+                polyhedron,
+                fingerprint,
+                objectives,
+                direction,
+                options,
+                on_solution,
+            );
+        }
+
+        let wins = self.race(
+            polyhedron,
+            fingerprint,
+            objectives,
+            direction,
+            options,
+            on_solution,
+        )?;
+        let mut history = self.history.lock();
+        let history = history.entry(shape).or_default();
+        history.wins.resize(wins.len(), 0);
+        for (total, won) in history.wins.iter_mut().zip(wins) {
+            *total += won as u64;
+            history.raced += won as u64;
+        }
+        Ok(())
+    }
+
+    fn warm(
+        &self,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
+        use_presolve: bool,
+    ) -> Result<(), SolveInputError> {
+        for solver in &self.solvers {
+            solver.warm(polyhedron, fingerprint, use_presolve)?;
+        }
+        Ok(())
+    }
+
+    fn cached_models(&self) -> Vec<Fingerprint> {
+        let mut seen = HashSet::new();
+        self.solvers
+            .iter()
+            .flat_map(|solver| solver.cached_models())
+            .filter(|fingerprint| seen.insert(*fingerprint))
+            .collect()
+    }
+
+    fn pin(&self, fingerprint: Fingerprint) {
+        for solver in &self.solvers {
+            solver.pin(fingerprint);
+        }
+    }
+
+    fn unpin(&self, fingerprint: Fingerprint) {
+        for solver in &self.solvers {
+            solver.unpin(fingerprint);
+        }
+    }
+
+    fn name(&self) -> &str {
+        &self.name
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::{ApiIntegerSparseMatrix, ApiShape, ApiValues, ApiVariable};
+    use std::sync::atomic::{AtomicBool, Ordering};
+    use std::time::{Duration, Instant};
+
+    /// Answers every objective with `status` after `delay`, unless cancelled
+    /// and `interruptible`
+    struct DelayedSolver {
+        name: &'static str,
+        delay: Duration,
+        status: Option<Status>,
+        interruptible: bool,
+        cancelled: Arc<AtomicBool>,
+    }
+
+    impl DelayedSolver {
+        fn boxed(name: &'static str, delay_ms: u64, status: Option<Status>) -> Box<dyn Solver> {
+            Box::new(DelayedSolver {
+                name,
+                delay: Duration::from_millis(delay_ms),
+                status,
+                interruptible: true,
+                cancelled: Arc::default(),
+            })
+        }
+    }
+
+    impl Solver for DelayedSolver {
+        fn solve_each(
+            &self,
+            _polyhedron: Arc<SparseLEIntegerPolyhedron>,
+            _fingerprint: Fingerprint,
+            objectives: ApiObjectives,
+            _direction: SolverDirection,
+            options: SolveOptions,
+            on_solution: &SolutionSink,
+        ) -> Result<(), SolveInputError> {
+            let Some(status) = self.status else {
+                return Err(SolveInputError {
+                    details: format!("{} failed", self.name),
+                });
+            };
+            for idx in 0..objectives.count() {
+                let started = Instant::now();
+                while started.elapsed() < self.delay {
+                    if self.interruptible && options.cancel.is_cancelled() {
+                        self.cancelled.store(true, Ordering::SeqCst);
+                        return options.cancel.check();
+                    }
+                    std::thread::sleep(Duration::from_millis(1));
+                }
+                on_solution(
+                    idx,
+                    ApiSolution {
+                        status,
+                        objective: 0,
+                        solution: ApiValues::Dense(vec![1]),
+                        error: None,
+                    },
+                );
+            }
+            Ok(())
+        }
+
+        fn name(&self) -> &str {
+            self.name
+        }
+    }
+
+    /// Records the threads it was given and answers every objective at once
+    #[derive(Default)]
+    struct ThreadRecordingSolver {
+        threads: Arc<Mutex<Vec<usize>>>,
+    }
+
+    impl Solver for ThreadRecordingSolver {
+        fn solve_each(
+            &self,
+            _polyhedron: Arc<SparseLEIntegerPolyhedron>,
+            _fingerprint: Fingerprint,
+            objectives: ApiObjectives,
+            _direction: SolverDirection,
+            options: SolveOptions,
+            on_solution: &SolutionSink,
+        ) -> Result<(), SolveInputError> {
+            self.threads.lock().push(options.threads);
+            for idx in 0..objectives.count() {
+                on_solution(
+                    idx,
+                    ApiSolution {
+                        status: Status::Optimal,
+                        objective: 0,
+                        solution: ApiValues::Dense(vec![1]),
+                        error: None,
+                    },
+                );
+            }
+            Ok(())
+        }
+
+        fn name(&self) -> &str {
+            "recording"
+        }
+    }
+
+    fn create_test_polyhedron() -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0],
+                cols: vec![0],
+                vals: vec![1],
+                shape: ApiShape { nrows: 1, ncols: 1 },
+            },
+            b: vec![1],
+            variables: vec![ApiVariable {
+                id: "x".to_string(),
+                bound: (0, 1),
+            }],
+        }
+    }
+
+    fn solve(solver: &PortfolioSolver) -> Result<Vec<ApiSolution>, SolveInputError> {
+        let polyhedron = Arc::new(create_test_polyhedron());
+        let fingerprint = Fingerprint::of(&polyhedron);
+        solver.solve(
+            polyhedron,
+            fingerprint,
+            ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(0, 2.0)]]),
+            SolverDirection::Maximize,
+            SolveOptions::default(),
+        )
+    }
+
+    #[test]
+    fn test_first_final_answer_wins_and_cancels_the_rest() {
+        let cancelled = Arc::new(AtomicBool::new(false));
+        let slow = Box::new(DelayedSolver {
+            name: "slow",
+            delay: Duration::from_secs(10),
+            status: Some(Status::Optimal),
+            interruptible: true,
+            cancelled: cancelled.clone(),
+        });
+        let fast = DelayedSolver::boxed("fast", 0, Some(Status::Optimal));
+        let solver = PortfolioSolver::new(vec![slow, fast]);
+        assert_eq!(solver.name(), "Portfolio(slow, fast)");
+
+        let polyhedron = Arc::new(create_test_polyhedron());
+        let fingerprint = Fingerprint::of(&polyhedron);
+        let wins = solver
+            .race(
+                polyhedron,
+                fingerprint,
+                ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(0, 2.0)]]),
+                SolverDirection::Maximize,
+                SolveOptions::default(),
+                &|_, solution| assert!(matches!(solution.status, Status::Optimal)),
+            )
+            .ok()
+            .unwrap();
+        assert_eq!(wins, vec![0, 2]);
+        // The slow racer notices the cancellation on its own thread
+        let started = Instant::now();
+        while !cancelled.load(Ordering::SeqCst) && started.elapsed() < Duration::from_secs(5) {
+            std::thread::sleep(Duration::from_millis(1));
+        }
+        assert!(cancelled.load(Ordering::SeqCst));
+    }
+
+    #[test]
+    fn test_race_does_not_wait_for_uninterruptible_racers() {
+        let stubborn = Box::new(DelayedSolver {
+            name: "stubborn",
+            delay: Duration::from_secs(5),
+            status: Some(Status::Optimal),
+            interruptible: false,
+            cancelled: Arc::default(),
+        });
+        let fast = DelayedSolver::boxed("fast", 0, Some(Status::Optimal));
+        let solver = PortfolioSolver::new(vec![stubborn, fast]);
+
+        let started = Instant::now();
+        let solutions = solve(&solver).ok().unwrap();
+        assert!(started.elapsed() < Duration::from_secs(2));
+        assert_eq!(solutions.len(), 2);
+        assert!(solutions
+            .iter()
+            .all(|solution| matches!(solution.status, Status::Optimal)));
+    }
+
+    #[test]
+    fn test_failed_backends_drop_out() {
+        let solver = PortfolioSolver::new(vec![
+            DelayedSolver::boxed("failing", 0, None),
+            DelayedSolver::boxed("timed out", 0, Some(Status::TimeLimit)),
+        ]);
+        let solutions = solve(&solver).ok().unwrap();
+        assert!(solutions
+            .iter()
+            .all(|solution| matches!(solution.status, Status::TimeLimit)));
+
+        let solver = PortfolioSolver::new(vec![
+            DelayedSolver::boxed("first", 0, None),
+            DelayedSolver::boxed("second", 0, None),
+        ]);
+        let error = solve(&solver).err().unwrap();
+        assert_eq!(error.details, "first failed");
+    }
+
+    #[test]
+    fn test_leader_runs_with_the_racers_threads() {
+        let leader = ThreadRecordingSolver::default();
+        let other = ThreadRecordingSolver::default();
+        let (leader_threads, other_threads) = (leader.threads.clone(), other.threads.clone());
+        let solver = PortfolioSolver::new(vec![Box::new(leader), Box::new(other)]);
+        let options = SolveOptions {
+            threads: 8,
+            ..SolveOptions::default()
+        };
+        let solve = || {
+            let polyhedron = Arc::new(create_test_polyhedron());
+            let fingerprint = Fingerprint::of(&polyhedron);
+            solver
+                .solve(
+                    polyhedron,
+                    fingerprint,
+                    ApiObjectives::Indexed(vec![vec![(0, 1.0)]]),
+                    SolverDirection::Maximize,
+                    options.clone(),
+                )
+                .ok()
+                .unwrap()
+        };
+
+        // Racing
+        solve();
+        assert_eq!(*leader_threads.lock(), vec![4]);
+        assert_eq!(*other_threads.lock(), vec![4]);
+
+        // Exploiting a learned leader
+        solver.history.lock().insert(
+            shape_of(&create_test_polyhedron()),
+            ShapeHistory {
+                requests: 1,
+                raced: LEARN_AFTER,
+                wins: vec![LEARN_AFTER, 0],
+            },
+        );
+        solve();
+        assert_eq!(*leader_threads.lock(), vec![4, 4]);
+        assert_eq!(other_threads.lock().len(), 1);
+    }
+
+    #[test]
+    fn test_racers_share_the_request_threads() {
+        assert_eq!(racer_threads(8, 2), 4);
+        assert_eq!(racer_threads(5, 2), 2);
+        assert_eq!(racer_threads(1, 3), 1);
+        assert!(racer_threads(0, 2) >= 1);
+    }
+
+    #[test]
+    fn test_shapes_with_a_clear_winner_skip_the_race() {
+        let mut history = ShapeHistory {
+            requests: 0,
+            raced: LEARN_AFTER,
+            wins: vec![LEARN_AFTER / 8, LEARN_AFTER - LEARN_AFTER / 8],
+        };
+        let leaders: Vec<Option<usize>> = (0..EXPLORE_EVERY).map(|_| history.leader()).collect();
+        assert_eq!(leaders.iter().filter(|leader| leader.is_none()).count(), 1);
+        assert!(leaders.contains(&Some(1)));
+
+        // No backend with three in four wins keeps racing
+        history.wins = vec![LEARN_AFTER / 2, LEARN_AFTER / 2];
+        assert_eq!(history.leader(), None);
+    }
+}
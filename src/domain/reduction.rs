@@ -0,0 +1,890 @@
+//! Backend-independent reduction of a polyhedron before it is solved.
+//!
+//! Fixed columns (`bound.0 == bound.1`) are substituted into `b`. Rows that
+//! hold for every point within the variable bounds, including empty rows,
+//! are dropped, and of identical rows only the tightest is kept. Columns
+//! left without any row are dropped too; their value is chosen per
+//! objective from their bounds. Solutions of the reduced polyhedron are
+//! mapped back to the original variables.
+
+use crate::domain::fingerprint::Fingerprint;
+use crate::domain::solver::{SolutionSink, SolveOptions, Solver};
+use crate::domain::sparse;
+use crate::domain::validate::{validate_objectives_indexed, SolveInputError};
+use crate::metrics;
+use crate::models::{
+    ApiIntegerSparseMatrix, ApiObjectives, ApiShape, ApiSolution, ApiValues, ApiVariable,
+    ObjectiveOwned, SolverDirection, SparseLEIntegerPolyhedron, Status,
+};
+use lru::LruCache;
+use parking_lot::Mutex;
+use std::collections::{HashMap, HashSet};
+use std::num::NonZeroUsize;
+use std::sync::Arc;
+
+/// Where the value of an original column comes from
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum Column {
+    /// Column of the reduced polyhedron
+    Kept(usize),
+    /// Substituted by its only feasible value
+    Fixed(i32),
+    /// In no remaining row, so any value within its bounds is feasible
+    Free(i32, i32),
+}
+
+impl Column {
+    /// Value of a removed column for an objective coefficient
+    fn value(self, coeff: f64, direction: SolverDirection) -> i32 {
+        let improving = match direction {
+            SolverDirection::Maximize => coeff,
+            SolverDirection::Minimize => -coeff,
+        };
+        match self {
+            Column::Kept(_) => unreachable!("kept columns are solved"),
+            Column::Fixed(value) => value,
+            Column::Free(_, upper) if improving > 0.0 => upper,
+            Column::Free(lower, _) if improving < 0.0 => lower,
+            Column::Free(lower, upper) => 0.clamp(lower, upper),
+        }
+    }
+}
+
+/// Maps values of a reduced polyhedron back to its original columns
+#[derive(Debug)]
+pub struct ColumnMap {
+    columns: Vec<Column>,
+}
+
+/// Reduce `polyhedron`, or `None` when nothing can be removed.
+///
+/// Polyhedra with empty bounds, rows that no point within the bounds
+/// satisfies, or coefficients and right-hand sides that leave the `i32`
+/// range are left to the solver as they are, so it reports its usual status.
+pub fn reduce(
+    polyhedron: &SparseLEIntegerPolyhedron,
+) -> Option<(SparseLEIntegerPolyhedron, ColumnMap)> {
+    let variables = &polyhedron.variables;
+    if variables.is_empty() || variables.iter().any(|v| v.bound.0 > v.bound.1) {
+        return None;
+    }
+    let fixed = |col: usize| {
+        let (lower, upper) = variables[col].bound;
+        (lower == upper).then_some(lower)
+    };
+
+    // Rows with fixed columns substituted, merged by column, zeros dropped.
+    // Products of two `i32` stay below 2^62, so sums over any row fit `i128`
+    let mut rows: Vec<(Vec<(usize, i128)>, i128)> = Vec::new();
+    let mut rows_removed = 0;
+    let feasible = sparse::with_csr(&polyhedron.a, |csr| {
+        rows.reserve(csr.major_len());
+        for row in 0..csr.major_len() {
+            let (cols, coeffs) = csr.slice(row);
+            let mut rhs = polyhedron.b[row] as i128;
+            let mut entries: Vec<(usize, i128)> = Vec::with_capacity(cols.len());
+            for (&col, &coeff) in cols.iter().zip(coeffs) {
+                let (col, coeff) = (col as usize, coeff as i128);
+                match fixed(col) {
+                    Some(value) => rhs -= coeff * value as i128,
+                    None => entries.push((col, coeff)),
+                }
+            }
+            entries.sort_unstable_by_key(|&(col, _)| col);
+            entries.dedup_by(|next, merged| {
+                let same = next.0 == merged.0;
+                if same {
+                    merged.1 += next.1;
+                }
+                same
+            });
+            entries.retain(|&(_, coeff)| coeff != 0);
+
+            // Smallest and largest row activity within the variable bounds
+            let (mut min, mut max) = (0i128, 0i128);
+            for &(col, coeff) in &entries {
+                let (lower, upper) = variables[col].bound;
+                let (at_lower, at_upper) = (coeff * lower as i128, coeff * upper as i128);
+                min += at_lower.min(at_upper);
+                max += at_lower.max(at_upper);
+            }
+            if max <= rhs {
+                rows_removed += 1;
+            } else if min > rhs {
+                return false;
+            } else {
+                rows.push((entries, rhs));
+            }
+        }
+        true
+    });
+    let fits = |value: i128| i32::try_from(value).is_ok();
+    let representable = rows
+        .iter()
+        .all(|(entries, rhs)| fits(*rhs) && entries.iter().all(|&(_, coeff)| fits(coeff)));
+    if !feasible || !representable {
+        return None;
+    }
+
+    // Keep the first of identical rows, with the smallest right-hand side
+    let mut kept: Vec<usize> = Vec::with_capacity(rows.len());
+    let mut rhs: Vec<i128> = Vec::with_capacity(rows.len());
+    {
+        let mut seen: HashMap<&[(usize, i128)], usize> = HashMap::with_capacity(rows.len());
+        for (row, (entries, row_rhs)) in rows.iter().enumerate() {
+            match seen.get(entries.as_slice()) {
+                Some(&position) => {
+                    rhs[position] = rhs[position].min(*row_rhs);
+                    rows_removed += 1;
+                }
+                None => {
+                    seen.insert(entries, kept.len());
+                    kept.push(row);
+                    rhs.push(*row_rhs);
+                }
+            }
+        }
+    }
+
+    let mut used = vec![false; variables.len()];
+    for &row in &kept {
+        for &(col, _) in &rows[row].0 {
+            used[col] = true;
+        }
+    }
+    let mut kept_columns = 0;
+    let columns: Vec<Column> = variables
+        .iter()
+        .enumerate()
+        .map(|(col, variable)| match fixed(col) {
+            Some(value) => Column::Fixed(value),
+            None if used[col] => {
+                kept_columns += 1;
+                Column::Kept(kept_columns - 1)
+            }
+            None => Column::Free(variable.bound.0, variable.bound.1),
+        })
+        .collect();
+    let columns_removed = variables.len() - kept_columns;
+    if rows_removed == 0 && columns_removed == 0 {
+        return None;
+    }
+    metrics::global().polyhedron_reduced(rows_removed as u64, columns_removed as u64);
+
+    let mut a = ApiIntegerSparseMatrix {
+        rows: Vec::new(),
+        cols: Vec::new(),
+        vals: Vec::new(),
+        shape: ApiShape {
+            nrows: kept.len(),
+            ncols: kept_columns,
+        },
+    };
+    for (new_row, &row) in kept.iter().enumerate() {
+        for &(col, coeff) in &rows[row].0 {
+            let Column::Kept(new_col) = columns[col] else {
+                unreachable!("columns of kept rows are kept");
+            };
+            a.rows.push(new_row as i32);
+            a.cols.push(new_col as i32);
+            a.vals.push(coeff as i32);
+        }
+    }
+    let reduced = SparseLEIntegerPolyhedron {
+        a,
+        b: rhs.into_iter().map(|rhs| rhs as i32).collect(),
+        variables: variables
+            .iter()
+            .zip(&columns)
+            .filter(|(_, column)| matches!(column, Column::Kept(_)))
+            .map(|(variable, _)| variable.clone())
+            .collect(),
+    };
+    Some((reduced, ColumnMap { columns }))
+}
+
+impl ColumnMap {
+    /// Objectives over the kept columns only.
+    ///
+    /// Indexed columns are checked against the original variables. Named
+    /// objectives are checked by the wrapped solver, or here when no column
+    /// is kept.
+    fn objectives(
+        &self,
+        objectives: &ApiObjectives,
+        variables: &[ApiVariable],
+    ) -> Result<ApiObjectives, SolveInputError> {
+        match objectives {
+            ApiObjectives::Named(objectives) => {
+                let removed: HashSet<&str> = variables
+                    .iter()
+                    .zip(&self.columns)
+                    .filter(|(_, column)| !matches!(column, Column::Kept(_)))
+                    .map(|(variable, _)| variable.id.as_str())
+                    .collect();
+                let solved = self.columns.len() > removed.len();
+                objectives
+                    .iter()
+                    .map(|objective| {
+                        let mut kept = ObjectiveOwned::with_capacity(objective.len());
+                        for (id, &coeff) in objective {
+                            if removed.contains(id.as_str()) {
+                                continue;
+                            }
+                            if !solved {
+                                return Err(SolveInputError {
+                                    details: format!("Objective contains missing variable {}", id),
+                                });
+                            }
+                            kept.insert(id.clone(), coeff);
+                        }
+                        Ok(kept)
+                    })
+                    .collect::<Result<Vec<_>, _>>()
+                    .map(ApiObjectives::Named)
+            }
+            ApiObjectives::Indexed(objectives) => {
+                validate_objectives_indexed(variables.len(), objectives)?;
+                Ok(ApiObjectives::Indexed(
+                    objectives
+                        .iter()
+                        .map(|objective| {
+                            objective
+                                .iter()
+                                .filter_map(|&(col, coeff)| match self.columns[col] {
+                                    Column::Kept(kept) => Some((kept, coeff)),
+                                    _ => None,
+                                })
+                                .collect()
+                        })
+                        .collect(),
+                ))
+            }
+        }
+    }
+
+    /// Solution of objective `idx` over the original variables, with the
+    /// objective value recomputed from all of them.
+    ///
+    /// Removed columns only get their value in solutions that have values.
+    fn restore(
+        &self,
+        solution: ApiSolution,
+        objectives: &ApiObjectives,
+        idx: usize,
+        direction: SolverDirection,
+        variables: &[ApiVariable],
+    ) -> ApiSolution {
+        let has_values = matches!(
+            solution.status,
+            Status::Optimal | Status::Feasible | Status::TimeLimit
+        );
+        let (values, objective_value) = match (solution.solution, objectives) {
+            (ApiValues::Named(mut values), ApiObjectives::Named(objectives)) => {
+                let objective = &objectives[idx];
+                for (variable, &column) in variables.iter().zip(&self.columns) {
+                    if let Column::Kept(_) = column {
+                        continue;
+                    }
+                    let value = if has_values {
+                        let coeff = objective.get(&variable.id).copied().unwrap_or(0.0);
+                        column.value(coeff, direction)
+                    } else {
+                        0
+                    };
+                    values.insert(variable.id.clone(), value);
+                }
+                let objective_value: f64 = objective
+                    .iter()
+                    .map(|(id, &coeff)| coeff * values.get(id).copied().unwrap_or(0) as f64)
+                    .sum();
+                (ApiValues::Named(values), objective_value)
+            }
+            (ApiValues::Dense(reduced), ApiObjectives::Indexed(objectives)) => {
+                let objective = &objectives[idx];
+                let mut costs = vec![0.0; variables.len()];
+                for &(col, coeff) in objective {
+                    costs[col] += coeff;
+                }
+                let values: Vec<i32> = self
+                    .columns
+                    .iter()
+                    .zip(&costs)
+                    .map(|(&column, &coeff)| match column {
+                        Column::Kept(kept) => reduced.get(kept).copied().unwrap_or(0),
+                        _ if has_values => column.value(coeff, direction),
+                        _ => 0,
+                    })
+                    .collect();
+                let objective_value: f64 = objective
+                    .iter()
+                    .map(|&(col, coeff)| coeff * values[col] as f64)
+                    .sum();
+                (ApiValues::Dense(values), objective_value)
+            }
+            // Solvers answer indexed objectives densely and named ones by id
+            (values, _) => {
+                return ApiSolution {
+                    solution: values,
+                    ..solution
+                }
+            }
+        };
+        ApiSolution {
+            objective: objective_value.round() as i32,
+            solution: values,
+            ..solution
+        }
+    }
+}
+
+/// Reduced model structures remembered with the structure they came from
+const ORIGINS: usize = 4096;
+
+/// Reduced polyhedra remembered by the fingerprint of their original
+const REDUCTIONS: usize = 64;
+
+/// A reduced polyhedron with what is needed to solve it and map back
+struct Reduction {
+    polyhedron: Arc<SparseLEIntegerPolyhedron>,
+    columns: ColumnMap,
+    fingerprint: Fingerprint,
+}
+
+struct Pin {
+    count: usize,
+    /// Fingerprint of the reduced polyhedron, known once it is warmed
+    reduced: Option<Fingerprint>,
+}
+
+/// Solver decorator that solves the reduced form of every polyhedron.
+///
+/// The wrapped solver only sees reduced polyhedra and their fingerprints,
+/// so its model cache holds smaller models. Polyhedra without anything to
+/// remove are passed through unchanged. When no column is left, every
+/// objective is answered without the wrapped solver.
+pub struct ReducingSolver {
+    inner: Box<dyn Solver>,
+    /// Pins by original fingerprint, forwarded for the reduced polyhedron
+    pins: Mutex<HashMap<Fingerprint, Pin>>,
+    /// Original structure of recently reduced structures, so `cached_models`
+    /// reports keys that match the requests, e.g. in warm-up snapshots
+    origins: Mutex<LruCache<Fingerprint, Fingerprint>>,
+    /// Recent reductions, `None` for polyhedra passed through unchanged
+    reductions: Mutex<LruCache<Fingerprint, Option<Arc<Reduction>>>>,
+}
+
+impl ReducingSolver {
+    pub fn new(inner: Box<dyn Solver>) -> Self {
+        ReducingSolver {
+            inner,
+            pins: Mutex::new(HashMap::new()),
+            origins: Mutex::new(LruCache::new(
+                NonZeroUsize::new(ORIGINS).expect("non-zero capacity"),
+            )),
+            reductions: Mutex::new(LruCache::new(
+                NonZeroUsize::new(REDUCTIONS).expect("non-zero capacity"),
+            )),
+        }
+    }
+
+    /// Reduced form of `polyhedron`, or `None` when nothing can be removed.
+    ///
+    /// Remembered by fingerprint, so a polyhedron solved again (e.g. a
+    /// registered model) is neither reduced nor fingerprinted again.
+    fn reduction(
+        &self,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
+    ) -> Option<Arc<Reduction>> {
+        if let Some(reduction) = self.reductions.lock().get(&fingerprint) {
+            return reduction.clone();
+        }
+        let reduction = reduce(polyhedron).map(|(reduced, columns)| {
+            let reduced_fingerprint = self.fingerprint(&reduced, fingerprint);
+            Arc::new(Reduction {
+                polyhedron: Arc::new(reduced),
+                columns,
+                fingerprint: reduced_fingerprint,
+            })
+        });
+        self.reductions.lock().put(fingerprint, reduction.clone());
+        reduction
+    }
+
+    /// Fingerprint of `reduced`, remembering where its structure came from
+    fn fingerprint(
+        &self,
+        reduced: &SparseLEIntegerPolyhedron,
+        original: Fingerprint,
+    ) -> Fingerprint {
+        let fingerprint = Fingerprint::of(reduced);
+        self.origins
+            .lock()
+            .put(fingerprint.structure(), original.structure());
+        fingerprint
+    }
+}
+
+impl Solver for ReducingSolver {
+    fn solve_each(
+        &self,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
+        direction: SolverDirection,
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<(), SolveInputError> {
+        let Some(reduction) = self.reduction(&polyhedron, fingerprint) else {
+            return self.inner.solve_each(
+                polyhedron,
+                fingerprint,
+                objectives,
+                direction,
+                options,
+                on_solution,
+            );
+        };
+        let Reduction {
+            polyhedron: reduced,
+            columns,
+            fingerprint: reduced_fingerprint,
+        } = &*reduction;
+        let variables = &polyhedron.variables;
+        let reduced_objectives = columns.objectives(&objectives, variables)?;
+        let emit = |idx: usize, solution: ApiSolution| {
+            on_solution(
+                idx,
+                columns.restore(solution, &objectives, idx, direction, variables),
+            );
+        };
+
+        if reduced.variables.is_empty() {
+            for idx in 0..objectives.count() {
+                let values = if objectives.is_indexed() {
+                    ApiValues::Dense(Vec::new())
+                } else {
+                    ApiValues::Named(HashMap::new())
+                };
+                let solution = ApiSolution {
+                    status: Status::Optimal,
+                    objective: 0,
+                    solution: values,
+                    error: None,
+                };
+                emit(idx, solution);
+            }
+            return Ok(());
+        }
+
+        self.inner.solve_each(
+            reduced.clone(),
+            *reduced_fingerprint,
+            reduced_objectives,
+            direction,
+            options,
+            &emit,
+        )
+    }
+
+    fn warm(
+        &self,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
+        use_presolve: bool,
+    ) -> Result<(), SolveInputError> {
+        let reduced_fingerprint = match self.reduction(polyhedron, fingerprint) {
+            Some(reduction) if reduction.polyhedron.variables.is_empty() => None,
+            Some(reduction) => {
+                self.inner
+                    .warm(&reduction.polyhedron, reduction.fingerprint, use_presolve)?;
+                Some(reduction.fingerprint)
+            }
+            None => {
+                self.inner.warm(polyhedron, fingerprint, use_presolve)?;
+                Some(fingerprint)
+            }
+        };
+
+        // Pins taken before the first warm-up now know what to keep
+        if let Some(reduced_fingerprint) = reduced_fingerprint {
+            if let Some(pin) = self.pins.lock().get_mut(&fingerprint) {
+                if pin.reduced.is_none() {
+                    pin.reduced = Some(reduced_fingerprint);
+                    for _ in 0..pin.count {
+                        self.inner.pin(reduced_fingerprint);
+                    }
+                }
+            }
+        }
+        Ok(())
+    }
+
+    fn cached_models(&self) -> Vec<Fingerprint> {
+        let origins = self.origins.lock();
+        self.inner
+            .cached_models()
+            .into_iter()
+            .map(|fingerprint| origins.peek(&fingerprint).copied().unwrap_or(fingerprint))
+            .collect()
+    }
+
+    fn pin(&self, fingerprint: Fingerprint) {
+        let mut pins = self.pins.lock();
+        let pin = pins.entry(fingerprint).or_insert(Pin {
+            count: 0,
+            reduced: None,
+        });
+        pin.count += 1;
+        if let Some(reduced) = pin.reduced {
+            self.inner.pin(reduced);
+        }
+    }
+
+    fn unpin(&self, fingerprint: Fingerprint) {
+        let mut pins = self.pins.lock();
+        let Some(pin) = pins.get_mut(&fingerprint) else {
+            return;
+        };
+        pin.count -= 1;
+        if let Some(reduced) = pin.reduced {
+            self.inner.unpin(reduced);
+        }
+        if pin.count == 0 {
+            pins.remove(&fingerprint);
+        }
+    }
+
+    fn name(&self) -> &str {
+        self.inner.name()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicI64, Ordering};
+
+    /// Sets every variable to its upper bound, recording the objectives it
+    /// was given and its outstanding pins
+    #[derive(Default)]
+    struct UpperBoundSolver {
+        seen: Arc<Mutex<Vec<ApiObjectives>>>,
+        pins: Arc<AtomicI64>,
+    }
+
+    impl Solver for UpperBoundSolver {
+        fn solve_each(
+            &self,
+            polyhedron: Arc<SparseLEIntegerPolyhedron>,
+            _fingerprint: Fingerprint,
+            objectives: ApiObjectives,
+            _direction: SolverDirection,
+            _options: SolveOptions,
+            on_solution: &SolutionSink,
+        ) -> Result<(), SolveInputError> {
+            for idx in 0..objectives.count() {
+                let values: Vec<i32> = polyhedron.variables.iter().map(|v| v.bound.1).collect();
+                let solution = if objectives.is_indexed() {
+                    ApiValues::Dense(values)
+                } else {
+                    ApiValues::Named(
+                        polyhedron
+                            .variables
+                            .iter()
+                            .zip(values)
+                            .map(|(v, value)| (v.id.clone(), value))
+                            .collect(),
+                    )
+                };
+                on_solution(
+                    idx,
+                    ApiSolution {
+                        status: Status::Optimal,
+                        objective: 0,
+                        solution,
+                        error: None,
+                    },
+                );
+            }
+            self.seen.lock().push(objectives);
+            Ok(())
+        }
+
+        fn pin(&self, _fingerprint: Fingerprint) {
+            self.pins.fetch_add(1, Ordering::SeqCst);
+        }
+
+        fn unpin(&self, _fingerprint: Fingerprint) {
+            self.pins.fetch_sub(1, Ordering::SeqCst);
+        }
+
+        fn name(&self) -> &str {
+            "UpperBound"
+        }
+    }
+
+    fn variable(id: &str, bound: (i32, i32)) -> ApiVariable {
+        ApiVariable {
+            id: id.to_string(),
+            bound,
+        }
+    }
+
+    // x + y <= 1        kept
+    // x + y <= 0        duplicate, tighter
+    // y + z <= 5        redundant, at most 2 with z fixed at 1
+    //                   empty row with b = 0
+    // y + u <= 1        kept
+    // with z fixed at 1 and w in no row
+    fn create_test_polyhedron() -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0, 0, 1, 1, 2, 2, 4, 4],
+                cols: vec![0, 1, 0, 1, 1, 2, 1, 4],
+                vals: vec![1, 1, 1, 1, 1, 1, 1, 1],
+                shape: ApiShape { nrows: 5, ncols: 5 },
+            },
+            b: vec![1, 0, 5, 0, 1],
+            variables: vec![
+                variable("x", (0, 1)),
+                variable("y", (0, 1)),
+                variable("z", (1, 1)),
+                variable("w", (-3, 4)),
+                variable("u", (0, 1)),
+            ],
+        }
+    }
+
+    fn solve(
+        solver: &dyn Solver,
+        polyhedron: SparseLEIntegerPolyhedron,
+        objectives: ApiObjectives,
+        direction: SolverDirection,
+    ) -> Result<Vec<ApiSolution>, SolveInputError> {
+        let fingerprint = Fingerprint::of(&polyhedron);
+        solver.solve(
+            Arc::new(polyhedron),
+            fingerprint,
+            objectives,
+            direction,
+            SolveOptions::default(),
+        )
+    }
+
+    #[test]
+    fn test_reduce_removes_redundant_rows_and_columns() {
+        let (reduced, columns) = reduce(&create_test_polyhedron()).unwrap();
+        assert_eq!(reduced.a.shape.nrows, 2);
+        assert_eq!(reduced.a.shape.ncols, 3);
+        assert_eq!(reduced.b, vec![0, 1]);
+        assert_eq!(reduced.a.rows, vec![0, 0, 1, 1]);
+        assert_eq!(reduced.a.cols, vec![0, 1, 1, 2]);
+        let ids: Vec<&str> = reduced.variables.iter().map(|v| v.id.as_str()).collect();
+        assert_eq!(ids, vec!["x", "y", "u"]);
+        assert_eq!(
+            columns.columns,
+            vec![
+                Column::Kept(0),
+                Column::Kept(1),
+                Column::Fixed(1),
+                Column::Free(-3, 4),
+                Column::Kept(2),
+            ]
+        );
+    }
+
+    #[test]
+    fn test_reduce_leaves_irreducible_and_infeasible_polyhedra() {
+        let mut polyhedron = create_test_polyhedron();
+        polyhedron.b[3] = -1;
+        assert!(reduce(&polyhedron).is_none());
+
+        let polyhedron = SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0, 0],
+                cols: vec![0, 1],
+                vals: vec![1, 1],
+                shape: ApiShape { nrows: 1, ncols: 2 },
+            },
+            b: vec![1],
+            variables: vec![variable("x", (0, 1)), variable("y", (0, 1))],
+        };
+        assert!(reduce(&polyhedron).is_none());
+    }
+
+    #[test]
+    fn test_reduce_keeps_rows_with_extreme_coefficients() {
+        // x + y + z <= MAX, scaled by MAX: the largest activity (3 * MAX^2)
+        // overflows i64, the row is binding and must stay
+        let big = (0, i32::MAX);
+        let polyhedron = SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0, 0, 0, 1, 1, 1],
+                cols: vec![0, 1, 2, 0, 1, 2],
+                vals: vec![
+                    i32::MAX,
+                    i32::MAX,
+                    i32::MAX,
+                    -i32::MAX,
+                    -i32::MAX,
+                    -i32::MAX,
+                ],
+                shape: ApiShape { nrows: 3, ncols: 4 },
+            },
+            b: vec![i32::MAX, i32::MIN, 0],
+            variables: vec![
+                variable("x", big),
+                variable("y", big),
+                variable("z", big),
+                variable("w", (i32::MIN, i32::MAX)),
+            ],
+        };
+        let (reduced, columns) = reduce(&polyhedron).unwrap();
+        assert_eq!(reduced.a.shape.nrows, 2);
+        assert_eq!(reduced.b, vec![i32::MAX, i32::MIN]);
+        assert_eq!(columns.columns[3], Column::Free(i32::MIN, i32::MAX));
+
+        // The same row with a fixed column pushing the right-hand side past i32
+        let mut fixed = polyhedron.clone();
+        fixed.variables[2].bound = (i32::MAX, i32::MAX);
+        assert!(reduce(&fixed).is_none());
+    }
+
+    #[test]
+    fn test_solutions_are_mapped_back_to_original_columns() {
+        let solver = ReducingSolver::new(Box::new(UpperBoundSolver::default()));
+        let objectives = ApiObjectives::Indexed(vec![vec![(0, 1.0), (2, 2.0), (3, -1.0)]]);
+        let solutions = solve(
+            &solver,
+            create_test_polyhedron(),
+            objectives,
+            SolverDirection::Maximize,
+        )
+        .ok()
+        .unwrap();
+        // w takes its lower bound as it lowers the objective
+        assert_eq!(
+            solutions[0].solution,
+            ApiValues::Dense(vec![1, 1, 1, -3, 1])
+        );
+        assert_eq!(solutions[0].objective, 6);
+
+        let objectives = ApiObjectives::Named(vec![HashMap::from([
+            ("x".to_string(), 1.0),
+            ("w".to_string(), 1.0),
+        ])]);
+        let solutions = solve(
+            &solver,
+            create_test_polyhedron(),
+            objectives,
+            SolverDirection::Maximize,
+        )
+        .ok()
+        .unwrap();
+        let ApiValues::Named(values) = &solutions[0].solution else {
+            panic!("named objectives get named values");
+        };
+        assert_eq!(values.len(), 5);
+        assert_eq!((values["z"], values["w"]), (1, 4));
+        assert_eq!(solutions[0].objective, 5);
+    }
+
+    #[test]
+    fn test_wrapped_solver_sees_reduced_objectives() {
+        let inner = UpperBoundSolver::default();
+        let seen = inner.seen.clone();
+        let solver = ReducingSolver::new(Box::new(inner));
+        let objectives = ApiObjectives::Indexed(vec![vec![(4, 1.0), (3, 1.0)]]);
+        solve(
+            &solver,
+            create_test_polyhedron(),
+            objectives,
+            SolverDirection::Minimize,
+        )
+        .ok()
+        .unwrap();
+        assert_eq!(
+            *seen.lock(),
+            vec![ApiObjectives::Indexed(vec![vec![(2, 1.0)]])]
+        );
+
+        let objectives = ApiObjectives::Indexed(vec![vec![(5, 1.0)]]);
+        assert!(solve(
+            &solver,
+            create_test_polyhedron(),
+            objectives,
+            SolverDirection::Minimize,
+        )
+        .is_err());
+    }
+
+    #[test]
+    fn test_polyhedra_without_kept_columns_skip_the_solver() {
+        let solver = ReducingSolver::new(Box::new(UpperBoundSolver::default()));
+        let polyhedron = SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0],
+                cols: vec![0],
+                vals: vec![1],
+                shape: ApiShape { nrows: 1, ncols: 2 },
+            },
+            b: vec![1],
+            variables: vec![variable("x", (0, 1)), variable("y", (2, 5))],
+        };
+
+        let objectives = ApiObjectives::Named(vec![HashMap::from([("y".to_string(), -1.0)])]);
+        let solutions = solve(
+            &solver,
+            polyhedron.clone(),
+            objectives,
+            SolverDirection::Minimize,
+        )
+        .ok()
+        .unwrap();
+        assert_eq!(solutions[0].objective, -5);
+        let ApiValues::Named(values) = &solutions[0].solution else {
+            panic!("named objectives get named values");
+        };
+        assert_eq!((values["x"], values["y"]), (0, 5));
+
+        let missing = ApiObjectives::Named(vec![HashMap::from([("v".to_string(), 1.0)])]);
+        assert!(solve(&solver, polyhedron, missing, SolverDirection::Minimize).is_err());
+    }
+
+    #[test]
+    fn test_pins_follow_the_reduced_polyhedron() {
+        let inner = UpperBoundSolver::default();
+        let pins = inner.pins.clone();
+        let solver = ReducingSolver::new(Box::new(inner));
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+
+        // Not forwarded until the reduced polyhedron is known
+        solver.pin(fingerprint);
+        assert_eq!(pins.load(Ordering::SeqCst), 0);
+        solver.warm(&polyhedron, fingerprint, true).ok().unwrap();
+        assert_eq!(pins.load(Ordering::SeqCst), 1);
+        solver.unpin(fingerprint);
+        assert_eq!(pins.load(Ordering::SeqCst), 0);
+        assert!(solver.pins.lock().is_empty());
+    }
+
+    #[test]
+    fn test_reductions_are_remembered_by_fingerprint() {
+        let solver = ReducingSolver::new(Box::new(UpperBoundSolver::default()));
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+
+        let first = solver.reduction(&polyhedron, fingerprint).unwrap();
+        let again = solver.reduction(&polyhedron, fingerprint).unwrap();
+        assert!(Arc::ptr_eq(&first, &again));
+
+        let mut irreducible = polyhedron;
+        irreducible.b[3] = -1;
+        let fingerprint = Fingerprint::of(&irreducible);
+        assert!(solver.reduction(&irreducible, fingerprint).is_none());
+        assert_eq!(solver.reductions.lock().len(), 2);
+    }
+}
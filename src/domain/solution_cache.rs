@@ -0,0 +1,352 @@
+use crate::domain::fingerprint::{Fingerprint, ObjectiveKey};
+use crate::domain::solver::{SolutionSink, SolveOptions, Solver};
+use crate::domain::validate::SolveInputError;
+use crate::metrics;
+use crate::models::{
+    ApiObjectives, ApiSolution, ApiValues, SolverDirection, SparseLEIntegerPolyhedron, Status,
+};
+use lru::LruCache;
+use parking_lot::Mutex;
+use std::mem::size_of;
+use std::sync::Arc;
+
+/// Rough memory of one cached solution, including its key and LRU entry
+fn solution_bytes(solution: &ApiSolution) -> usize {
+    let values = match &solution.solution {
+        // Id string, value and hash table slot per variable
+        ApiValues::Named(values) => values.keys().map(|id| id.len() + 48).sum(),
+        ApiValues::Dense(values) => values.len() * size_of::<i32>(),
+    };
+    size_of::<ObjectiveKey>() + size_of::<ApiSolution>() + 64 + values
+}
+
+/// Only final answers are cached; anything else is solved again next time
+fn is_cacheable(solution: &ApiSolution) -> bool {
+    solution.error.is_none()
+        && matches!(
+            solution.status,
+            Status::Optimal | Status::Infeasible | Status::Unbounded
+        )
+}
+
+struct CachedSolutions {
+    entries: LruCache<ObjectiveKey, (ApiSolution, usize)>,
+    bytes: usize,
+}
+
+/// Solver decorator that caches solutions per objective.
+///
+/// Objectives of a request that were solved before on the same polyhedron
+/// and direction are answered from the cache; only the misses are passed to
+/// the wrapped solver. The cache is bounded by the estimated memory of its
+/// solutions and evicts least recently used ones first. Solutions of
+/// requests with a MIP gap are not stored, as they may not be optimal.
+pub struct CachingSolver {
+    inner: Box<dyn Solver>,
+    cache: Mutex<CachedSolutions>,
+    budget_bytes: usize,
+}
+
+impl CachingSolver {
+    pub fn new(inner: Box<dyn Solver>, budget_bytes: usize) -> Self {
+        CachingSolver {
+            inner,
+            cache: Mutex::new(CachedSolutions {
+                entries: LruCache::unbounded(),
+                bytes: 0,
+            }),
+            budget_bytes,
+        }
+    }
+
+    fn store(&self, key: ObjectiveKey, solution: &ApiSolution) {
+        let size = solution_bytes(solution);
+        if size > self.budget_bytes {
+            return;
+        }
+        let mut cache = self.cache.lock();
+        if let Some((_, replaced)) = cache.entries.put(key, (solution.clone(), size)) {
+            cache.bytes -= replaced;
+        }
+        cache.bytes += size;
+        while cache.bytes > self.budget_bytes {
+            match cache.entries.pop_lru() {
+                Some((_, (_, evicted))) => cache.bytes -= evicted,
+                None => break,
+            }
+        }
+    }
+}
+
+impl Solver for CachingSolver {
+    fn solve_each(
+        &self,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
+        direction: SolverDirection,
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<(), SolveInputError> {
+        let keys: Vec<ObjectiveKey> = match &objectives {
+            ApiObjectives::Named(objectives) => objectives
+                .iter()
+                .map(|objective| ObjectiveKey::named(fingerprint, objective, direction))
+                .collect(),
+            ApiObjectives::Indexed(objectives) => objectives
+                .iter()
+                .map(|objective| ObjectiveKey::indexed(fingerprint, objective, direction))
+                .collect(),
+        };
+
+        let mut hits = Vec::new();
+        let mut is_miss = vec![true; keys.len()];
+        {
+            let mut cache = self.cache.lock();
+            for (idx, key) in keys.iter().enumerate() {
+                if let Some((solution, _)) = cache.entries.get(key) {
+                    hits.push((idx, solution.clone()));
+                    is_miss[idx] = false;
+                }
+            }
+        }
+
+        // Original index of every objective passed on to the wrapped solver
+        let misses: Vec<usize> = (0..keys.len()).filter(|&idx| is_miss[idx]).collect();
+        metrics::global().solution_cache_lookups(hits.len() as u64, misses.len() as u64);
+        if misses.is_empty() {
+            for (idx, solution) in hits {
+                on_solution(idx, solution);
+            }
+            return Ok(());
+        }
+
+        let missed = match objectives {
+            ApiObjectives::Named(objectives) => ApiObjectives::Named(
+                objectives
+                    .into_iter()
+                    .zip(&is_miss)
+                    .filter_map(|(objective, &miss)| miss.then_some(objective))
+                    .collect(),
+            ),
+            ApiObjectives::Indexed(objectives) => ApiObjectives::Indexed(
+                objectives
+                    .into_iter()
+                    .zip(&is_miss)
+                    .filter_map(|(objective, &miss)| miss.then_some(objective))
+                    .collect(),
+            ),
+        };
+
+        // Hits are held back until the wrapped solver emits its first
+        // solution, so input errors still come before any solution
+        let pending = Mutex::new(Some(hits));
+        let exact = options.limits.mip_gap.is_none();
+        let flush = || {
+            if let Some(hits) = pending.lock().take() {
+                for (idx, solution) in hits {
+                    on_solution(idx, solution);
+                }
+            }
+        };
+        self.inner.solve_each(
+            polyhedron,
+            fingerprint,
+            missed,
+            direction,
+            options,
+            &|sub_idx, solution| {
+                flush();
+                let idx = misses[sub_idx];
+                if exact && is_cacheable(&solution) {
+                    self.store(keys[idx], &solution);
+                }
+                on_solution(idx, solution);
+            },
+        )?;
+        flush();
+        Ok(())
+    }
+
+    fn warm(
+        &self,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
+        use_presolve: bool,
+    ) -> Result<(), SolveInputError> {
+        self.inner.warm(polyhedron, fingerprint, use_presolve)
+    }
+
+    fn cached_models(&self) -> Vec<Fingerprint> {
+        self.inner.cached_models()
+    }
+
+    fn pin(&self, fingerprint: Fingerprint) {
+        self.inner.pin(fingerprint)
+    }
+
+    fn unpin(&self, fingerprint: Fingerprint) {
+        self.inner.unpin(fingerprint)
+    }
+
+    fn name(&self) -> &str {
+        self.inner.name()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::{ApiIntegerSparseMatrix, ApiShape, ApiVariable};
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    /// Solves every objective to its first coefficient, counting objectives;
+    /// negative coefficients are input errors
+    struct CountingSolver {
+        solved: Arc<AtomicUsize>,
+    }
+
+    impl Solver for CountingSolver {
+        fn solve_each(
+            &self,
+            _polyhedron: Arc<SparseLEIntegerPolyhedron>,
+            _fingerprint: Fingerprint,
+            objectives: ApiObjectives,
+            _direction: SolverDirection,
+            _options: SolveOptions,
+            on_solution: &SolutionSink,
+        ) -> Result<(), SolveInputError> {
+            let ApiObjectives::Indexed(objectives) = objectives else {
+                unreachable!("tests only send indexed objectives");
+            };
+            if objectives.iter().any(|objective| objective[0].1 < 0.0) {
+                return Err(SolveInputError {
+                    details: "negative objective".to_string(),
+                });
+            }
+            for (idx, objective) in objectives.iter().enumerate() {
+                self.solved.fetch_add(1, Ordering::SeqCst);
+                on_solution(
+                    idx,
+                    ApiSolution {
+                        status: Status::Optimal,
+                        objective: objective[0].1 as i32,
+                        solution: ApiValues::Dense(vec![1]),
+                        error: None,
+                    },
+                );
+            }
+            Ok(())
+        }
+
+        fn name(&self) -> &str {
+            "Counting"
+        }
+    }
+
+    fn create_test_polyhedron() -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0],
+                cols: vec![0],
+                vals: vec![1],
+                shape: ApiShape { nrows: 1, ncols: 1 },
+            },
+            b: vec![1],
+            variables: vec![ApiVariable {
+                id: "x".to_string(),
+                bound: (0, 1),
+            }],
+        }
+    }
+
+    fn solve(solver: &CachingSolver, coefficients: &[f64]) -> Vec<i32> {
+        let polyhedron = Arc::new(create_test_polyhedron());
+        let fingerprint = Fingerprint::of(&polyhedron);
+        let objectives = coefficients.iter().map(|&c| vec![(0, c)]).collect();
+        solver
+            .solve(
+                polyhedron,
+                fingerprint,
+                ApiObjectives::Indexed(objectives),
+                SolverDirection::Maximize,
+                SolveOptions::default(),
+            )
+            .ok()
+            .unwrap()
+            .iter()
+            .map(|solution| solution.objective)
+            .collect()
+    }
+
+    #[test]
+    fn test_only_missed_objectives_reach_the_solver() {
+        let solved = Arc::new(AtomicUsize::new(0));
+        let solver = CachingSolver::new(
+            Box::new(CountingSolver {
+                solved: solved.clone(),
+            }),
+            1 << 20,
+        );
+
+        assert_eq!(solve(&solver, &[1.0, 2.0]), vec![1, 2]);
+        assert_eq!(solved.load(Ordering::SeqCst), 2);
+
+        // Only the new objective is solved, results keep request order
+        assert_eq!(solve(&solver, &[3.0, 2.0, 1.0]), vec![3, 2, 1]);
+        assert_eq!(solved.load(Ordering::SeqCst), 3);
+
+        assert_eq!(solve(&solver, &[2.0, 3.0]), vec![2, 3]);
+        assert_eq!(solved.load(Ordering::SeqCst), 3);
+    }
+
+    #[test]
+    fn test_cache_stays_within_budget() {
+        let solution = ApiSolution {
+            status: Status::Optimal,
+            objective: 0,
+            solution: ApiValues::Dense(vec![1]),
+            error: None,
+        };
+        let size = solution_bytes(&solution);
+        let solved = Arc::new(AtomicUsize::new(0));
+        let solver = CachingSolver::new(
+            Box::new(CountingSolver {
+                solved: solved.clone(),
+            }),
+            2 * size,
+        );
+
+        solve(&solver, &[1.0, 2.0, 3.0]);
+        let cache = solver.cache.lock();
+        assert_eq!(cache.entries.len(), 2);
+        assert_eq!(cache.bytes, 2 * size);
+    }
+
+    #[test]
+    fn test_hits_are_not_emitted_before_input_errors() {
+        let solver = CachingSolver::new(
+            Box::new(CountingSolver {
+                solved: Arc::new(AtomicUsize::new(0)),
+            }),
+            1 << 20,
+        );
+        solve(&solver, &[1.0]);
+
+        let polyhedron = Arc::new(create_test_polyhedron());
+        let fingerprint = Fingerprint::of(&polyhedron);
+        let emitted = AtomicUsize::new(0);
+        let result = solver.solve_each(
+            polyhedron,
+            fingerprint,
+            ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(0, -1.0)]]),
+            SolverDirection::Maximize,
+            SolveOptions::default(),
+            &|_, _| {
+                emitted.fetch_add(1, Ordering::SeqCst);
+            },
+        );
+        assert!(result.is_err());
+        assert_eq!(emitted.load(Ordering::SeqCst), 0);
+    }
+}
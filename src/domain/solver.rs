@@ -1,27 +1,240 @@
+use crate::domain::fingerprint::Fingerprint;
 use crate::domain::validate::SolveInputError;
-use crate::models::{ApiSolution, SolverDirection, SparseLEIntegerPolyhedron};
-use std::collections::HashMap;
+use crate::models::{
+    ApiObjectives, ApiSolution, Assignment, SolverDirection, SparseLEIntegerPolyhedron,
+};
+
+use parking_lot::Mutex;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+/// Work limits of one request
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct SolveLimits {
+    /// Wall-clock budget shared by all objectives of the request
+    pub time_limit: Option<Duration>,
+    /// Relative MIP gap at which an objective counts as solved
+    pub mip_gap: Option<f64>,
+}
+
+impl SolveLimits {
+    /// Deadline of a solve starting now
+    pub fn deadline(&self) -> Option<Instant> {
+        self.time_limit.map(|limit| Instant::now() + limit)
+    }
+}
+
+/// Time left until `deadline`, `None` without one
+pub fn remaining(deadline: Option<Instant>) -> Option<Duration> {
+    deadline.map(|deadline| deadline.saturating_duration_since(Instant::now()))
+}
+
+#[derive(Debug, Default)]
+struct CancelState {
+    flag: AtomicBool,
+    children: Mutex<Vec<CancelToken>>,
+}
+
+/// Cooperative cancellation of a solve, e.g. when its client disconnects.
+///
+/// Clones share one flag. Solvers check it between objectives and poll it
+/// from their interrupt callbacks while an objective is being solved.
+#[derive(Debug, Clone, Default)]
+pub struct CancelToken(Arc<CancelState>);
+
+impl CancelToken {
+    pub fn cancel(&self) {
+        self.0.flag.store(true, Ordering::Relaxed);
+        for child in self.0.children.lock().drain(..) {
+            child.cancel();
+        }
+    }
+
+    pub fn is_cancelled(&self) -> bool {
+        self.0.flag.load(Ordering::Relaxed)
+    }
+
+    /// The shared flag, for passing to solver callbacks as user data
+    pub fn flag(&self) -> &AtomicBool {
+        &self.0.flag
+    }
+
+    /// Token cancelled with this one that can also be cancelled on its own,
+    /// e.g. to stop part of a solve
+    pub fn child(&self) -> CancelToken {
+        let child = CancelToken::default();
+        let mut children = self.0.children.lock();
+        if self.is_cancelled() {
+            child.cancel();
+        } else {
+            children.push(child.clone());
+        }
+        child
+    }
+
+    /// Guard that cancels the solve when dropped, e.g. with the request future
+    pub fn cancel_on_drop(&self) -> CancelOnDrop {
+        CancelOnDrop(self.clone())
+    }
+
+    /// Fail with a "Solve cancelled" error once cancelled
+    pub fn check(&self) -> Result<(), SolveInputError> {
+        if self.is_cancelled() {
+            return Err(SolveInputError {
+                details: "Solve cancelled".to_string(),
+            });
+        }
+        Ok(())
+    }
+}
+
+/// Cancels its token when dropped, see `CancelToken::cancel_on_drop`
+pub struct CancelOnDrop(CancelToken);
+
+impl Drop for CancelOnDrop {
+    fn drop(&mut self) {
+        self.0.cancel();
+    }
+}
+
+/// Per-request solve settings
+#[derive(Debug, Clone)]
+pub struct SolveOptions {
+    /// Enable/disable presolve optimization
+    pub use_presolve: bool,
+    /// Maximum number of objectives solved concurrently, each on its own
+    /// model copy (1 = one after another on the calling thread)
+    pub parallelism: usize,
+    /// Threads each solver instance may use (0 = the solver's default);
+    /// GLPK always solves on one thread
+    pub threads: usize,
+    /// Client-supplied assignment used as MIP start for the first objective;
+    /// later objectives start from the previous objective's incumbent
+    pub hint: Option<Assignment>,
+    /// Time limit and MIP gap
+    pub limits: SolveLimits,
+    /// Stops the solve early; objectives left unsolved fail the request
+    pub cancel: CancelToken,
+}
+
+impl Default for SolveOptions {
+    fn default() -> Self {
+        SolveOptions {
+            use_presolve: true,
+            parallelism: 1,
+            threads: 0,
+            hint: None,
+            limits: SolveLimits::default(),
+            cancel: CancelToken::default(),
+        }
+    }
+}
+
+/// Receives `(objective index, solution)` as soon as each objective is solved.
+///
+/// Called from solver worker threads, in completion order.
+pub type SolutionSink<'a> = dyn Fn(usize, ApiSolution) + Sync + 'a;
 
 /// Common interface for LP/ILP solvers
 pub trait Solver: Send + Sync {
-    /// Solve one or more linear programming problems
+    /// Solve one or more linear programming problems, handing every solution
+    /// to `on_solution` as soon as its objective is done
     ///
     /// # Arguments
-    /// * `polyhedron` - The constraint polyhedron (Ax <= b with variable bounds)
-    /// * `objectives` - List of objective functions to optimize
+    /// * `polyhedron` - The constraint polyhedron (Ax <= b with variable bounds),
+    ///   shared so registered models and racing backends need no copy
+    /// * `fingerprint` - `Fingerprint::of(&polyhedron)`, computed once per request
+    /// * `objectives` - List of objective functions to optimize; indexed
+    ///   objectives get dense solution values
     /// * `direction` - Maximize or Minimize
-    /// * `use_presolve` - Enable/disable presolve optimization
+    /// * `options` - Presolve, parallelism, warm-start, limit and cancellation settings
+    /// * `on_solution` - Receives each solution with the index of its objective
+    ///
+    /// Input errors are returned before any solution is emitted. Objectives
+    /// reached after the time limit ran out get `Status::TimeLimit` without
+    /// being solved.
+    fn solve_each(
+        &self,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
+        direction: SolverDirection,
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<(), SolveInputError>;
+
+    /// Solve one or more linear programming problems
     ///
     /// # Returns
-    /// A vector of solutions, one for each objective function
+    /// A vector of solutions, one for each objective function, in objective order
     fn solve(
         &self,
-        polyhedron: SparseLEIntegerPolyhedron,
-        objectives: Vec<HashMap<String, f64>>,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
         direction: SolverDirection,
-        use_presolve: bool,
-    ) -> Result<Vec<ApiSolution>, SolveInputError>;
+        options: SolveOptions,
+    ) -> Result<Vec<ApiSolution>, SolveInputError> {
+        let solutions: Mutex<Vec<Option<ApiSolution>>> =
+            Mutex::new((0..objectives.count()).map(|_| None).collect());
+        self.solve_each(
+            polyhedron,
+            fingerprint,
+            objectives,
+            direction,
+            options,
+            &|index, solution| solutions.lock()[index] = Some(solution),
+        )?;
+        Ok(solutions
+            .into_inner()
+            .into_iter()
+            .map(|solution| solution.expect("every objective solved"))
+            .collect())
+    }
+
+    /// Build and cache the model for `polyhedron` without solving anything.
+    ///
+    /// A no-op for solvers without a model cache.
+    fn warm(
+        &self,
+        _polyhedron: &SparseLEIntegerPolyhedron,
+        _fingerprint: Fingerprint,
+        _use_presolve: bool,
+    ) -> Result<(), SolveInputError> {
+        Ok(())
+    }
+
+    /// Fingerprints of the cached models, most valuable first
+    fn cached_models(&self) -> Vec<Fingerprint> {
+        Vec::new()
+    }
+
+    /// Keep the cached model of the polyhedron with `fingerprint` from being
+    /// evicted until a matching `unpin`. A no-op without a model cache.
+    fn pin(&self, _fingerprint: Fingerprint) {}
+
+    /// Release one `pin` of the model of the polyhedron with `fingerprint`
+    fn unpin(&self, _fingerprint: Fingerprint) {}
 
     /// Get the solver name for logging/debugging
     fn name(&self) -> &str;
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_child_tokens_follow_their_parent() {
+        let parent = CancelToken::default();
+        let child = parent.child();
+        child.cancel();
+        assert!(!parent.is_cancelled());
+
+        let sibling = parent.child();
+        parent.cancel();
+        assert!(sibling.is_cancelled());
+        assert!(parent.child().is_cancelled());
+    }
+}
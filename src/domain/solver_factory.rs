@@ -1,5 +1,8 @@
+use crate::domain::model_cache::ModelCacheConfig;
+use crate::domain::portfolio::PortfolioSolver;
 use crate::domain::solver::Solver;
 use crate::domain::solvers::GlpkSolver;
+use crate::domain::validate::SolveInputError;
 
 #[cfg(feature = "highs-solver")]
 use crate::domain::solvers::HighsSolver;
@@ -15,6 +18,8 @@ pub enum SolverType {
     Highs,
     #[cfg(feature = "gurobi-solver")]
     Gurobi,
+    /// Races every compiled-in backend, see `PortfolioSolver`
+    Portfolio,
 }
 
 impl SolverType {
@@ -30,32 +35,71 @@ impl SolverType {
             "gurobi" => Some(SolverType::Gurobi),
             #[cfg(not(feature = "gurobi-solver"))]
             "gurobi" => panic!("Gurobi solver specified in environment but feature flag not present. Enable using `--features gurobi-solver`"),
+            "portfolio" => Some(SolverType::Portfolio),
             _ => None,
         }
     }
+
+    /// Every backend compiled into this binary
+    pub fn backends() -> Vec<SolverType> {
+        vec![
+            SolverType::Glpk,
+            #[cfg(feature = "highs-solver")]
+            SolverType::Highs,
+            #[cfg(feature = "gurobi-solver")]
+            SolverType::Gurobi,
+        ]
+    }
 }
 
-/// Create a solver instance with specified cache size
+/// Create a solver instance with specified cache sizing.
+///
+/// `slots` is the number of solves that may run at once; Gurobi creates one
+/// environment per slot. Fails when the backend cannot start, e.g. Gurobi
+/// without a license. A portfolio leaves out the backends that fail and only
+/// fails when none is left. Every backend of a portfolio gets its own model
+/// cache of this size.
 pub fn create_solver_with_cache(
     solver_type: SolverType,
-    cache_size: Option<usize>,
-) -> Box<dyn Solver> {
-    match solver_type {
-        SolverType::Glpk => match cache_size {
-            Some(size) => Box::new(GlpkSolver::with_cache_size(Some(size))),
+    cache: Option<ModelCacheConfig>,
+    slots: usize,
+) -> Result<Box<dyn Solver>, SolveInputError> {
+    Ok(match solver_type {
+        SolverType::Glpk => match cache {
+            Some(config) => Box::new(GlpkSolver::with_cache_config(Some(config))),
             None => Box::new(GlpkSolver::without_cache()),
         },
         #[cfg(feature = "highs-solver")]
-        SolverType::Highs => match cache_size {
-            Some(size) => Box::new(HighsSolver::with_cache_size(Some(size))),
+        SolverType::Highs => match cache {
+            Some(config) => Box::new(HighsSolver::with_cache_config(Some(config))),
             None => Box::new(HighsSolver::without_cache()),
         },
         #[cfg(feature = "gurobi-solver")]
-        SolverType::Gurobi => match cache_size {
-            Some(size) => Box::new(GurobiSolver::with_cache_size(Some(size))),
-            None => Box::new(GurobiSolver::without_cache()),
+        SolverType::Gurobi => match cache {
+            Some(config) => Box::new(GurobiSolver::with_cache_config(Some(config), slots)?),
+            None => Box::new(GurobiSolver::without_cache(slots)?),
         },
-    }
+        SolverType::Portfolio => {
+            let solvers: Vec<Box<dyn Solver>> = SolverType::backends()
+                .into_iter()
+                .filter_map(
+                    |backend| match create_solver_with_cache(backend, cache, slots) {
+                        Ok(solver) => Some(solver),
+                        Err(e) => {
+                            eprintln!("Leaving {:?} out of the portfolio: {}", backend, e.details);
+                            None
+                        }
+                    },
+                )
+                .collect();
+            if solvers.is_empty() {
+                return Err(SolveInputError {
+                    details: "No portfolio backend could be created".to_string(),
+                });
+            }
+            Box::new(PortfolioSolver::new(solvers))
+        }
+    })
 }
 
 #[cfg(test)]
@@ -63,7 +107,7 @@ mod tests {
     use super::*;
 
     pub fn create_solver(solver_type: SolverType) -> Box<dyn Solver> {
-        create_solver_with_cache(solver_type, None) // Default to no cache
+        create_solver_with_cache(solver_type, None, 1).ok().unwrap() // Default to no cache
     }
 
     #[test]
@@ -78,6 +122,10 @@ mod tests {
         assert_eq!(SolverType::from_str("gurobi"), Some(SolverType::Gurobi));
         #[cfg(feature = "gurobi-solver")]
         assert_eq!(SolverType::from_str("Gurobi"), Some(SolverType::Gurobi));
+        assert_eq!(
+            SolverType::from_str("portfolio"),
+            Some(SolverType::Portfolio)
+        );
         assert_eq!(SolverType::from_str("unknown"), None);
     }
 
@@ -87,6 +135,12 @@ mod tests {
         assert_eq!(solver.name(), "GLPK");
     }
 
+    #[test]
+    fn test_create_portfolio_solver() {
+        let solver = create_solver(SolverType::Portfolio);
+        assert!(solver.name().starts_with("Portfolio(GLPK"));
+    }
+
     #[cfg(feature = "highs-solver")]
     #[test]
     fn test_create_highs_solver() {
@@ -0,0 +1,122 @@
+//! Raw bindings to the parts of the GLPK C API used for cached models.
+//!
+//! `glpk-rust` builds and links `libglpk` but only exposes `solve_ilps`,
+//! which creates and deletes its problem on every call. These declarations
+//! resolve against that same library.
+// Struct fields are written by GLPK and mostly never read on the Rust side
+#![allow(non_camel_case_types, dead_code)]
+
+use std::os::raw::{c_double, c_int, c_void};
+
+/// Opaque GLPK problem object
+#[repr(C)]
+pub struct glp_prob {
+    _private: [u8; 0],
+}
+
+/// Simplex control parameters.
+///
+/// Only the leading fields are set here. The reserved tail is larger than in
+/// any GLPK release, so `glp_init_smcp` never writes past the end.
+#[repr(C)]
+pub struct glp_smcp {
+    pub msg_lev: c_int,
+    pub meth: c_int,
+    pub pricing: c_int,
+    pub r_test: c_int,
+    pub tol_bnd: c_double,
+    pub tol_dj: c_double,
+    pub tol_piv: c_double,
+    pub obj_ll: c_double,
+    pub obj_ul: c_double,
+    pub it_lim: c_int,
+    pub tm_lim: c_int,
+    pub out_frq: c_int,
+    pub out_dly: c_int,
+    pub presolve: c_int,
+    _reserved: [c_double; 40],
+}
+
+/// Branch-and-cut control parameters, with the same oversized reserved tail
+#[repr(C)]
+pub struct glp_iocp {
+    pub msg_lev: c_int,
+    pub br_tech: c_int,
+    pub bt_tech: c_int,
+    pub tol_int: c_double,
+    pub tol_obj: c_double,
+    pub tm_lim: c_int,
+    pub out_frq: c_int,
+    pub out_dly: c_int,
+    pub cb_func: Option<unsafe extern "C" fn(*mut c_void, *mut c_void)>,
+    pub cb_info: *mut c_void,
+    pub cb_size: c_int,
+    pub pp_tech: c_int,
+    pub mip_gap: c_double,
+    pub mir_cuts: c_int,
+    pub gmi_cuts: c_int,
+    pub cov_cuts: c_int,
+    pub clq_cuts: c_int,
+    pub presolve: c_int,
+    _reserved: [c_double; 40],
+}
+
+pub const GLP_OFF: c_int = 0;
+pub const GLP_ON: c_int = 1;
+pub const GLP_MSG_OFF: c_int = 0;
+
+pub const GLP_MIN: c_int = 1;
+pub const GLP_MAX: c_int = 2;
+
+// Row and column bound types
+pub const GLP_FR: c_int = 1;
+pub const GLP_UP: c_int = 3;
+pub const GLP_DB: c_int = 4;
+pub const GLP_FX: c_int = 5;
+
+pub const GLP_IV: c_int = 2;
+
+// Solution statuses
+pub const GLP_FEAS: c_int = 2;
+pub const GLP_NOFEAS: c_int = 4;
+pub const GLP_OPT: c_int = 5;
+pub const GLP_UNBND: c_int = 6;
+
+// Solver return codes
+pub const GLP_EBOUND: c_int = 0x04;
+pub const GLP_ETMLIM: c_int = 0x09;
+pub const GLP_ENOPFS: c_int = 0x0A;
+pub const GLP_ENODFS: c_int = 0x0B;
+pub const GLP_ESTOP: c_int = 0x0D;
+pub const GLP_EMIPGAP: c_int = 0x0E;
+
+extern "C" {
+    pub fn glp_create_prob() -> *mut glp_prob;
+    pub fn glp_delete_prob(p: *mut glp_prob);
+    pub fn glp_set_obj_dir(p: *mut glp_prob, dir: c_int);
+    pub fn glp_add_rows(p: *mut glp_prob, nrs: c_int) -> c_int;
+    pub fn glp_add_cols(p: *mut glp_prob, ncs: c_int) -> c_int;
+    pub fn glp_set_row_bnds(p: *mut glp_prob, i: c_int, kind: c_int, lb: c_double, ub: c_double);
+    pub fn glp_set_col_bnds(p: *mut glp_prob, j: c_int, kind: c_int, lb: c_double, ub: c_double);
+    pub fn glp_set_col_kind(p: *mut glp_prob, j: c_int, kind: c_int);
+    pub fn glp_set_obj_coef(p: *mut glp_prob, j: c_int, coef: c_double);
+    pub fn glp_load_matrix(
+        p: *mut glp_prob,
+        ne: c_int,
+        ia: *const c_int,
+        ja: *const c_int,
+        ar: *const c_double,
+    );
+    pub fn glp_init_smcp(parm: *mut glp_smcp);
+    pub fn glp_simplex(p: *mut glp_prob, parm: *const glp_smcp) -> c_int;
+    pub fn glp_get_status(p: *mut glp_prob) -> c_int;
+    pub fn glp_init_iocp(parm: *mut glp_iocp);
+    pub fn glp_intopt(p: *mut glp_prob, parm: *const glp_iocp) -> c_int;
+    pub fn glp_mip_status(p: *mut glp_prob) -> c_int;
+    pub fn glp_mip_col_val(p: *mut glp_prob, j: c_int) -> c_double;
+    /// Only valid inside a `glp_iocp::cb_func` callback, on the tree it was given
+    pub fn glp_ios_terminate(tree: *mut c_void);
+    pub fn glp_term_out(flag: c_int) -> c_int;
+    /// Frees all GLPK memory of the calling thread's environment
+    pub fn glp_free_env() -> c_int;
+}
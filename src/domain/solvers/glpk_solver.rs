@@ -1,71 +1,971 @@
-use crate::convert::{to_borrowed_objective, to_glpk_polyhedron};
-use crate::domain::solver::Solver;
-use crate::domain::validate::{validate_objectives_owned, SolveInputError};
-use crate::models::{ApiSolution, SolverDirection, SparseLEIntegerPolyhedron};
+use crate::convert::{
+    copy_glpk_polyhedron, from_glpk_solution, into_glpk_polyhedron, timed_out_solution,
+    to_api_values, to_borrowed_indexed_objective, to_borrowed_objective,
+};
+use crate::domain::bounds::ModelBounds;
+use crate::domain::columns::{ColumnIndex, SparseObjective};
+use crate::domain::fingerprint::Fingerprint;
+use crate::domain::model_cache::{ModelCache, ModelCacheConfig, PooledModel};
+use crate::domain::parallel;
+use crate::domain::solver::{remaining, CancelToken, SolutionSink, SolveOptions, Solver};
+use crate::domain::solvers::glpk_ffi::*;
+use crate::domain::sparse;
+use crate::domain::validate::{
+    validate_objectives_indexed, validate_objectives_owned, SolveInputError,
+};
+use crate::metrics::{self, Phase};
+use crate::models::{
+    ApiObjectives, ApiSolution, SolverDirection, SparseLEIntegerPolyhedron, Status,
+};
 use glpk_rust::solve_ilps;
 use std::collections::HashMap;
+use std::ops::Range;
+use std::os::raw::{c_int, c_void};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{mpsc, Arc};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use parking_lot::Mutex;
 
 const NO_TERMINAL_OUTPUT: bool = false;
+/// Longest run of objectives handed to a single `solve_ilps` call
+const MAX_CHUNK_LEN: usize = 16;
+
+/// GLPK problem, only ever touched on the thread of its `GlpkModel`
+///
+/// GLPK keeps its memory in a per-thread environment (the default since
+/// 4.59), so a problem must be created, changed, solved and deleted on one
+/// thread.
+struct GlpkProblem {
+    prob: *mut glp_prob,
+    /// Columns given a cost by the previous objective, reset before the next one
+    costed: Vec<usize>,
+}
+
+impl Drop for GlpkProblem {
+    fn drop(&mut self) {
+        unsafe {
+            glp_delete_prob(self.prob);
+        }
+    }
+}
+
+type Job = Box<dyn FnOnce(&mut GlpkProblem) + Send>;
+
+/// Cached GLPK problem, built once per matrix structure with zero costs
+///
+/// The problem lives on a dedicated thread that runs the jobs sent to it,
+/// so it never changes threads while the model moves between its callers.
+/// Dropping the model ends the thread, which deletes the problem and
+/// releases the thread's GLPK environment.
+struct GlpkModel {
+    n_cols: usize,
+    columns: ColumnIndex,
+    bounds: ModelBounds,
+    jobs: Option<mpsc::Sender<Job>>,
+    owner: Option<thread::JoinHandle<()>>,
+}
+
+impl GlpkModel {
+    /// Run `job` on the problem's thread and wait for its result
+    fn run<R, F>(&self, job: F) -> Result<R, SolveInputError>
+    where
+        R: Send + 'static,
+        F: FnOnce(&mut GlpkProblem) -> R + Send + 'static,
+    {
+        let stopped = || SolveInputError {
+            details: "GLPK model thread stopped".to_string(),
+        };
+        let (reply, result) = mpsc::sync_channel(1);
+        self.jobs
+            .as_ref()
+            .ok_or_else(stopped)?
+            .send(Box::new(move |problem| {
+                let _ = reply.send(job(problem));
+            }))
+            .map_err(|_| stopped())?;
+        result.recv().map_err(|_| stopped())
+    }
+}
+
+impl Drop for GlpkModel {
+    fn drop(&mut self) {
+        // Closing the queue ends the owner thread's loop
+        self.jobs.take();
+        if let Some(owner) = self.owner.take() {
+            let _ = owner.join();
+        }
+    }
+}
+
+/// Releases the GLPK environment of the thread it is dropped on
+///
+/// `solve_ilps` sets one up on every thread it runs on, which scoped
+/// objective workers would otherwise leak when they exit.
+struct ReleaseEnv;
+
+impl Drop for ReleaseEnv {
+    fn drop(&mut self) {
+        unsafe {
+            glp_free_env();
+        }
+    }
+}
+
+/// What `optimize` needs of a request, moved to the problem's thread
+struct RunSettings {
+    use_presolve: bool,
+    mip_gap: Option<f64>,
+    cancel: CancelToken,
+    time_left: Option<Duration>,
+}
 
 /// GLPK solver implementation
 ///
-/// Note: GLPK does not support model caching due to its mutable API design.
-/// The cache_size parameter is accepted for API consistency but has no effect.
-pub struct GlpkSolver;
+/// Without a model cache every request is converted and solved by
+/// `glpk_rust::solve_ilps`, which builds the GLPK problem on each call. With
+/// a cache, problems are built once per polyhedron through the GLPK C API
+/// and kept like the HiGHS and Gurobi models:
+/// - Models are cached based on the polyhedron's matrix structure; `b` and
+///   variable bounds of a cached model are updated in place when they differ
+/// - GDSF eviction when the cache is full, counting every replica
+/// - Only the objective coefficients and direction change between solves,
+///   so the simplex restarts from the previous basis when presolve is off
+/// - Time limit, MIP gap and cancellation reach the running branch-and-cut;
+///   without a cache they are only checked between `solve_ilps` calls
+pub struct GlpkSolver {
+    model_cache: Option<ModelCache<GlpkModel>>,
+}
 
 impl GlpkSolver {
     /// Create a new GLPK solver with specified cache size
-    /// Note: Cache is not supported for GLPK, parameter ignored
-    pub fn with_cache_size(_size: Option<usize>) -> Self {
-        GlpkSolver
+    pub fn with_cache_size(size: Option<usize>) -> Self {
+        Self::with_cache_config(size.map(ModelCacheConfig::with_capacity))
+    }
+
+    /// Create a new GLPK solver with the given cache sizing
+    pub fn with_cache_config(config: Option<ModelCacheConfig>) -> Self {
+        match config {
+            Some(config) if config.capacity > 0 => GlpkSolver {
+                model_cache: Some(ModelCache::new(config)),
+            },
+            _ => Self::without_cache(),
+        }
     }
 
-    /// Create solver with caching disabled (same as default for GLPK)
+    /// Create solver with caching disabled
     pub fn without_cache() -> Self {
-        GlpkSolver
+        GlpkSolver { model_cache: None }
     }
+
+    /// Build a GLPK problem for the given polyhedron, with all costs zero,
+    /// on a new model thread
+    fn build_model(polyhedron: &SparseLEIntegerPolyhedron) -> Result<GlpkModel, SolveInputError> {
+        let n_cols = polyhedron.variables.len();
+
+        // GLPK aborts the process on invalid calls, e.g. adding zero rows or
+        // loading duplicate matrix entries, so both are avoided here
+        let mut ia = vec![0];
+        let mut ja = vec![0];
+        let mut ar = vec![0.0];
+        sparse::with_csr(&polyhedron.a, |csr| {
+            let mut row = Vec::new();
+            for row_idx in 0..csr.major_len() {
+                let (cols, coeffs) = csr.slice(row_idx);
+                row.clear();
+                row.extend(cols.iter().copied().zip(coeffs.iter().copied()));
+                row.sort_unstable_by_key(|&(col, _)| col);
+                row.dedup_by(|next, kept| {
+                    let same = next.0 == kept.0;
+                    if same {
+                        kept.1 += next.1;
+                    }
+                    same
+                });
+                for &(col, coeff) in row.iter().filter(|&&(_, coeff)| coeff != 0.0) {
+                    ia.push(row_idx as i32 + 1);
+                    ja.push(col + 1);
+                    ar.push(coeff);
+                }
+            }
+        });
+        let b = polyhedron.b.clone();
+        let bounds: Vec<(i32, i32)> = polyhedron.variables.iter().map(|v| v.bound).collect();
+
+        let (jobs, queue) = mpsc::channel::<Job>();
+        let (loaded, created) = mpsc::sync_channel(1);
+        let owner = thread::Builder::new()
+            .name("glpk-model".to_string())
+            .spawn(move || {
+                let problem = unsafe { load_problem(&b, &bounds, &ia, &ja, &ar) };
+                let _ = loaded.send(problem.is_some());
+                if let Some(mut problem) = problem {
+                    for job in queue {
+                        job(&mut problem);
+                    }
+                }
+                unsafe {
+                    glp_free_env();
+                }
+            })
+            .map_err(|e| SolveInputError {
+                details: format!("Failed to start GLPK model thread: {}", e),
+            })?;
+
+        let model = GlpkModel {
+            n_cols,
+            columns: ColumnIndex::new(&polyhedron.variables),
+            bounds: ModelBounds::new(polyhedron),
+            jobs: Some(jobs),
+            owner: Some(owner),
+        };
+        match created.recv() {
+            Ok(true) => Ok(model),
+            _ => Err(SolveInputError {
+                details: "Failed to create GLPK problem".to_string(),
+            }),
+        }
+    }
+
+    /// Apply the `b` and bounds of `polyhedron` to a cached model of the same structure
+    fn apply_bounds(
+        model: &mut GlpkModel,
+        polyhedron: &SparseLEIntegerPolyhedron,
+    ) -> Result<(), SolveInputError> {
+        let changes = model.bounds.changes(polyhedron);
+        if changes.is_empty() {
+            return Ok(());
+        }
+        let rows: Vec<(usize, i32)> = changes
+            .rows
+            .iter()
+            .map(|&row| (row, polyhedron.b[row]))
+            .collect();
+        let cols: Vec<(usize, (i32, i32))> = changes
+            .cols
+            .iter()
+            .map(|&col| (col, polyhedron.variables[col].bound))
+            .collect();
+        model.run(move |problem| unsafe {
+            for (row, b) in rows {
+                glp_set_row_bnds(problem.prob, row as i32 + 1, GLP_UP, 0.0, b as f64);
+            }
+            for (col, bound) in cols {
+                set_col_bounds(problem.prob, col, bound);
+            }
+        })?;
+        model.bounds.commit(polyhedron, &changes);
+        Ok(())
+    }
+
+    /// Run the simplex (unless presolve is on) and branch-and-cut on `prob`,
+    /// returning the status or the status and error of a failed solve
+    ///
+    /// `settings.time_left` bounds both runs together.
+    fn optimize(prob: *mut glp_prob, settings: &RunSettings) -> Result<Status, (Status, String)> {
+        let use_presolve = settings.use_presolve;
+        let time_left = settings.time_left;
+        let started = Instant::now();
+        // GLPK limits are whole milliseconds, and zero would mean no time at all
+        let tm_lim = |left: Duration| {
+            left.saturating_sub(started.elapsed())
+                .as_millis()
+                .clamp(1, c_int::MAX as u128) as c_int
+        };
+        unsafe {
+            if !use_presolve {
+                // Without presolve `glp_intopt` needs an optimal LP relaxation;
+                // the simplex starts from the basis of the previous objective
+                let mut smcp: glp_smcp = std::mem::zeroed();
+                glp_init_smcp(&mut smcp);
+                smcp.msg_lev = GLP_MSG_OFF;
+                if let Some(left) = time_left {
+                    smcp.tm_lim = tm_lim(left);
+                }
+                match glp_simplex(prob, &smcp) {
+                    0 => (),
+                    GLP_EBOUND => return Ok(Status::EmptySpace),
+                    GLP_ETMLIM => {
+                        return Err((
+                            Status::TimeLimit,
+                            "Time limit reached while solving the LP relaxation".to_string(),
+                        ))
+                    }
+                    code => {
+                        return Err((
+                            Status::SimplexFailed,
+                            format!("GLPK simplex failed with code {}", code),
+                        ))
+                    }
+                }
+                match glp_get_status(prob) {
+                    GLP_OPT => (),
+                    GLP_NOFEAS => return Ok(Status::Infeasible),
+                    GLP_UNBND => return Ok(Status::Unbounded),
+                    _ => return Ok(Status::Undefined),
+                }
+            }
+
+            let mut iocp: glp_iocp = std::mem::zeroed();
+            glp_init_iocp(&mut iocp);
+            iocp.msg_lev = GLP_MSG_OFF;
+            iocp.presolve = if use_presolve { GLP_ON } else { GLP_OFF };
+            if let Some(left) = time_left {
+                iocp.tm_lim = tm_lim(left);
+            }
+            if let Some(gap) = settings.mip_gap {
+                iocp.mip_gap = gap;
+            }
+            iocp.cb_func = Some(terminate_if_cancelled);
+            iocp.cb_info = settings.cancel.flag() as *const AtomicBool as *mut c_void;
+            match glp_intopt(prob, &iocp) {
+                0 => (),
+                // Within the requested gap counts as optimal, like in HiGHS and Gurobi
+                GLP_EMIPGAP => return Ok(Status::Optimal),
+                GLP_EBOUND => return Ok(Status::EmptySpace),
+                GLP_ENOPFS => return Ok(Status::Infeasible),
+                GLP_ENODFS => return Ok(Status::Unbounded),
+                GLP_ETMLIM => return Ok(Status::TimeLimit),
+                GLP_ESTOP => {
+                    return Err((
+                        Status::Undefined,
+                        "GLPK branch-and-cut was cancelled".to_string(),
+                    ))
+                }
+                code => {
+                    return Err((
+                        Status::MIPFailed,
+                        format!("GLPK branch-and-cut failed with code {}", code),
+                    ))
+                }
+            }
+            Ok(match glp_mip_status(prob) {
+                GLP_OPT => Status::Optimal,
+                GLP_FEAS => Status::Feasible,
+                GLP_NOFEAS => Status::Infeasible,
+                _ => Status::Undefined,
+            })
+        }
+    }
+
+    /// Solve a single objective on a checked-out model by replacing its costs.
+    ///
+    /// `time_left` is what remains of the request's time limit.
+    /// `dense` returns the values in variable order instead of keyed by id.
+    fn solve_objective(
+        model: &GlpkModel,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        objective: &SparseObjective,
+        dir: c_int,
+        options: &SolveOptions,
+        time_left: Option<Duration>,
+        dense: bool,
+    ) -> Result<ApiSolution, SolveInputError> {
+        let n_cols = model.n_cols;
+        let costs = objective.clone();
+        let settings = RunSettings {
+            use_presolve: options.use_presolve,
+            mip_gap: options.limits.mip_gap,
+            cancel: options.cancel.clone(),
+            time_left,
+        };
+        let (status, error, values) = model.run(move |problem| {
+            unsafe {
+                glp_set_obj_dir(problem.prob, dir);
+                for &col in &problem.costed {
+                    glp_set_obj_coef(problem.prob, col as i32 + 1, 0.0);
+                }
+                for &(col, coeff) in &costs {
+                    glp_set_obj_coef(problem.prob, col as i32 + 1, coeff);
+                }
+            }
+            problem.costed.clear();
+            problem.costed.extend(costs.iter().map(|&(col, _)| col));
+
+            let (status, error) = if n_cols == 0 {
+                (Status::EmptySpace, None)
+            } else {
+                match metrics::timed(Phase::Solve, || Self::optimize(problem.prob, &settings)) {
+                    Ok(status) => (status, None),
+                    Err((status, error)) => (status, Some(error)),
+                }
+            };
+
+            // Only feasible integer solutions have column values worth reading; a
+            // time limit in branch-and-cut may have left an incumbent
+            let has_values = match (status, &error) {
+                (Status::Optimal | Status::Feasible, _) => true,
+                (Status::TimeLimit, None) => unsafe { glp_mip_status(problem.prob) == GLP_FEAS },
+                _ => false,
+            };
+            let values: Vec<i32> = if has_values {
+                (0..n_cols)
+                    .map(|j| unsafe { glp_mip_col_val(problem.prob, j as i32 + 1) }.round() as i32)
+                    .collect()
+            } else {
+                vec![0; n_cols]
+            };
+            (status, error, values)
+        })?;
+
+        let objective_value: f64 = objective
+            .iter()
+            .map(|&(col, coeff)| coeff * values[col] as f64)
+            .sum();
+
+        Ok(ApiSolution {
+            status,
+            objective: objective_value.round() as i32,
+            solution: to_api_values(&polyhedron.variables, values, dense),
+            error,
+        })
+    }
+
+    /// Get or build a cached model for the given polyhedron
+    ///
+    /// A `spare` checkout, made by parallel objective workers beyond the
+    /// first, may grow the cached pool to the request's `parallelism`.
+    fn obtain_model(
+        model_cache: &ModelCache<GlpkModel>,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
+        spare: Option<usize>,
+    ) -> Result<PooledModel<GlpkModel>, SolveInputError> {
+        let build = || metrics::timed(Phase::Build, || Self::build_model(polyhedron));
+        let key = fingerprint.structure();
+        let mut model = if let Some(parallelism) = spare {
+            model_cache.checkout_spare(key, parallelism, build)?
+        } else {
+            model_cache.checkout(key, build)?
+        };
+        Self::apply_bounds(&mut model, polyhedron)?;
+        Ok(model)
+    }
+
+    /// Solve on cached GLPK problems
+    fn solve_cached(
+        model_cache: &ModelCache<GlpkModel>,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
+        direction: SolverDirection,
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<(), SolveInputError> {
+        // The first model's column index validates and resolves the objectives
+        // before anything is solved; on a cache hit it is reused as-is
+        let first = Self::obtain_model(model_cache, &polyhedron, fingerprint, None)?;
+        let dense = objectives.is_indexed();
+        let objectives = first.columns.resolve(objectives)?;
+        let first = Mutex::new(Some(first));
+
+        let dir = match direction {
+            SolverDirection::Maximize => GLP_MAX,
+            SolverDirection::Minimize => GLP_MIN,
+        };
+        let deadline = options.limits.deadline();
+
+        parallel::for_each_claimed(
+            &objectives,
+            options.parallelism,
+            |_| match first.lock().take() {
+                Some(model) => Ok(model),
+                None => Self::obtain_model(
+                    model_cache,
+                    &polyhedron,
+                    fingerprint,
+                    Some(options.parallelism),
+                ),
+            },
+            |model, idx, objective| {
+                options.cancel.check()?;
+                let solution = match remaining(deadline) {
+                    Some(left) if left.is_zero() => {
+                        timed_out_solution(&polyhedron.variables, dense)
+                    }
+                    left => Self::solve_objective(
+                        model,
+                        &polyhedron,
+                        objective,
+                        dir,
+                        &options,
+                        left,
+                        dense,
+                    )?,
+                };
+                // A cancelled objective has no usable solution
+                options.cancel.check()?;
+                on_solution(idx, solution);
+                Ok(())
+            },
+        )
+    }
+
+    /// Solve with `solve_ilps`, rebuilding the GLPK problem for every chunk
+    fn solve_rebuilding(
+        polyhedron: SparseLEIntegerPolyhedron,
+        objectives: ApiObjectives,
+        direction: SolverDirection,
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<(), SolveInputError> {
+        // Validate objectives against variables
+        match &objectives {
+            ApiObjectives::Named(named) => validate_objectives_owned(&polyhedron.variables, named)?,
+            ApiObjectives::Indexed(indexed) => {
+                validate_objectives_indexed(polyhedron.variables.len(), indexed)?
+            }
+        }
+        let dense = objectives.is_indexed();
+        let objective_count = objectives.count();
+
+        // Move the request buffers into the GLPK polyhedron instead of copying them
+        let SparseLEIntegerPolyhedron { a, b, variables } = polyhedron;
+        let glpk_polyhedron = into_glpk_polyhedron(a, b, &variables);
+
+        let maximize = direction == SolverDirection::Maximize;
+        let deadline = options.limits.deadline();
+
+        // GLPK builds its problem inside `solve_ilps`, so objectives are solved
+        // in contiguous chunks, at most one per worker and never longer than
+        // MAX_CHUNK_LEN so solutions are handed out while later chunks still run.
+        // Each worker solves its chunks on its own GLPK copy of the polyhedron
+        let workers = options.parallelism.clamp(1, objective_count.max(1));
+        let chunk_len = objective_count.div_ceil(workers).clamp(1, MAX_CHUNK_LEN);
+        let chunks: Vec<Range<usize>> = (0..objective_count)
+            .step_by(chunk_len)
+            .map(|start| start..(start + chunk_len).min(objective_count))
+            .collect();
+        let workers = workers.min(chunks.len().max(1));
+
+        // The first worker takes the converted request, extra workers get copies
+        let copies: Vec<_> = metrics::timed(Phase::Build, || {
+            (1..workers)
+                .map(|_| copy_glpk_polyhedron(&glpk_polyhedron))
+                .collect()
+        });
+        let worker_polyhedra: Vec<Mutex<Option<_>>> = std::iter::once(glpk_polyhedron)
+            .chain(copies)
+            .map(|p| Mutex::new(Some(p)))
+            .collect();
+
+        parallel::for_each_claimed(
+            &chunks,
+            workers,
+            |worker| {
+                let polyhedron =
+                    worker_polyhedra[worker]
+                        .lock()
+                        .take()
+                        .ok_or_else(|| SolveInputError {
+                            details: "GLPK worker started twice".to_string(),
+                        })?;
+                Ok((polyhedron, ReleaseEnv))
+            },
+            |(mut_polyhedron, _), _, chunk| {
+                // `solve_ilps` runs to completion, so limits apply between chunks
+                options.cancel.check()?;
+                if remaining(deadline).is_some_and(|left| left.is_zero()) {
+                    for idx in chunk.clone() {
+                        on_solution(idx, timed_out_solution(&variables, dense));
+                    }
+                    return Ok(());
+                }
+
+                // Convert to borrowed objectives for GLPK
+                let borrowed_objectives: Vec<HashMap<&str, f64>> = match &objectives {
+                    ApiObjectives::Named(named) => named[chunk.clone()]
+                        .iter()
+                        .map(to_borrowed_objective)
+                        .collect(),
+                    ApiObjectives::Indexed(indexed) => indexed[chunk.clone()]
+                        .iter()
+                        .map(|obj| to_borrowed_indexed_objective(obj, &variables))
+                        .collect(),
+                };
+
+                // Call the GLPK library solver, which also builds the problem
+                let lib_solutions = metrics::timed(Phase::Solve, || {
+                    solve_ilps(
+                        mut_polyhedron,
+                        borrowed_objectives,
+                        maximize,
+                        options.use_presolve,
+                        NO_TERMINAL_OUTPUT,
+                    )
+                })?;
+
+                // Convert GLPK solutions to API solutions
+                for (offset, solution) in lib_solutions.into_iter().enumerate() {
+                    on_solution(
+                        chunk.start + offset,
+                        from_glpk_solution(solution, &variables, dense),
+                    );
+                }
+                Ok::<_, SolveInputError>(())
+            },
+        )
+    }
+}
+
+/// Branch-and-cut callback stopping the search once the solve is cancelled.
+///
+/// `info` is the `AtomicBool` of the solve's `CancelToken`.
+unsafe extern "C" fn terminate_if_cancelled(tree: *mut c_void, info: *mut c_void) {
+    if (*(info as *const AtomicBool)).load(Ordering::Relaxed) {
+        glp_ios_terminate(tree);
+    }
+}
+
+/// Create a GLPK problem with rows `b`, columns `bounds` and the 1-based
+/// coordinate entries `ia`, `ja`, `ar` (index 0 unused), or `None` if GLPK
+/// could not allocate it
+unsafe fn load_problem(
+    b: &[i32],
+    bounds: &[(i32, i32)],
+    ia: &[i32],
+    ja: &[i32],
+    ar: &[f64],
+) -> Option<GlpkProblem> {
+    let prob = glp_create_prob();
+    if prob.is_null() {
+        return None;
+    }
+    glp_term_out(GLP_OFF);
+
+    // Ax <= b, with one free empty row for polyhedra without rows
+    glp_add_rows(prob, b.len().max(1) as i32);
+    if b.is_empty() {
+        glp_set_row_bnds(prob, 1, GLP_FR, 0.0, 0.0);
+    }
+    for (i, &b) in b.iter().enumerate() {
+        glp_set_row_bnds(prob, i as i32 + 1, GLP_UP, 0.0, b as f64);
+    }
+
+    if !bounds.is_empty() {
+        glp_add_cols(prob, bounds.len() as i32);
+    }
+    for (j, &bound) in bounds.iter().enumerate() {
+        set_col_bounds(prob, j, bound);
+        glp_set_col_kind(prob, j as i32 + 1, GLP_IV);
+    }
+
+    glp_load_matrix(
+        prob,
+        ia.len() as i32 - 1,
+        ia.as_ptr(),
+        ja.as_ptr(),
+        ar.as_ptr(),
+    );
+    Some(GlpkProblem {
+        prob,
+        costed: Vec::new(),
+    })
+}
+
+/// Set the bounds of 0-based column `col`, fixing it when both are equal
+unsafe fn set_col_bounds(prob: *mut glp_prob, col: usize, (lower, upper): (i32, i32)) {
+    let kind = if lower == upper { GLP_FX } else { GLP_DB };
+    glp_set_col_bnds(prob, col as i32 + 1, kind, lower as f64, upper as f64);
 }
 
 impl Solver for GlpkSolver {
-    fn solve(
+    fn solve_each(
         &self,
-        polyhedron: SparseLEIntegerPolyhedron,
-        objectives: Vec<HashMap<String, f64>>,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
         direction: SolverDirection,
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<(), SolveInputError> {
+        match &self.model_cache {
+            Some(model_cache) => Self::solve_cached(
+                model_cache,
+                polyhedron,
+                fingerprint,
+                objectives,
+                direction,
+                options,
+                on_solution,
+            ),
+            None => Self::solve_rebuilding(
+                Arc::unwrap_or_clone(polyhedron),
+                objectives,
+                direction,
+                options,
+                on_solution,
+            ),
+        }
+    }
+
+    fn warm(
+        &self,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
         _use_presolve: bool,
-    ) -> Result<Vec<ApiSolution>, SolveInputError> {
-        let glpk_polyhedron = to_glpk_polyhedron(&polyhedron);
+    ) -> Result<(), SolveInputError> {
+        if let Some(model_cache) = &self.model_cache {
+            Self::obtain_model(model_cache, polyhedron, fingerprint, None)?;
+        }
+        Ok(())
+    }
 
-        // Validate objectives against variables
-        validate_objectives_owned(&glpk_polyhedron.variables, &objectives)?;
+    fn cached_models(&self) -> Vec<Fingerprint> {
+        self.model_cache
+            .as_ref()
+            .map_or_else(Vec::new, ModelCache::fingerprints)
+    }
+
+    fn pin(&self, fingerprint: Fingerprint) {
+        if let Some(model_cache) = &self.model_cache {
+            model_cache.pin(fingerprint.structure());
+        }
+    }
+
+    fn unpin(&self, fingerprint: Fingerprint) {
+        if let Some(model_cache) = &self.model_cache {
+            model_cache.unpin(fingerprint.structure());
+        }
+    }
+
+    fn name(&self) -> &str {
+        "GLPK"
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::{ApiIntegerSparseMatrix, ApiShape, ApiValues, ApiVariable};
+
+    fn create_test_polyhedron() -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0, 0, 1],
+                cols: vec![0, 1, 1],
+                vals: vec![1, 2, 1],
+                shape: ApiShape { nrows: 2, ncols: 2 },
+            },
+            b: vec![10, 5],
+            variables: vec![
+                ApiVariable {
+                    id: "x".to_string(),
+                    bound: (0, 10),
+                },
+                ApiVariable {
+                    id: "y".to_string(),
+                    bound: (0, 10),
+                },
+            ],
+        }
+    }
 
-        // Convert to borrowed objectives for GLPK
-        let borrowed_objectives: Vec<HashMap<&str, f64>> = objectives
+    fn objectives(solver: &GlpkSolver, direction: SolverDirection, presolve: bool) -> Vec<i32> {
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+        solver
+            .solve(
+                Arc::new(polyhedron),
+                fingerprint,
+                ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(1, 1.0)], vec![(0, 1.0)]]),
+                direction,
+                SolveOptions {
+                    use_presolve: presolve,
+                    ..SolveOptions::default()
+                },
+            )
+            .ok()
+            .unwrap()
             .iter()
-            .map(|obj| to_borrowed_objective(obj))
-            .collect();
+            .map(|s| s.objective)
+            .collect()
+    }
 
-        let maximize = direction == SolverDirection::Maximize;
+    #[test]
+    fn test_cached_model_is_reused_across_objectives_and_directions() {
+        let solver = GlpkSolver::with_cache_size(Some(4));
+        for presolve in [false, true] {
+            assert_eq!(
+                objectives(&solver, SolverDirection::Maximize, presolve),
+                vec![10, 5, 10]
+            );
+            assert_eq!(
+                objectives(&solver, SolverDirection::Minimize, presolve),
+                vec![0, 0, 0]
+            );
+        }
+    }
 
-        // Solver expects &mut
-        let mut mut_polyhedron = glpk_polyhedron;
+    #[test]
+    fn test_cached_and_uncached_solutions_match() {
+        let cached = GlpkSolver::with_cache_size(Some(4));
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+        let solve = |solver: &GlpkSolver| {
+            solver
+                .solve(
+                    Arc::new(polyhedron.clone()),
+                    fingerprint,
+                    ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(1, 1.0)]]),
+                    SolverDirection::Maximize,
+                    SolveOptions::default(),
+                )
+                .ok()
+                .unwrap()
+        };
 
-        // Call the GLPK library solver
-        let lib_solutions = solve_ilps(
-            &mut mut_polyhedron,
-            borrowed_objectives,
-            maximize,
-            _use_presolve,
-            NO_TERMINAL_OUTPUT,
-        )?;
+        let uncached = solve(&GlpkSolver::without_cache());
+        for solutions in [solve(&cached), solve(&cached)] {
+            assert_eq!(solutions[0].solution, ApiValues::Dense(vec![10, 0]));
+            assert_eq!(solutions[1].solution, ApiValues::Dense(vec![0, 5]));
+            for (cached, uncached) in solutions.iter().zip(&uncached) {
+                assert_eq!(cached.objective, uncached.objective);
+                assert_eq!(cached.solution, uncached.solution);
+            }
+        }
+    }
 
-        // Convert GLPK solutions to API solutions
-        let api_solutions: Vec<ApiSolution> = lib_solutions.into_iter().map(|s| s.into()).collect();
+    #[test]
+    fn test_cached_model_follows_changed_rhs_and_bounds() {
+        let solver = GlpkSolver::with_cache_size(Some(4));
+        let solve = |polyhedron: SparseLEIntegerPolyhedron| {
+            let fingerprint = Fingerprint::of(&polyhedron);
+            solver
+                .solve(
+                    Arc::new(polyhedron),
+                    fingerprint,
+                    ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(1, 1.0)]]),
+                    SolverDirection::Maximize,
+                    SolveOptions::default(),
+                )
+                .ok()
+                .unwrap()
+                .iter()
+                .map(|s| s.objective)
+                .collect::<Vec<_>>()
+        };
 
-        Ok(api_solutions)
+        assert_eq!(solve(create_test_polyhedron()), vec![10, 5]);
+        let mut changed = create_test_polyhedron();
+        changed.b[0] = 4;
+        changed.variables[1].bound = (0, 1);
+        assert_eq!(solve(changed), vec![4, 1]);
+        // And back again on the same cached problem
+        assert_eq!(solve(create_test_polyhedron()), vec![10, 5]);
+        assert_eq!(solver.cached_models().len(), 1);
     }
 
-    fn name(&self) -> &str {
-        "GLPK"
+    #[test]
+    fn test_cached_models_are_shared_across_threads() {
+        let solver = GlpkSolver::with_cache_config(Some(ModelCacheConfig {
+            capacity: 4,
+            replicas_per_model: 2,
+            budget_bytes: None,
+        }));
+        std::thread::scope(|scope| {
+            for _ in 0..4 {
+                scope.spawn(|| {
+                    for _ in 0..8 {
+                        let polyhedron = create_test_polyhedron();
+                        let fingerprint = Fingerprint::of(&polyhedron);
+                        let solutions = solver
+                            .solve(
+                                Arc::new(polyhedron),
+                                fingerprint,
+                                ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(1, 1.0)]]),
+                                SolverDirection::Maximize,
+                                SolveOptions {
+                                    parallelism: 2,
+                                    ..SolveOptions::default()
+                                },
+                            )
+                            .ok()
+                            .unwrap();
+                        let objectives: Vec<i32> = solutions.iter().map(|s| s.objective).collect();
+                        assert_eq!(objectives, vec![10, 5]);
+                    }
+                });
+            }
+        });
+        assert_eq!(solver.cached_models().len(), 1);
+    }
+
+    #[test]
+    fn test_cached_model_without_rows() {
+        let solver = GlpkSolver::with_cache_size(Some(4));
+        let polyhedron = SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![],
+                cols: vec![],
+                vals: vec![],
+                shape: ApiShape { nrows: 0, ncols: 1 },
+            },
+            b: vec![],
+            variables: vec![ApiVariable {
+                id: "x".to_string(),
+                bound: (0, 3),
+            }],
+        };
+        let fingerprint = Fingerprint::of(&polyhedron);
+        let solutions = solver
+            .solve(
+                Arc::new(polyhedron),
+                fingerprint,
+                ApiObjectives::Indexed(vec![vec![(0, 1.0)]]),
+                SolverDirection::Maximize,
+                SolveOptions::default(),
+            )
+            .ok()
+            .unwrap();
+        assert_eq!(solutions[0].objective, 3);
+    }
+
+    #[test]
+    fn test_limits_and_cancellation() {
+        use crate::domain::solver::{CancelToken, SolveLimits};
+        use std::time::Duration;
+
+        for solver in [
+            GlpkSolver::without_cache(),
+            GlpkSolver::with_cache_size(Some(4)),
+        ] {
+            let solve = |time_limit: Duration, cancel: CancelToken| {
+                let polyhedron = create_test_polyhedron();
+                let fingerprint = Fingerprint::of(&polyhedron);
+                solver.solve(
+                    Arc::new(polyhedron),
+                    fingerprint,
+                    ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(1, 1.0)]]),
+                    SolverDirection::Maximize,
+                    SolveOptions {
+                        limits: SolveLimits {
+                            time_limit: Some(time_limit),
+                            mip_gap: Some(0.0),
+                        },
+                        cancel,
+                        ..SolveOptions::default()
+                    },
+                )
+            };
+
+            let solutions = solve(Duration::from_secs(60), CancelToken::default())
+                .ok()
+                .unwrap();
+            assert!(solutions
+                .iter()
+                .all(|s| matches!(s.status, Status::Optimal)));
+
+            // Objectives reached after the time limit are not solved
+            let solutions = solve(Duration::ZERO, CancelToken::default()).ok().unwrap();
+            assert!(solutions
+                .iter()
+                .all(|s| matches!(s.status, Status::TimeLimit) && s.objective == 0));
+
+            let cancel = CancelToken::default();
+            cancel.cancel();
+            assert!(solve(Duration::from_secs(60), cancel).is_err());
+        }
     }
 }
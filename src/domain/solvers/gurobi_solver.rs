@@ -1,53 +1,217 @@
-use crate::convert::to_glpk_polyhedron;
-use crate::domain::solver::Solver;
-use crate::domain::validate::{validate_objectives_owned, SolveInputError};
-use crate::models::{ApiSolution, SolverDirection, SparseLEIntegerPolyhedron, Status};
-use std::collections::HashMap;
+use crate::convert::{timed_out_solution, to_api_values, to_column_values};
+use crate::domain::bounds::ModelBounds;
+use crate::domain::columns::{ColumnIndex, SparseObjective};
+use crate::domain::fingerprint::Fingerprint;
+use crate::domain::model_cache::{ModelCache, ModelCacheConfig, ModelPool, PooledModel};
+use crate::domain::parallel;
+use crate::domain::solver::{remaining, CancelToken, SolutionSink, SolveOptions, Solver};
+use crate::domain::sparse;
+use crate::domain::validate::SolveInputError;
+use crate::metrics::{self, Phase};
+use crate::models::{
+    ApiObjectives, ApiSolution, SolverDirection, SparseLEIntegerPolyhedron, Status,
+};
+use std::mem::ManuallyDrop;
+use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::Arc;
+use std::time::Duration;
 
+use grb::callback::{CbResult, Where};
+use grb::expr::LinExpr;
 use grb::prelude::*;
-use lru::LruCache;
-use parking_lot::Mutex;
-use std::num::NonZeroUsize;
+use parking_lot::{Condvar, Mutex};
+
+/// `GRB_INFINITY`, the default `TimeLimit`
+const GUROBI_INFINITY: f64 = 1e100;
+/// Gurobi default of `MIPGap`, restored on cached models without a gap
+const GUROBI_DEFAULT_MIP_GAP: f64 = 1e-4;
 
 /// Cached Gurobi model structure
 struct GurobiModel {
-    model: Model,
+    /// Freed under a lease of `env` when the model is dropped
+    model: ManuallyDrop<Model>,
+    /// Environment the model was created from
+    env: Arc<SharedEnv>,
     vars: Vec<Var>,
+    /// Constraint of every row, `None` for rows without coefficients
+    constrs: Vec<Option<Constr>>,
+    /// Columns with a non-zero cost from the last objective
+    costed: Vec<usize>,
+    columns: ColumnIndex,
+    bounds: ModelBounds,
 }
 
-// SAFETY: Gurobi model is properly synchronized through Arc and Mutex
-// Each model instance is only accessed by one thread at a time
+// SAFETY: Gurobi models are only reached through a `ModelPool`, which hands
+// each replica out to exactly one `PooledModel` guard at a time, and are
+// only used while their environment is leased
 unsafe impl Send for GurobiModel {}
 unsafe impl Sync for GurobiModel {}
 
+impl Drop for GurobiModel {
+    fn drop(&mut self) {
+        // Freeing a model uses its environment as well
+        let _lease = self.env.lease();
+        // SAFETY: the model is not used after this
+        unsafe { ManuallyDrop::drop(&mut self.model) };
+    }
+}
+
+/// A Gurobi environment and the models created from it.
+///
+/// Gurobi environments are not thread-safe, and models created from one
+/// environment must not be used from different threads at the same time,
+/// so an environment and its models are only used under an `EnvLease`.
+struct SharedEnv {
+    env: Env,
+    leased: Mutex<bool>,
+    released: Condvar,
+}
+
+// SAFETY: the environment and its models are only used while leased
+unsafe impl Send for SharedEnv {}
+unsafe impl Sync for SharedEnv {}
+
+impl SharedEnv {
+    fn new() -> Result<Self, SolveInputError> {
+        let mut env = Env::new("").map_err(|e| SolveInputError {
+            details: format!("Failed to create Gurobi environment: {}", e),
+        })?;
+
+        // Disable Gurobi console output
+        env.set(param::OutputFlag, 0).map_err(|e| SolveInputError {
+            details: format!("Failed to set Gurobi output flag: {}", e),
+        })?;
+        Ok(SharedEnv {
+            env,
+            leased: Mutex::new(false),
+            released: Condvar::new(),
+        })
+    }
+
+    /// Wait until the environment is free and lease it
+    fn lease(self: &Arc<Self>) -> EnvLease {
+        let mut leased = self.leased.lock();
+        while *leased {
+            self.released.wait(&mut leased);
+        }
+        *leased = true;
+        EnvLease(Arc::clone(self))
+    }
+
+    /// Lease the environment if it is free
+    fn try_lease(self: &Arc<Self>) -> Option<EnvLease> {
+        let mut leased = self.leased.lock();
+        if *leased {
+            return None;
+        }
+        *leased = true;
+        Some(EnvLease(Arc::clone(self)))
+    }
+}
+
+/// Exclusive use of a `SharedEnv` and every model created from it
+struct EnvLease(Arc<SharedEnv>);
+
+impl EnvLease {
+    fn new_model(&self) -> Result<Model, SolveInputError> {
+        Model::with_env("optimization", &self.0.env).map_err(|e| SolveInputError {
+            details: format!("Failed to create Gurobi model: {}", e),
+        })
+    }
+}
+
+impl Drop for EnvLease {
+    fn drop(&mut self) {
+        *self.0.leased.lock() = false;
+        self.0.released.notify_one();
+    }
+}
+
+/// The environments models are created from, one per solver slot.
+///
+/// Creating an environment checks out a license, so this happens once per
+/// solver instead of once per model. New models go to a free environment
+/// where there is one, so concurrent solves rarely wait for each other.
+struct EnvPool {
+    envs: Vec<Arc<SharedEnv>>,
+    next: AtomicUsize,
+}
+
+impl EnvPool {
+    fn new(size: usize) -> Result<Self, SolveInputError> {
+        Ok(EnvPool {
+            envs: (0..size.max(1))
+                .map(|_| SharedEnv::new().map(Arc::new))
+                .collect::<Result<_, _>>()?,
+            next: AtomicUsize::new(0),
+        })
+    }
+
+    /// Lease the first free environment, or wait for the next one in turn
+    fn lease(&self) -> EnvLease {
+        let start = self.next.fetch_add(1, Ordering::Relaxed);
+        let count = self.envs.len();
+        (0..count)
+            .find_map(|i| self.envs[(start + i) % count].try_lease())
+            .unwrap_or_else(|| self.envs[start % count].lease())
+    }
+}
+
+/// A checked-out replica together with the lease of its environment.
+///
+/// The lease is declared first so it is released before the replica goes
+/// back to its pool, or is freed.
+struct LeasedModel {
+    _lease: EnvLease,
+    replica: PooledModel<GurobiModel>,
+}
+
+impl LeasedModel {
+    /// The replica without the lease, e.g. to hand it to another thread
+    fn into_replica(self) -> PooledModel<GurobiModel> {
+        self.replica
+    }
+}
+
 /// Gurobi solver implementation with model caching
 ///
 /// This implementation includes model caching:
-/// - Models are cached based on polyhedron hash
-/// - LRU eviction policy when cache is full
+/// - Models are cached based on the polyhedron's matrix structure; `b` and
+///   variable bounds of a cached model are updated in place when they differ
+/// - GDSF eviction when the cache is full, counting every replica
 /// - Reuses cached models across multiple objectives
-/// - Thread-safe via parking_lot::Mutex
+/// - Each cached polyhedron holds a bounded pool of independent replicas,
+///   so concurrent requests for the same polyhedron solve in parallel
 pub struct GurobiSolver {
-    model_cache: Option<Arc<Mutex<LruCache<SparseLEIntegerPolyhedron, Arc<Mutex<GurobiModel>>>>>>,
+    envs: EnvPool,
+    model_cache: Option<ModelCache<GurobiModel>>,
 }
 
 impl GurobiSolver {
     /// Create a new Gurobi solver with specified cache size
-    pub fn with_cache_size(size: Option<usize>) -> Self {
-        match size {
-            Some(0) | None => Self::without_cache(),
-            Some(s) => GurobiSolver {
-                model_cache: Some(Arc::new(Mutex::new(LruCache::new(
-                    NonZeroUsize::new(s).unwrap(),
-                )))),
-            },
-        }
+    pub fn with_cache_size(size: Option<usize>, slots: usize) -> Result<Self, SolveInputError> {
+        Self::with_cache_config(size.map(ModelCacheConfig::with_capacity), slots)
+    }
+
+    /// Create a new Gurobi solver with the given cache sizing and one
+    /// environment for each of `slots` concurrent solves
+    ///
+    /// Fails if no Gurobi environment can be created (e.g. no license).
+    pub fn with_cache_config(
+        config: Option<ModelCacheConfig>,
+        slots: usize,
+    ) -> Result<Self, SolveInputError> {
+        Ok(GurobiSolver {
+            envs: EnvPool::new(slots)?,
+            model_cache: config
+                .filter(|config| config.capacity > 0)
+                .map(ModelCache::new),
+        })
     }
 
     /// Create solver with caching disabled
-    pub fn without_cache() -> Self {
-        GurobiSolver { model_cache: None }
+    pub fn without_cache(slots: usize) -> Result<Self, SolveInputError> {
+        Self::with_cache_config(None, slots)
     }
 
     /// Convert Gurobi status to our API status
@@ -56,66 +220,49 @@ impl GurobiSolver {
             grb::Status::Optimal => Status::Optimal,
             grb::Status::Infeasible => Status::Infeasible,
             grb::Status::InfOrUnbd | grb::Status::Unbounded => Status::Unbounded,
+            grb::Status::TimeLimit => Status::TimeLimit,
             _ => Status::Undefined,
         }
     }
 
     /// Build a new Gurobi model for the given polyhedron
     fn build_model(
+        &self,
         polyhedron: &SparseLEIntegerPolyhedron,
         use_presolve: bool,
-    ) -> Result<Arc<Mutex<GurobiModel>>, SolveInputError> {
-        // Create Gurobi environment
-        let mut env = Env::new("").map_err(|e| SolveInputError {
-            details: format!("Failed to create Gurobi environment: {}", e),
-        })?;
-
-        // Disable Gurobi console output
-        env.set(param::OutputFlag, 0).map_err(|e| SolveInputError {
-            details: format!("Failed to set Gurobi output flag: {}", e),
-        })?;
-
-        // Use all available threads
-        env.set(param::Threads, 0).map_err(|e| SolveInputError {
-            details: format!("Failed to set Gurobi thread count: {}", e),
-        })?;
+    ) -> Result<GurobiModel, SolveInputError> {
+        let lease = self.envs.lease();
+        let mut model = lease.new_model()?;
 
         // Configure presolve: -1 = auto, 0 = off, 1 = conservative, 2 = aggressive
-        env.set(param::Presolve, if use_presolve { -1 } else { 0 })
+        model
+            .set_param(param::Presolve, if use_presolve { -1 } else { 0 })
             .map_err(|e| SolveInputError {
                 details: format!("Failed to set Gurobi presolve: {}", e),
             })?;
 
-        // Create a Gurobi model
-        let mut model = Model::with_env("optimization", &env).map_err(|e| SolveInputError {
-            details: format!("Failed to create Gurobi model: {}", e),
-        })?;
-
-        // Add variables
-        let mut vars: Vec<Var> = Vec::new();
-        for var in polyhedron.variables.iter() {
+        // Add all columns without names, queued by Gurobi until the update
+        let mut vars = Vec::with_capacity(polyhedron.variables.len());
+        for var in &polyhedron.variables {
             let (lower, upper) = var.bound;
-
             // Use binary variables for [0,1] bounds
-            let gurobi_var = if lower == 0 && upper == 1 {
-                add_binvar!(
-                    model,
-                    name: &var.id
-                )
-                .map_err(|e| SolveInputError {
-                    details: format!("Failed to add binary variable: {}", e),
-                })?
+            let vtype = if lower == 0 && upper == 1 {
+                VarType::Binary
             } else {
-                add_intvar!(
-                    model,
-                    name: &var.id,
-                    bounds: lower as f64..upper as f64
+                VarType::Integer
+            };
+            let gurobi_var = model
+                .add_var(
+                    "",
+                    vtype,
+                    0.0,
+                    lower as f64,
+                    upper as f64,
+                    std::iter::empty(),
                 )
                 .map_err(|e| SolveInputError {
-                    details: format!("Failed to add integer variable: {}", e),
-                })?
-            };
-
+                    details: format!("Failed to add variable: {}", e),
+                })?;
             vars.push(gurobi_var);
         }
 
@@ -123,180 +270,384 @@ impl GurobiSolver {
             details: format!("Failed to update model after adding variables: {}", e),
         })?;
 
-        // Build sparse matrix structure
-        let n_rows = polyhedron.a.shape.nrows;
-        let n_cols = polyhedron.a.shape.ncols;
-        let mut row_data: Vec<Vec<(usize, f64)>> = vec![Vec::new(); n_rows];
+        // Add all constraints (Ax <= b) in one call, from the flat row-major
+        // (CSR) form of A, as linear expressions without names
+        let (rows, ineqs): (Vec<usize>, Vec<_>) = sparse::with_csr(&polyhedron.a, |csr| {
+            (0..csr.major_len())
+                .filter_map(|row_idx| {
+                    let (cols, coeffs) = csr.slice(row_idx);
+                    if cols.is_empty() {
+                        return None;
+                    }
+                    let rhs = polyhedron.b.get(row_idx).copied().unwrap_or(0) as f64;
+                    let mut expr = LinExpr::new();
+                    for (&col_idx, &coeff) in cols.iter().zip(coeffs) {
+                        expr.add_term(coeff, vars[col_idx as usize]);
+                    }
+                    Some((row_idx, c!(expr <= rhs)))
+                })
+                .unzip()
+        });
+        let added = model
+            .add_constrs(ineqs.into_iter().map(|ineq| (&"", ineq)))
+            .map_err(|e| SolveInputError {
+                details: format!("Failed to add constraints: {}", e),
+            })?;
+        let mut constrs = vec![None; polyhedron.b.len()];
+        for (row_idx, constr) in rows.into_iter().zip(added) {
+            constrs[row_idx] = Some(constr);
+        }
 
-        for i in 0..polyhedron.a.rows.len() {
-            let row = polyhedron.a.rows[i] as usize;
-            let col = polyhedron.a.cols[i] as usize;
-            let val = polyhedron.a.vals[i] as f64;
+        model.update().map_err(|e| SolveInputError {
+            details: format!("Failed to update model after adding constraints: {}", e),
+        })?;
 
-            if row < n_rows && col < n_cols {
-                row_data[row].push((col, val));
-            }
-        }
+        Ok(GurobiModel {
+            model: ManuallyDrop::new(model),
+            env: Arc::clone(&lease.0),
+            vars,
+            constrs,
+            costed: Vec::new(),
+            columns: ColumnIndex::new(&polyhedron.variables),
+            bounds: ModelBounds::new(polyhedron),
+        })
+    }
 
-        // Add constraints (Ax <= b)
-        for (row_idx, entries) in row_data.iter().enumerate() {
-            if entries.is_empty() {
-                continue;
-            }
+    /// Apply the `b` and bounds of `polyhedron` to a cached model of the same structure
+    fn apply_bounds(
+        replica: &mut GurobiModel,
+        polyhedron: &SparseLEIntegerPolyhedron,
+    ) -> Result<(), SolveInputError> {
+        // Recorded only once every update succeeded, so a replica left half
+        // updated is patched again in full by its next checkout
+        let changes = replica.bounds.changes(polyhedron);
+        if changes.is_empty() {
+            return Ok(());
+        }
+        let failed = |e: grb::Error| SolveInputError {
+            details: format!("Failed to update bounds: {}", e),
+        };
 
-            let rhs = polyhedron.b.get(row_idx).copied().unwrap_or(0) as f64;
+        let rhs = changes.rows.iter().filter_map(|&row| {
+            replica.constrs[row].map(|constr| (constr, polyhedron.b[row] as f64))
+        });
+        replica
+            .model
+            .set_obj_attr_batch(attr::RHS, rhs.collect::<Vec<_>>())
+            .map_err(failed)?;
+
+        // Variables added as binary become general integers once their
+        // bounds leave [0, 1]; integer with [0, 1] bounds is equivalent
+        let vars: Vec<(Var, (i32, i32))> = changes
+            .cols
+            .iter()
+            .map(|&col| (replica.vars[col], polyhedron.variables[col].bound))
+            .collect();
+        let model = &mut replica.model;
+        model
+            .set_obj_attr_batch(
+                attr::VType,
+                vars.iter().map(|&(var, _)| (var, VarType::Integer)),
+            )
+            .map_err(failed)?;
+        model
+            .set_obj_attr_batch(
+                attr::LB,
+                vars.iter().map(|&(var, (lb, _))| (var, lb as f64)),
+            )
+            .map_err(failed)?;
+        model
+            .set_obj_attr_batch(
+                attr::UB,
+                vars.iter().map(|&(var, (_, ub))| (var, ub as f64)),
+            )
+            .map_err(failed)?;
+        model.update().map_err(failed)?;
+        replica.bounds.commit(polyhedron, &changes);
+        Ok(())
+    }
 
-            // Build linear expression
-            let expr = entries
-                .iter()
-                .fold(Expr::Constant(0.0), |acc, &(col_idx, coeff)| {
-                    acc + coeff * vars[col_idx]
-                });
+    /// Set the time limit, MIP gap and thread count of the next optimization.
+    ///
+    /// Parameters stay on a cached model, so unset limits restore the defaults.
+    fn apply_limits(
+        replica: &mut GurobiModel,
+        options: &SolveOptions,
+        time_left: Option<Duration>,
+    ) -> Result<(), SolveInputError> {
+        let failed = |e: grb::Error| SolveInputError {
+            details: format!("Failed to set solve limits: {}", e),
+        };
+        let time_limit = time_left.map_or(GUROBI_INFINITY, |left| left.as_secs_f64());
+        let mip_gap = options.limits.mip_gap.unwrap_or(GUROBI_DEFAULT_MIP_GAP);
+        replica
+            .model
+            .set_param(param::TimeLimit, time_limit)
+            .map_err(failed)?;
+        replica
+            .model
+            .set_param(param::MIPGap, mip_gap)
+            .map_err(failed)?;
+        // 0 lets Gurobi use every core
+        replica
+            .model
+            .set_param(param::Threads, options.threads as i32)
+            .map_err(failed)
+    }
 
-            let constraint_name = format!("c{}", row_idx);
-            model
-                .add_constr(&constraint_name, c!(expr <= rhs))
+    /// Solve a single objective on a checked-out replica by replacing its objective.
+    ///
+    /// `start`, when set, is loaded into the `Start` attribute of the variables
+    /// and is replaced by this objective's incumbent for the next call.
+    /// A callback terminates the optimization once `cancel` is set.
+    /// `dense` returns the values in variable order instead of keyed by id.
+    fn solve_objective(
+        replica: &mut GurobiModel,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        objective: &SparseObjective,
+        sense: ModelSense,
+        start: &mut Option<Vec<f64>>,
+        cancel: &CancelToken,
+        dense: bool,
+    ) -> std::result::Result<ApiSolution, SolveInputError> {
+        if let Some(values) = start.take().filter(|v| v.len() == replica.vars.len()) {
+            replica
+                .model
+                .set_obj_attr_batch(attr::Start, replica.vars.iter().copied().zip(values))
                 .map_err(|e| SolveInputError {
-                    details: format!("Failed to add constraint: {}", e),
+                    details: format!("Failed to set MIP start: {}", e),
                 })?;
         }
 
-        model.update().map_err(|e| SolveInputError {
-            details: format!("Failed to update model after adding constraints: {}", e),
+        // Replace the previous objective's costs through the `Obj` attribute
+        let failed = |e: grb::Error| SolveInputError {
+            details: format!("Failed to set objective: {}", e),
+        };
+        let vars = &replica.vars;
+        let model = &mut replica.model;
+        model
+            .set_obj_attr_batch(
+                attr::Obj,
+                replica.costed.iter().map(|&col| (vars[col], 0.0)),
+            )
+            .map_err(failed)?;
+        model
+            .set_obj_attr_batch(
+                attr::Obj,
+                objective.iter().map(|&(col, coeff)| (vars[col], coeff)),
+            )
+            .map_err(failed)?;
+        model.set_attr(attr::ModelSense, sense).map_err(failed)?;
+        replica.costed.clear();
+        replica.costed.extend(objective.iter().map(|&(col, _)| col));
+
+        // Optimize
+        let mut interrupt = |w: Where| -> CbResult {
+            if cancel.is_cancelled() {
+                match w {
+                    Where::Polling(ctx) => ctx.terminate(),
+                    Where::Simplex(ctx) => ctx.terminate(),
+                    Where::Barrier(ctx) => ctx.terminate(),
+                    Where::MIP(ctx) => ctx.terminate(),
+                    Where::MIPSol(ctx) => ctx.terminate(),
+                    Where::MIPNode(ctx) => ctx.terminate(),
+                    _ => (),
+                }
+            }
+            Ok(())
+        };
+        metrics::timed(Phase::Solve, || {
+            replica.model.optimize_with_callback(&mut interrupt)
+        })
+        .map_err(|e| SolveInputError {
+            details: format!("Failed to optimize: {}", e),
+        })?;
+
+        // Extract solution
+        let model_status = replica.model.status().map_err(|e| SolveInputError {
+            details: format!("Failed to get model status: {}", e),
         })?;
+        let status = Self::convert_status(model_status);
+
+        // Read the solution in variable order
+        let mut values = Vec::with_capacity(polyhedron.variables.len());
+        for (idx, var) in polyhedron.variables.iter().enumerate() {
+            let (lower, upper) = var.bound;
+
+            // Get solution value, or use fixed value if variable was eliminated by presolve
+            let value = replica
+                .model
+                .get_obj_attr(attr::X, &replica.vars[idx])
+                .unwrap_or_else(|_| {
+                    // If variable is fixed (lower == upper), use the fixed value
+                    if lower == upper {
+                        lower as f64
+                    } else {
+                        0.0
+                    }
+                });
+
+            values.push(value.round());
+        }
 
-        Ok(Arc::new(Mutex::new(GurobiModel { model, vars })))
+        // Calculate objective value
+        let objective_value: f64 = objective
+            .iter()
+            .map(|&(col, coeff)| coeff * values[col])
+            .sum();
+
+        let rounded: Vec<i32> = values.iter().map(|&v| v as i32).collect();
+
+        // Keep the incumbent, if any, as start for the next objective
+        let solutions_found = replica.model.get_attr(attr::SolCount).unwrap_or(0);
+        if solutions_found > 0 {
+            *start = Some(values);
+        }
+
+        Ok(ApiSolution {
+            status,
+            objective: objective_value.round() as i32,
+            solution: to_api_values(&polyhedron.variables, rounded, dense),
+            error: None,
+        })
     }
 
-    /// Get or build a model for the given polyhedron
+    /// Get or build a model for the given polyhedron, leasing its environment
+    ///
+    /// A `spare` checkout, made by parallel objective workers beyond the
+    /// first, may grow the cached pool to the request's `parallelism`.
     fn obtain_model(
         &self,
         polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
         use_presolve: bool,
-    ) -> Result<Arc<Mutex<GurobiModel>>, SolveInputError> {
-        match &self.model_cache {
-            Some(some_model_cache) => {
-                // Check cache first
-                {
-                    let mut cache = some_model_cache.lock();
-                    if let Some(cached_model) = cache.get(polyhedron) {
-                        return Ok(Arc::clone(cached_model));
-                    }
-                }
-
-                // Not in cache, build new model
-                let model = Self::build_model(polyhedron, use_presolve)?;
-
-                // Store in cache
-                {
-                    let mut cache = some_model_cache.lock();
-                    cache.put(polyhedron.clone(), Arc::clone(&model));
-                }
-
-                Ok(model)
-            }
-            None => {
-                // Cache disabled, always build new model
-                Self::build_model(polyhedron, use_presolve)
+        spare: Option<usize>,
+    ) -> Result<LeasedModel, SolveInputError> {
+        let build = || metrics::timed(Phase::Build, || self.build_model(polyhedron, use_presolve));
+        let key = fingerprint.structure();
+        let mut replica = match (&self.model_cache, spare) {
+            (Some(model_cache), None) => model_cache.checkout(key, build)?,
+            (Some(model_cache), Some(parallelism)) => {
+                model_cache.checkout_spare(key, parallelism, build)?
             }
-        }
+            // Cache disabled, always build new model
+            (None, _) => Arc::new(ModelPool::new(1)).checkout(build)?,
+        };
+        let lease = replica.env.lease();
+        Self::apply_bounds(&mut replica, polyhedron)?;
+        Ok(LeasedModel {
+            _lease: lease,
+            replica,
+        })
     }
 }
 
 impl Solver for GurobiSolver {
-    fn solve(
+    fn solve_each(
         &self,
-        polyhedron: SparseLEIntegerPolyhedron,
-        objectives: Vec<HashMap<String, f64>>,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
         direction: SolverDirection,
-        use_presolve: bool,
-    ) -> std::result::Result<Vec<ApiSolution>, SolveInputError> {
-        // Use GLPK polyhedron for validation
-        let glpk_polyhedron = to_glpk_polyhedron(&polyhedron);
-        validate_objectives_owned(&glpk_polyhedron.variables, &objectives)?;
-
-        // Get or build cached model
-        let cached_model = self.obtain_model(&polyhedron, use_presolve)?;
-        let mut model_lock = cached_model.lock();
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> std::result::Result<(), SolveInputError> {
+        // The first replica's column index validates and resolves the
+        // objectives before anything is solved; on a cache hit it is reused as-is
+        let first = self.obtain_model(&polyhedron, fingerprint, options.use_presolve, None)?;
+        let dense = objectives.is_indexed();
+        let objectives = first.replica.columns.resolve(objectives)?;
+        // Released until a worker takes the replica, so workers that build
+        // their own replicas never wait for an environment nobody uses
+        let first = Mutex::new(Some(first.into_replica()));
 
         let sense = match direction {
             SolverDirection::Maximize => ModelSense::Maximize,
             SolverDirection::Minimize => ModelSense::Minimize,
         };
 
-        let mut solutions = Vec::new();
-
-        // Solve each objective by updating objective coefficients
-        for objective in objectives {
-            // Build objective expression
-            let obj_expr = polyhedron.variables.iter().enumerate().fold(
-                Expr::Constant(0.0),
-                |acc, (idx, var)| {
-                    let coeff = objective.get(&var.id).copied().unwrap_or(0.0);
-                    if coeff != 0.0 {
-                        acc + coeff * model_lock.vars[idx]
-                    } else {
-                        acc
+        let hint = options
+            .hint
+            .as_ref()
+            .map(|hint| to_column_values(&polyhedron.variables, hint));
+        let deadline = options.limits.deadline();
+
+        // Each worker checks out its own replica (or builds one) for the whole
+        // solve call and keeps pulling objectives until all are solved, warm
+        // starting every objective from the one it solved before
+        parallel::for_each_claimed(
+            &objectives,
+            options.parallelism,
+            |_| {
+                let replica = match first.lock().take() {
+                    Some(replica) => LeasedModel {
+                        _lease: replica.env.lease(),
+                        replica,
+                    },
+                    None => self.obtain_model(
+                        &polyhedron,
+                        fingerprint,
+                        options.use_presolve,
+                        Some(options.parallelism),
+                    )?,
+                };
+                Ok((replica, hint.clone()))
+            },
+            |(LeasedModel { replica, .. }, start), idx, objective| {
+                options.cancel.check()?;
+                let solution = match remaining(deadline) {
+                    Some(left) if left.is_zero() => {
+                        timed_out_solution(&polyhedron.variables, dense)
                     }
-                },
-            );
-
-            model_lock
-                .model
-                .set_objective(obj_expr, sense)
-                .map_err(|e| SolveInputError {
-                    details: format!("Failed to set objective: {}", e),
-                })?;
+                    left => {
+                        Self::apply_limits(replica, &options, left)?;
+                        Self::solve_objective(
+                            replica,
+                            &polyhedron,
+                            objective,
+                            sense,
+                            start,
+                            &options.cancel,
+                            dense,
+                        )?
+                    }
+                };
+                // A cancelled objective has no usable solution
+                options.cancel.check()?;
+                on_solution(idx, solution);
+                Ok(())
+            },
+        )
+    }
 
-            // Optimize
-            model_lock.model.optimize().map_err(|e| SolveInputError {
-                details: format!("Failed to optimize: {}", e),
-            })?;
+    fn warm(
+        &self,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
+        use_presolve: bool,
+    ) -> Result<(), SolveInputError> {
+        if self.model_cache.is_some() {
+            self.obtain_model(polyhedron, fingerprint, use_presolve, None)?;
+        }
+        Ok(())
+    }
 
-            // Extract solution
-            let model_status = model_lock.model.status().map_err(|e| SolveInputError {
-                details: format!("Failed to get model status: {}", e),
-            })?;
-            let status = Self::convert_status(model_status);
-
-            // Map solution back to variable names
-            let mut solution_map: HashMap<String, i32> = HashMap::new();
-            for (idx, var) in polyhedron.variables.iter().enumerate() {
-                let (lower, upper) = var.bound;
-
-                // Get solution value, or use fixed value if variable was eliminated by presolve
-                let value = model_lock
-                    .model
-                    .get_obj_attr(attr::X, &model_lock.vars[idx])
-                    .unwrap_or_else(|_| {
-                        // If variable is fixed (lower == upper), use the fixed value
-                        if lower == upper {
-                            lower as f64
-                        } else {
-                            0.0
-                        }
-                    });
-
-                solution_map.insert(var.id.clone(), value.round() as i32);
-            }
+    fn cached_models(&self) -> Vec<Fingerprint> {
+        self.model_cache
+            .as_ref()
+            .map_or_else(Vec::new, ModelCache::fingerprints)
+    }
 
-            // Calculate objective value
-            let objective_value: f64 = solution_map
-                .iter()
-                .filter_map(|(var_id, &val)| {
-                    objective.get(var_id).map(|coeff| coeff * (val as f64))
-                })
-                .sum();
-
-            solutions.push(ApiSolution {
-                status,
-                objective: objective_value.round() as i32,
-                solution: solution_map,
-                error: None,
-            });
+    fn pin(&self, fingerprint: Fingerprint) {
+        if let Some(model_cache) = &self.model_cache {
+            model_cache.pin(fingerprint.structure());
         }
+    }
 
-        Ok(solutions)
+    fn unpin(&self, fingerprint: Fingerprint) {
+        if let Some(model_cache) = &self.model_cache {
+            model_cache.unpin(fingerprint.structure());
+        }
     }
 
     fn name(&self) -> &str {
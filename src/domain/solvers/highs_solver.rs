@@ -1,30 +1,55 @@
-use crate::convert::to_glpk_polyhedron;
-use crate::domain::solver::Solver;
-use crate::domain::validate::{validate_objectives_owned, SolveInputError};
-use crate::models::{ApiSolution, SolverDirection, SparseLEIntegerPolyhedron, Status};
-use std::collections::HashMap;
+use crate::convert::{timed_out_solution, to_api_values, to_column_values};
+use crate::domain::bounds::ModelBounds;
+use crate::domain::columns::{ColumnIndex, SparseObjective};
+use crate::domain::fingerprint::Fingerprint;
+use crate::domain::model_cache::{ModelCache, ModelCacheConfig, ModelPool, PooledModel};
+use crate::domain::parallel;
+use crate::domain::solver::{remaining, SolutionSink, SolveOptions, Solver};
+use crate::domain::sparse;
+use crate::domain::validate::SolveInputError;
+use crate::metrics::{self, Phase};
+use crate::models::{
+    ApiObjectives, ApiSolution, SolverDirection, SparseLEIntegerPolyhedron, Status,
+};
 use std::ffi::CString;
-use std::os::raw::c_void;
+use std::os::raw::{c_char, c_int, c_void};
+use std::sync::atomic::{AtomicBool, Ordering};
 use std::sync::Arc;
+use std::time::Duration;
 
 use highs_sys::*;
-use lru::LruCache;
 use parking_lot::Mutex;
-use std::num::NonZeroUsize;
+
+const HIGHS_STATUS_ERROR: i32 = -1;
+/// Model status after `interrupt_if_cancelled` stopped a run
+const HIGHS_MODEL_STATUS_INTERRUPT: i32 = 17;
+const HIGHS_MATRIX_FORMAT_COLWISE: i32 = 1;
+const HIGHS_OBJ_SENSE_MINIMIZE: i32 = 1;
+const HIGHS_VAR_TYPE_INTEGER: i32 = 1;
+const HIGHS_SOLUTION_STATUS_FEASIBLE: i32 = 2;
+/// Callbacks that let `interrupt_if_cancelled` stop a running solve
+const HIGHS_INTERRUPT_CALLBACKS: [i32; 3] = [
+    1, // kCallbackSimplexInterrupt
+    2, // kCallbackIpmInterrupt
+    6, // kCallbackMipInterrupt
+];
+/// HiGHS default of `mip_rel_gap`, restored on cached models without a gap
+const HIGHS_DEFAULT_MIP_REL_GAP: f64 = 1e-4;
 
 /// Cached HiGHS model structure
 struct HighsModel {
     highs_ptr: *mut c_void,
     n_cols: i32,
+    columns: ColumnIndex,
+    bounds: ModelBounds,
 }
 
 // `HighsModel` contains a raw pointer to a HiGHS instance, which is
 // not intrinsically thread-safe. We declare `HighsModel` as `Send`
-// because it is only ever used behind a `Mutex`, e.g. via
-// `Arc<Mutex<HighsModel>>` in `HighsSolver::model_cache`. All accesses to
-// `highs_ptr` must be performed while holding that mutex, ensuring that the
-// underlying HiGHS instance is never used concurrently from multiple threads
-// and is not accessed outside this synchronized context.
+// because it is only ever used through a `ModelPool`, which hands each
+// replica out to exactly one `PooledModel` guard at a time. All accesses to
+// `highs_ptr` must be performed through that guard, ensuring that the
+// underlying HiGHS instance is never used concurrently from multiple threads.
 unsafe impl Send for HighsModel {}
 
 impl Drop for HighsModel {
@@ -40,24 +65,29 @@ impl Drop for HighsModel {
 /// HiGHS solver implementation using highs-sys for direct memory control.
 ///
 /// This implementation includes model caching:
-/// - Models are cached based on polyhedron hash
-/// - LRU eviction policy when cache is full
+/// - Models are cached based on the polyhedron's matrix structure; `b` and
+///   variable bounds of a cached model are updated in place when they differ
+/// - GDSF eviction when the cache is full, counting every replica
 /// - Reuses cached models across multiple objectives
-/// - Thread-safe via parking_lot::Mutex
+/// - Each cached polyhedron holds a bounded pool of independent replicas,
+///   so concurrent requests for the same polyhedron solve in parallel
 pub struct HighsSolver {
-    model_cache: Option<Arc<Mutex<LruCache<SparseLEIntegerPolyhedron, Arc<Mutex<HighsModel>>>>>>,
+    model_cache: Option<ModelCache<HighsModel>>,
 }
 
 impl HighsSolver {
     /// Create a new HiGHS solver with specified cache size
     pub fn with_cache_size(size: Option<usize>) -> Self {
-        match size {
-            Some(0) | None => Self::without_cache(),
-            Some(s) => HighsSolver {
-                model_cache: Some(Arc::new(Mutex::new(LruCache::new(
-                    NonZeroUsize::new(s).unwrap(),
-                )))),
+        Self::with_cache_config(size.map(ModelCacheConfig::with_capacity))
+    }
+
+    /// Create a new HiGHS solver with the given cache sizing
+    pub fn with_cache_config(config: Option<ModelCacheConfig>) -> Self {
+        match config {
+            Some(config) if config.capacity > 0 => HighsSolver {
+                model_cache: Some(ModelCache::new(config)),
             },
+            _ => Self::without_cache(),
         }
     }
 
@@ -72,6 +102,7 @@ impl HighsSolver {
         const HIGHS_MODEL_STATUS_INFEASIBLE: i32 = 8;
         const HIGHS_MODEL_STATUS_UNBOUNDED: i32 = 10;
         const HIGHS_MODEL_STATUS_UNBOUNDED_OR_INFEASIBLE: i32 = 9;
+        const HIGHS_MODEL_STATUS_TIME_LIMIT: i32 = 13;
 
         match status {
             HIGHS_MODEL_STATUS_OPTIMAL => Status::Optimal,
@@ -79,6 +110,7 @@ impl HighsSolver {
             HIGHS_MODEL_STATUS_UNBOUNDED | HIGHS_MODEL_STATUS_UNBOUNDED_OR_INFEASIBLE => {
                 Status::Unbounded
             }
+            HIGHS_MODEL_STATUS_TIME_LIMIT => Status::TimeLimit,
             _ => Status::Undefined,
         }
     }
@@ -88,17 +120,23 @@ impl HighsSolver {
         &self,
         polyhedron: &SparseLEIntegerPolyhedron,
         use_presolve: bool,
-    ) -> Result<Arc<Mutex<HighsModel>>, SolveInputError> {
+    ) -> Result<HighsModel, SolveInputError> {
         let n_rows = polyhedron.a.shape.nrows as i32;
         let n_cols = polyhedron.variables.len() as i32;
 
-        // Create HiGHS instance
+        // Create HiGHS instance; wrapping it right away destroys it on early return
         let highs_ptr = unsafe { Highs_create() };
         if highs_ptr.is_null() {
             return Err(SolveInputError {
                 details: "Failed to create HiGHS instance".to_string(),
             });
         }
+        let model = HighsModel {
+            highs_ptr,
+            n_cols,
+            columns: ColumnIndex::new(&polyhedron.variables),
+            bounds: ModelBounds::new(polyhedron),
+        };
 
         // Set options
         unsafe {
@@ -119,39 +157,6 @@ impl HighsSolver {
         let row_lower = vec![f64::NEG_INFINITY; n_rows as usize];
         let row_upper: Vec<f64> = polyhedron.b.iter().map(|&b| b as f64).collect();
 
-        // Add rows FIRST (before columns reference them)
-        unsafe {
-            Highs_addRows(
-                highs_ptr,
-                n_rows,
-                row_lower.as_ptr(),
-                row_upper.as_ptr(),
-                0, // num_nz = 0, will add via columns
-                std::ptr::null(),
-                std::ptr::null(),
-                std::ptr::null(),
-            );
-        }
-
-        // Build sparse constraint matrix in CSC (Column Sparse Compressed) format
-        let mut col_start: Vec<i32> = Vec::with_capacity((n_cols + 1) as usize);
-        let mut col_index: Vec<i32> = Vec::new();
-        let mut col_value: Vec<f64> = Vec::new();
-
-        // Build column-wise sparse matrix
-        for col_idx in 0..n_cols as usize {
-            col_start.push(col_index.len() as i32);
-
-            // Find all entries for this column
-            for i in 0..polyhedron.a.rows.len() {
-                if polyhedron.a.cols[i] as usize == col_idx {
-                    col_index.push(polyhedron.a.rows[i] as i32);
-                    col_value.push(polyhedron.a.vals[i] as f64);
-                }
-            }
-        }
-        col_start.push(col_index.len() as i32); // Final element
-
         // Prepare column bounds and costs (zero costs, will be updated per objective)
         let col_costs = vec![0.0; n_cols as usize];
         let col_lower: Vec<f64> = polyhedron
@@ -164,160 +169,366 @@ impl HighsSolver {
             .iter()
             .map(|v| v.bound.1 as f64)
             .collect();
+        let integrality = vec![HIGHS_VAR_TYPE_INTEGER; n_cols as usize];
 
-        // Add columns with constraints
+        // Pass the whole model at once, with A in CSC (Column Sparse Compressed) format
+        let pass_status = sparse::with_csc(&polyhedron.a, |csc| {
+            if csc.major_len() != n_cols as usize || row_upper.len() != n_rows as usize {
+                return HIGHS_STATUS_ERROR;
+            }
+            unsafe {
+                Highs_passMip(
+                    highs_ptr,
+                    n_cols,
+                    n_rows,
+                    csc.nnz() as i32,
+                    HIGHS_MATRIX_FORMAT_COLWISE,
+                    HIGHS_OBJ_SENSE_MINIMIZE,
+                    0.0,
+                    col_costs.as_ptr(),
+                    col_lower.as_ptr(),
+                    col_upper.as_ptr(),
+                    row_lower.as_ptr(),
+                    row_upper.as_ptr(),
+                    csc.start.as_ptr(),
+                    csc.index.as_ptr(),
+                    csc.value.as_ptr(),
+                    integrality.as_ptr(),
+                )
+            }
+        });
+        if pass_status == HIGHS_STATUS_ERROR {
+            return Err(SolveInputError {
+                details: "Failed to pass model to HiGHS".to_string(),
+            });
+        }
+
+        Ok(model)
+    }
+
+    /// Apply the `b` and bounds of `polyhedron` to a cached model of the same structure
+    fn apply_bounds(model: &mut HighsModel, polyhedron: &SparseLEIntegerPolyhedron) {
+        let changes = model.bounds.update(polyhedron);
+        if !changes.rows.is_empty() {
+            let rows: Vec<i32> = changes.rows.iter().map(|&row| row as i32).collect();
+            let lower = vec![f64::NEG_INFINITY; rows.len()];
+            let upper: Vec<f64> = changes
+                .rows
+                .iter()
+                .map(|&row| polyhedron.b[row] as f64)
+                .collect();
+            unsafe {
+                Highs_changeRowsBoundsBySet(
+                    model.highs_ptr,
+                    rows.len() as i32,
+                    rows.as_ptr(),
+                    lower.as_ptr(),
+                    upper.as_ptr(),
+                );
+            }
+        }
+        if !changes.cols.is_empty() {
+            let cols: Vec<i32> = changes.cols.iter().map(|&col| col as i32).collect();
+            let (lower, upper): (Vec<f64>, Vec<f64>) = changes
+                .cols
+                .iter()
+                .map(|&col| {
+                    let (lower, upper) = polyhedron.variables[col].bound;
+                    (lower as f64, upper as f64)
+                })
+                .unzip();
+            unsafe {
+                Highs_changeColsBoundsBySet(
+                    model.highs_ptr,
+                    cols.len() as i32,
+                    cols.as_ptr(),
+                    lower.as_ptr(),
+                    upper.as_ptr(),
+                );
+            }
+        }
+    }
+
+    /// Set the time limit, MIP gap and thread count of the next run.
+    ///
+    /// Options stay on a cached model, so unset limits restore the defaults.
+    fn apply_limits(highs_ptr: *mut c_void, options: &SolveOptions, time_left: Option<Duration>) {
+        let time_limit = time_left.map_or(f64::INFINITY, |left| left.as_secs_f64());
+        let mip_gap = options.limits.mip_gap.unwrap_or(HIGHS_DEFAULT_MIP_REL_GAP);
+        let time_limit_name = CString::new("time_limit").unwrap();
+        let mip_gap_name = CString::new("mip_rel_gap").unwrap();
+        let threads_name = CString::new("threads").unwrap();
         unsafe {
-            Highs_addCols(
-                highs_ptr,
-                n_cols,
-                col_costs.as_ptr(),
-                col_lower.as_ptr(),
-                col_upper.as_ptr(),
-                col_index.len() as i32,
-                col_start.as_ptr(),
-                col_index.as_ptr(),
-                col_value.as_ptr(),
-            );
+            Highs_setDoubleOptionValue(highs_ptr, time_limit_name.as_ptr(), time_limit);
+            Highs_setDoubleOptionValue(highs_ptr, mip_gap_name.as_ptr(), mip_gap);
+            Highs_setIntOptionValue(highs_ptr, threads_name.as_ptr(), options.threads as i32);
+        }
+    }
+
+    /// Run HiGHS with an interrupt callback polling the request's cancel token
+    fn run(highs_ptr: *mut c_void, options: &SolveOptions) -> i32 {
+        let flag = options.cancel.flag() as *const AtomicBool as *mut c_void;
+        unsafe {
+            Highs_setCallback(highs_ptr, Some(interrupt_if_cancelled), flag);
+            for callback in HIGHS_INTERRUPT_CALLBACKS {
+                Highs_startCallback(highs_ptr, callback);
+            }
+            let status = Highs_run(highs_ptr);
+            // The flag is only borrowed for this run
+            Highs_setCallback(highs_ptr, None, std::ptr::null_mut());
+            status
         }
+    }
 
-        // Set integrality for all columns
-        for col_idx in 0..n_cols {
+    /// Solve a single objective on a checked-out model by updating its costs.
+    ///
+    /// `start`, when set, is passed to HiGHS as MIP start and is replaced by
+    /// this objective's incumbent (if a feasible one was found) for the next call.
+    /// `time_left` is what remains of the request's time limit.
+    /// `dense` returns the values in variable order instead of keyed by id.
+    fn solve_objective(
+        model: &HighsModel,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        objective: &SparseObjective,
+        start: &mut Option<Vec<f64>>,
+        options: &SolveOptions,
+        time_left: Option<Duration>,
+        dense: bool,
+    ) -> Result<ApiSolution, SolveInputError> {
+        let highs_ptr = model.highs_ptr;
+        let n_cols = model.n_cols;
+        Self::apply_limits(highs_ptr, options, time_left);
+
+        if let Some(values) = start.take().filter(|v| v.len() == n_cols as usize) {
+            // HiGHS ignores a start that turns out to be infeasible
             unsafe {
-                Highs_changeColIntegrality(highs_ptr, col_idx, 1); // 1 = integer
+                Highs_setSolution(
+                    highs_ptr,
+                    values.as_ptr(),
+                    std::ptr::null(),
+                    std::ptr::null(),
+                    std::ptr::null(),
+                );
             }
         }
 
-        Ok(Arc::new(Mutex::new(HighsModel { highs_ptr, n_cols })))
+        // Replace all objective coefficients in one call
+        let mut costs = vec![0.0; n_cols as usize];
+        for &(col, coeff) in objective {
+            costs[col] = coeff;
+        }
+        if n_cols > 0 {
+            unsafe {
+                Highs_changeColsCostByRange(highs_ptr, 0, n_cols - 1, costs.as_ptr());
+            }
+        }
+
+        // Solve; time limits and interrupts end the run with a warning, and
+        // the model status tells them apart
+        let status = metrics::timed(Phase::Solve, || Self::run(highs_ptr, options));
+        if status == HIGHS_STATUS_ERROR {
+            return Ok(ApiSolution {
+                status: Status::Undefined,
+                objective: 0,
+                solution: to_api_values(&polyhedron.variables, Vec::new(), dense),
+                error: Some(format!("HiGHS solve failed with status {}", status)),
+            });
+        }
+
+        // Get model status
+        let model_status = unsafe { Highs_getModelStatus(highs_ptr) };
+        if model_status == HIGHS_MODEL_STATUS_INTERRUPT {
+            // Only a cancelled solve interrupts a run
+            return Err(SolveInputError {
+                details: "Solve cancelled".to_string(),
+            });
+        }
+        let api_status = Self::convert_status(model_status);
+
+        // Extract solution
+        let mut solution_values = vec![0.0; n_cols as usize];
+        unsafe {
+            Highs_getSolution(
+                highs_ptr,
+                solution_values.as_mut_ptr(),
+                std::ptr::null_mut(),
+                std::ptr::null_mut(),
+                std::ptr::null_mut(),
+            );
+        }
+
+        // Keep a feasible incumbent as start for the next objective
+        let mut primal_status: i32 = 0;
+        let info_name = CString::new("primal_solution_status").unwrap();
+        unsafe {
+            Highs_getIntInfoValue(highs_ptr, info_name.as_ptr(), &mut primal_status);
+        }
+        if primal_status == HIGHS_SOLUTION_STATUS_FEASIBLE {
+            *start = Some(solution_values.iter().map(|v| v.round()).collect());
+        } else if matches!(api_status, Status::TimeLimit) {
+            // Stopped before any incumbent was found
+            solution_values.fill(0.0);
+        }
+
+        let values: Vec<i32> = solution_values.iter().map(|v| v.round() as i32).collect();
+
+        // Calculate objective value
+        let objective_value: f64 = objective
+            .iter()
+            .map(|&(col, coeff)| coeff * values[col] as f64)
+            .sum();
+
+        Ok(ApiSolution {
+            status: api_status,
+            objective: objective_value.round() as i32,
+            solution: to_api_values(&polyhedron.variables, values, dense),
+            error: None,
+        })
     }
 
     /// Get or build a model for the given polyhedron
+    ///
+    /// A `spare` checkout, made by parallel objective workers beyond the
+    /// first, may grow the cached pool to the request's `parallelism`.
     fn obtain_model(
         &self,
         polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
         use_presolve: bool,
-    ) -> Result<Arc<Mutex<HighsModel>>, SolveInputError> {
-        match &self.model_cache {
-            Some(some_model_cache) => {
-                // Check cache first
-                {
-                    let mut cache = some_model_cache.lock();
-                    if let Some(cached_model) = cache.get(polyhedron) {
-                        return Ok(Arc::clone(cached_model));
-                    }
-                }
-
-                // Not in cache, build new model
-                let model = self.build_model(polyhedron, use_presolve)?;
-
-                // Store in cache
-                {
-                    let mut cache = some_model_cache.lock();
-                    cache.put(polyhedron.clone(), Arc::clone(&model));
-                }
-
-                Ok(model)
-            } // Caching enabled, proceed to check cache
-            None => {
-                // Caching disabled, build new model every time
-                return self.build_model(polyhedron, use_presolve);
+        spare: Option<usize>,
+    ) -> Result<PooledModel<HighsModel>, SolveInputError> {
+        let build = || metrics::timed(Phase::Build, || self.build_model(polyhedron, use_presolve));
+        let key = fingerprint.structure();
+        let mut model = match (&self.model_cache, spare) {
+            (Some(model_cache), None) => model_cache.checkout(key, build)?,
+            (Some(model_cache), Some(parallelism)) => {
+                model_cache.checkout_spare(key, parallelism, build)?
             }
-        }
+            // Caching disabled, build new model every time
+            (None, _) => return Arc::new(ModelPool::new(1)).checkout(build),
+        };
+        Self::apply_bounds(&mut model, polyhedron);
+        Ok(model)
+    }
+}
+
+/// HiGHS interrupt callback, stopping the run once the solve is cancelled.
+///
+/// `user_data` is the `AtomicBool` of the solve's `CancelToken`.
+unsafe extern "C" fn interrupt_if_cancelled(
+    _callback_type: c_int,
+    _message: *const c_char,
+    _data_out: *const HighsCallbackDataOut,
+    data_in: *mut HighsCallbackDataIn,
+    user_data: *mut c_void,
+) {
+    if !data_in.is_null() && (*(user_data as *const AtomicBool)).load(Ordering::Relaxed) {
+        (*data_in).user_interrupt = 1;
     }
 }
 
 impl Solver for HighsSolver {
-    fn solve(
+    fn solve_each(
         &self,
-        polyhedron: SparseLEIntegerPolyhedron,
-        objectives: Vec<HashMap<String, f64>>,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        objectives: ApiObjectives,
         direction: SolverDirection,
-        use_presolve: bool,
-    ) -> Result<Vec<ApiSolution>, SolveInputError> {
-        // Use GLPK polyhedron for validation
-        let glpk_polyhedron = to_glpk_polyhedron(&polyhedron);
-        validate_objectives_owned(&glpk_polyhedron.variables, &objectives)?;
-
-        // Get or build cached model, then lock mutex for entire solve call
-        let model_mutex = self.obtain_model(&polyhedron, use_presolve)?;
-        let model = model_mutex.lock();
-
-        let highs_ptr = model.highs_ptr;
-        let n_cols = model.n_cols;
+        options: SolveOptions,
+        on_solution: &SolutionSink,
+    ) -> Result<(), SolveInputError> {
+        // The first model's column index validates and resolves the objectives
+        // before anything is solved; on a cache hit it is reused as-is
+        let first = self.obtain_model(&polyhedron, fingerprint, options.use_presolve, None)?;
+        let dense = objectives.is_indexed();
+        let objectives = first.columns.resolve(objectives)?;
+        let first = Mutex::new(Some(first));
 
         // Set optimization sense (minimize = 1, maximize = -1)
         let sense = match direction {
             SolverDirection::Minimize => 1,
             SolverDirection::Maximize => -1,
         };
-        unsafe {
-            Highs_changeObjectiveSense(highs_ptr, sense);
-        }
-
-        let mut solutions = Vec::with_capacity(objectives.len());
 
-        // Solve each objective by updating objective coefficients
-        for objective in objectives {
-            // Update objective coefficients
-            for (col_idx, var) in polyhedron.variables.iter().enumerate() {
-                let obj_coeff = objective.get(&var.id).copied().unwrap_or(0.0);
+        let hint = options
+            .hint
+            .as_ref()
+            .map(|hint| to_column_values(&polyhedron.variables, hint));
+        let deadline = options.limits.deadline();
+
+        // Each worker checks out its own replica (or builds one) for the whole
+        // solve call and keeps pulling objectives until all are solved, warm
+        // starting every objective from the one it solved before
+        parallel::for_each_claimed(
+            &objectives,
+            options.parallelism,
+            |_| {
+                let model = match first.lock().take() {
+                    Some(model) => model,
+                    None => self.obtain_model(
+                        &polyhedron,
+                        fingerprint,
+                        options.use_presolve,
+                        Some(options.parallelism),
+                    )?,
+                };
                 unsafe {
-                    Highs_changeColCost(highs_ptr, col_idx as i32, obj_coeff);
+                    Highs_changeObjectiveSense(model.highs_ptr, sense);
                 }
-            }
-
-            // Solve
-            let status = unsafe { Highs_run(highs_ptr) };
-            if status != 0 {
-                solutions.push(ApiSolution {
-                    status: Status::Undefined,
-                    objective: 0,
-                    solution: HashMap::new(),
-                    error: Some(format!("HiGHS solve failed with status {}", status)),
-                });
-                continue;
-            }
-
-            // Get model status
-            let model_status = unsafe { Highs_getModelStatus(highs_ptr) };
-            let api_status = Self::convert_status(model_status);
-
-            // Extract solution
-            let mut solution_values = vec![0.0; n_cols as usize];
-            unsafe {
-                Highs_getSolution(
-                    highs_ptr,
-                    solution_values.as_mut_ptr(),
-                    std::ptr::null_mut(),
-                    std::ptr::null_mut(),
-                    std::ptr::null_mut(),
-                );
-            }
+                Ok((model, hint.clone()))
+            },
+            |(model, start), idx, objective| {
+                options.cancel.check()?;
+                let solution = match remaining(deadline) {
+                    Some(left) if left.is_zero() => {
+                        timed_out_solution(&polyhedron.variables, dense)
+                    }
+                    left => Self::solve_objective(
+                        model,
+                        &polyhedron,
+                        objective,
+                        start,
+                        &options,
+                        left,
+                        dense,
+                    )?,
+                };
+                // A cancelled objective has no usable solution
+                options.cancel.check()?;
+                on_solution(idx, solution);
+                Ok(())
+            },
+        )
+    }
 
-            // Map solution back to variable names
-            let mut solution_map: HashMap<String, i32> = HashMap::new();
-            for (col_idx, var) in polyhedron.variables.iter().enumerate() {
-                let value: f64 = solution_values[col_idx];
-                let rounded_value = value.round() as i32;
-                solution_map.insert(var.id.clone(), rounded_value);
-            }
+    fn warm(
+        &self,
+        polyhedron: &SparseLEIntegerPolyhedron,
+        fingerprint: Fingerprint,
+        use_presolve: bool,
+    ) -> Result<(), SolveInputError> {
+        if self.model_cache.is_some() {
+            self.obtain_model(polyhedron, fingerprint, use_presolve, None)?;
+        }
+        Ok(())
+    }
 
-            // Calculate objective value
-            let objective_value: f64 = solution_map
-                .iter()
-                .filter_map(|(var_id, &val)| {
-                    objective.get(var_id).map(|coeff| coeff * (val as f64))
-                })
-                .sum();
+    fn cached_models(&self) -> Vec<Fingerprint> {
+        self.model_cache
+            .as_ref()
+            .map_or_else(Vec::new, ModelCache::fingerprints)
+    }
 
-            solutions.push(ApiSolution {
-                status: api_status,
-                objective: objective_value.round() as i32,
-                solution: solution_map,
-                error: None,
-            });
+    fn pin(&self, fingerprint: Fingerprint) {
+        if let Some(model_cache) = &self.model_cache {
+            model_cache.pin(fingerprint.structure());
         }
+    }
 
-        Ok(solutions)
+    fn unpin(&self, fingerprint: Fingerprint) {
+        if let Some(model_cache) = &self.model_cache {
+            model_cache.unpin(fingerprint.structure());
+        }
     }
 
     fn name(&self) -> &str {
@@ -328,7 +539,9 @@ impl Solver for HighsSolver {
 #[cfg(test)]
 mod tests {
     use super::*;
-    use crate::models::{ApiIntegerSparseMatrix, ApiShape, ApiVariable, SolverDirection};
+    use crate::models::{
+        ApiIntegerSparseMatrix, ApiShape, ApiValues, ApiVariable, SolverDirection,
+    };
     use std::collections::HashMap;
 
     fn create_test_polyhedron() -> SparseLEIntegerPolyhedron {
@@ -367,29 +580,34 @@ mod tests {
         obj2.insert("y".to_string(), 1.0);
 
         // First solve - should build model
+        let fingerprint = Fingerprint::of(&polyhedron);
+
         let result1 = solver.solve(
-            polyhedron.clone(),
-            vec![obj1.clone()],
+            Arc::new(polyhedron.clone()),
+            fingerprint,
+            vec![obj1.clone()].into(),
             SolverDirection::Maximize,
-            true,
+            SolveOptions::default(),
         );
         assert!(result1.is_ok());
 
         // Second solve with same polyhedron, different objective - should reuse cached model
         let result2 = solver.solve(
-            polyhedron.clone(),
-            vec![obj2],
+            Arc::new(polyhedron.clone()),
+            fingerprint,
+            vec![obj2].into(),
             SolverDirection::Maximize,
-            true,
+            SolveOptions::default(),
         );
         assert!(result2.is_ok());
 
         // Third solve with same polyhedron and objective - should still work
         let result3 = solver.solve(
-            polyhedron.clone(),
-            vec![obj1],
+            Arc::new(polyhedron.clone()),
+            fingerprint,
+            vec![obj1].into(),
             SolverDirection::Maximize,
-            true,
+            SolveOptions::default(),
         );
         assert!(result3.is_ok());
     }
@@ -403,7 +621,198 @@ mod tests {
         obj.insert("x".to_string(), 1.0);
         obj.insert("y".to_string(), 2.0);
 
-        let result = solver.solve(polyhedron, vec![obj], SolverDirection::Maximize, true);
+        let fingerprint = Fingerprint::of(&polyhedron);
+        let result = solver.solve(
+            Arc::new(polyhedron),
+            fingerprint,
+            vec![obj].into(),
+            SolverDirection::Maximize,
+            SolveOptions::default(),
+        );
         assert!(result.is_ok());
     }
+
+    #[test]
+    fn test_time_limit_returns_time_limit_status() {
+        use crate::domain::solver::SolveLimits;
+        use std::time::Duration;
+
+        // Market split: sum_j a_ij x_j = d_i over binaries, which branch-and-
+        // bound cannot settle in a few milliseconds
+        let (m, n) = (4, 30);
+        let mut seed: u64 = 7;
+        let mut next = || {
+            seed = seed.wrapping_mul(6364136223846793005).wrapping_add(1);
+            ((seed >> 33) % 100) as i32
+        };
+        let a: Vec<Vec<i32>> = (0..m).map(|_| (0..n).map(|_| next()).collect()).collect();
+        let (mut rows, mut cols, mut vals, mut b) = (vec![], vec![], vec![], vec![]);
+        for (i, row) in a.iter().enumerate() {
+            let d = row.iter().sum::<i32>() / 2;
+            for (sign, offset) in [(1, 0), (-1, m)] {
+                for (j, &coeff) in row.iter().enumerate() {
+                    rows.push((i + offset) as i32);
+                    cols.push(j as i32);
+                    vals.push(sign * coeff);
+                }
+                b.push(sign * d);
+            }
+        }
+        let polyhedron = SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows,
+                cols,
+                vals,
+                shape: ApiShape {
+                    nrows: 2 * m,
+                    ncols: n,
+                },
+            },
+            b,
+            variables: (0..n)
+                .map(|j| ApiVariable {
+                    id: format!("x{}", j),
+                    bound: (0, 1),
+                })
+                .collect(),
+        };
+
+        for solver in [
+            HighsSolver::without_cache(),
+            HighsSolver::with_cache_size(Some(4)),
+        ] {
+            let fingerprint = Fingerprint::of(&polyhedron);
+            let solutions = solver
+                .solve(
+                    Arc::new(polyhedron.clone()),
+                    fingerprint,
+                    ApiObjectives::Indexed(vec![(0..n).map(|j| (j, 1.0)).collect()]),
+                    SolverDirection::Maximize,
+                    SolveOptions {
+                        limits: SolveLimits {
+                            time_limit: Some(Duration::from_millis(20)),
+                            mip_gap: None,
+                        },
+                        ..SolveOptions::default()
+                    },
+                )
+                .ok()
+                .unwrap();
+            assert!(matches!(solutions[0].status, Status::TimeLimit));
+            assert_eq!(solutions[0].error, None);
+        }
+    }
+
+    #[test]
+    fn test_cache_replicas_solve_concurrently() {
+        let solver = HighsSolver::with_cache_config(Some(ModelCacheConfig {
+            capacity: 4,
+            replicas_per_model: 2,
+            budget_bytes: None,
+        }));
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+
+        std::thread::scope(|scope| {
+            for _ in 0..4 {
+                scope.spawn(|| {
+                    let mut obj = HashMap::new();
+                    obj.insert("x".to_string(), 1.0);
+                    let result = solver.solve(
+                        Arc::new(polyhedron.clone()),
+                        fingerprint,
+                        vec![obj].into(),
+                        SolverDirection::Maximize,
+                        SolveOptions::default(),
+                    );
+                    assert!(result.is_ok());
+                });
+            }
+        });
+    }
+
+    #[test]
+    fn test_parallel_objectives_keep_order() {
+        let solver = HighsSolver::with_cache_size(Some(4));
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+
+        // Alternate between maximizing x (optimum 10) and y (optimum 5)
+        let objectives: Vec<HashMap<String, f64>> = (0..6)
+            .map(|i| {
+                let var = if i % 2 == 0 { "x" } else { "y" };
+                HashMap::from([(var.to_string(), 1.0)])
+            })
+            .collect();
+
+        let solutions = solver
+            .solve(
+                Arc::new(polyhedron),
+                fingerprint,
+                objectives.into(),
+                SolverDirection::Maximize,
+                SolveOptions {
+                    parallelism: 3,
+                    ..SolveOptions::default()
+                },
+            )
+            .ok()
+            .unwrap();
+
+        let values: Vec<i32> = solutions.iter().map(|s| s.objective).collect();
+        assert_eq!(values, vec![10, 5, 10, 5, 10, 5]);
+    }
+
+    #[test]
+    fn test_hint_and_incumbent_warm_starts_keep_results() {
+        let solver = HighsSolver::with_cache_size(Some(10));
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+
+        let objectives = vec![
+            HashMap::from([("x".to_string(), 1.0)]),
+            HashMap::from([("x".to_string(), 1.0), ("y".to_string(), 1.0)]),
+            HashMap::from([("y".to_string(), 1.0)]),
+        ];
+
+        let solutions = solver
+            .solve(
+                Arc::new(polyhedron),
+                fingerprint,
+                objectives.into(),
+                SolverDirection::Maximize,
+                SolveOptions {
+                    hint: Some(HashMap::from([("x".to_string(), 10), ("y".to_string(), 0)])),
+                    ..SolveOptions::default()
+                },
+            )
+            .ok()
+            .unwrap();
+
+        let values: Vec<i32> = solutions.iter().map(|s| s.objective).collect();
+        assert_eq!(values, vec![10, 10, 5]);
+    }
+
+    #[test]
+    fn test_indexed_objectives_return_dense_values() {
+        let solver = HighsSolver::with_cache_size(Some(4));
+        let polyhedron = create_test_polyhedron();
+        let fingerprint = Fingerprint::of(&polyhedron);
+
+        let solutions = solver
+            .solve(
+                Arc::new(polyhedron),
+                fingerprint,
+                ApiObjectives::Indexed(vec![vec![(0, 1.0)], vec![(1, 1.0)]]),
+                SolverDirection::Maximize,
+                SolveOptions::default(),
+            )
+            .ok()
+            .unwrap();
+
+        assert_eq!(solutions[0].objective, 10);
+        assert_eq!(solutions[0].solution, ApiValues::Dense(vec![10, 0]));
+        assert_eq!(solutions[1].objective, 5);
+        assert_eq!(solutions[1].solution, ApiValues::Dense(vec![0, 5]));
+    }
 }
@@ -1,3 +1,4 @@
+mod glpk_ffi;
 pub mod glpk_solver;
 
 #[cfg(feature = "highs-solver")]
@@ -0,0 +1,180 @@
+use crate::models::ApiIntegerSparseMatrix;
+use std::cell::RefCell;
+
+/// Compressed sparse matrix, column-major (CSC) or row-major (CSR).
+///
+/// Entries of major slice `k` live in `index[start[k]..start[k + 1]]` and
+/// `value[start[k]..start[k + 1]]`, keeping the input order within a slice.
+/// Index arrays are `i32` so they can be handed to the solver C APIs as-is.
+#[derive(Debug, Default)]
+pub struct CompressedMatrix {
+    pub start: Vec<i32>,
+    pub index: Vec<i32>,
+    pub value: Vec<f64>,
+    cursor: Vec<i32>,
+}
+
+impl CompressedMatrix {
+    /// Build the column-major form of `m`
+    pub fn csc(m: &ApiIntegerSparseMatrix) -> Self {
+        let mut compressed = Self::default();
+        compressed.fill_csc(m);
+        compressed
+    }
+
+    /// Build the row-major form of `m`
+    pub fn csr(m: &ApiIntegerSparseMatrix) -> Self {
+        let mut compressed = Self::default();
+        compressed.fill_csr(m);
+        compressed
+    }
+
+    /// Overwrite with the column-major form of `m`, reusing existing buffers
+    pub fn fill_csc(&mut self, m: &ApiIntegerSparseMatrix) {
+        self.fill(&m.cols, &m.rows, &m.vals, m.shape.ncols, m.shape.nrows);
+    }
+
+    /// Overwrite with the row-major form of `m`, reusing existing buffers
+    pub fn fill_csr(&mut self, m: &ApiIntegerSparseMatrix) {
+        self.fill(&m.rows, &m.cols, &m.vals, m.shape.nrows, m.shape.ncols);
+    }
+
+    /// Number of major slices (columns for CSC, rows for CSR)
+    pub fn major_len(&self) -> usize {
+        self.start.len().saturating_sub(1)
+    }
+
+    /// Number of stored entries
+    pub fn nnz(&self) -> usize {
+        self.index.len()
+    }
+
+    /// Minor indices and values of major slice `k`
+    pub fn slice(&self, k: usize) -> (&[i32], &[f64]) {
+        let range = self.start[k] as usize..self.start[k + 1] as usize;
+        (&self.index[range.clone()], &self.value[range])
+    }
+
+    /// Counting sort of coordinate entries by major index, O(nnz + n_major).
+    ///
+    /// Entries whose indices fall outside the shape are skipped.
+    fn fill(&mut self, major: &[i32], minor: &[i32], vals: &[i32], n_major: usize, n_minor: usize) {
+        let in_bounds =
+            |k: i32, j: i32| (0..n_major as i32).contains(&k) && (0..n_minor as i32).contains(&j);
+        let entries = || {
+            major
+                .iter()
+                .zip(minor)
+                .zip(vals)
+                .map(|((&k, &j), &v)| (k, j, v))
+                .filter(|&(k, j, _)| in_bounds(k, j))
+        };
+
+        // Count entries per major slice, then turn counts into slice offsets
+        self.start.clear();
+        self.start.resize(n_major + 1, 0);
+        for (k, _, _) in entries() {
+            self.start[k as usize + 1] += 1;
+        }
+        for k in 0..n_major {
+            self.start[k + 1] += self.start[k];
+        }
+
+        let nnz = self.start[n_major] as usize;
+        self.index.clear();
+        self.index.resize(nnz, 0);
+        self.value.clear();
+        self.value.resize(nnz, 0.0);
+        self.cursor.clear();
+        self.cursor.extend_from_slice(&self.start[..n_major]);
+
+        // Scatter each entry to the next free position of its slice
+        for (k, j, v) in entries() {
+            let pos = self.cursor[k as usize] as usize;
+            self.index[pos] = j;
+            self.value[pos] = v as f64;
+            self.cursor[k as usize] += 1;
+        }
+    }
+}
+
+thread_local! {
+    // Scratch buffers reused by successive model builds on the same thread
+    static SCRATCH: RefCell<CompressedMatrix> = RefCell::new(CompressedMatrix::default());
+}
+
+/// Run `f` with the column-major form of `m` in this thread's scratch buffers
+pub fn with_csc<R>(m: &ApiIntegerSparseMatrix, f: impl FnOnce(&CompressedMatrix) -> R) -> R {
+    SCRATCH.with(|scratch| {
+        let mut scratch = scratch.borrow_mut();
+        scratch.fill_csc(m);
+        f(&scratch)
+    })
+}
+
+/// Run `f` with the row-major form of `m` in this thread's scratch buffers
+pub fn with_csr<R>(m: &ApiIntegerSparseMatrix, f: impl FnOnce(&CompressedMatrix) -> R) -> R {
+    SCRATCH.with(|scratch| {
+        let mut scratch = scratch.borrow_mut();
+        scratch.fill_csr(m);
+        f(&scratch)
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::ApiShape;
+
+    // [1 2 0]
+    // [0 3 4]
+    fn create_test_matrix() -> ApiIntegerSparseMatrix {
+        ApiIntegerSparseMatrix {
+            rows: vec![1, 0, 0, 1],
+            cols: vec![2, 1, 0, 1],
+            vals: vec![4, 2, 1, 3],
+            shape: ApiShape { nrows: 2, ncols: 3 },
+        }
+    }
+
+    #[test]
+    fn test_csc_groups_entries_by_column() {
+        let csc = CompressedMatrix::csc(&create_test_matrix());
+        assert_eq!(csc.start, vec![0, 1, 3, 4]);
+        assert_eq!(csc.index, vec![0, 0, 1, 1]);
+        assert_eq!(csc.value, vec![1.0, 2.0, 3.0, 4.0]);
+        assert_eq!(csc.slice(1), (&[0, 1][..], &[2.0, 3.0][..]));
+    }
+
+    #[test]
+    fn test_csr_groups_entries_by_row() {
+        let csr = CompressedMatrix::csr(&create_test_matrix());
+        assert_eq!(csr.major_len(), 2);
+        assert_eq!(csr.slice(0), (&[1, 0][..], &[2.0, 1.0][..]));
+        assert_eq!(csr.slice(1), (&[2, 1][..], &[4.0, 3.0][..]));
+    }
+
+    #[test]
+    fn test_fill_reuses_buffers_and_handles_empty_slices() {
+        let mut compressed = CompressedMatrix::csr(&create_test_matrix());
+        compressed.fill_csc(&ApiIntegerSparseMatrix {
+            rows: vec![0],
+            cols: vec![2],
+            vals: vec![7],
+            shape: ApiShape { nrows: 1, ncols: 4 },
+        });
+        assert_eq!(compressed.start, vec![0, 0, 0, 1, 1]);
+        assert_eq!(compressed.nnz(), 1);
+        assert_eq!(compressed.slice(0), (&[][..], &[][..]));
+    }
+
+    #[test]
+    fn test_out_of_bounds_entries_are_skipped() {
+        let mut m = create_test_matrix();
+        m.rows.push(5);
+        m.cols.push(0);
+        m.vals.push(9);
+        let csc = CompressedMatrix::csc(&m);
+        assert_eq!(csc.nnz(), 4);
+    }
+}
@@ -1,6 +1,7 @@
 use std::collections::{HashMap, HashSet};
 
-use glpk_rust::Variable;
+use crate::domain::sparse;
+use crate::models::{ApiVariable, IndexedObjective, SolveRequest, SparseLEIntegerPolyhedron};
 
 pub struct SolveInputError {
     pub details: String,
@@ -15,10 +16,10 @@ impl From<glpk_rust::SolverError> for SolveInputError {
 }
 
 pub fn validate_objectives_owned(
-    variables: &Vec<Variable>,
+    variables: &[ApiVariable],
     objectives: &[HashMap<String, f64>],
 ) -> Result<(), SolveInputError> {
-    let variable_ids: HashSet<&str> = variables.iter().map(|v| v.id).collect();
+    let variable_ids: HashSet<&str> = variables.iter().map(|v| v.id.as_str()).collect();
 
     for objective in objectives {
         for objective_variable_id in objective.keys() {
@@ -36,19 +37,204 @@ pub fn validate_objectives_owned(
     Ok(())
 }
 
+pub fn validate_objectives_indexed(
+    variable_count: usize,
+    objectives: &[IndexedObjective],
+) -> Result<(), SolveInputError> {
+    // Backends keep the last coefficient of a repeated column while the
+    // reported objective value sums them, so repeats are rejected. Each
+    // column remembers the last objective it was seen in.
+    let mut last_objective = vec![usize::MAX; variable_count];
+    for (i, objective) in objectives.iter().enumerate() {
+        for &(column, _) in objective {
+            if column >= variable_count {
+                return Err(SolveInputError {
+                    details: format!(
+                        "Objective column {} is out of bounds [0, {})",
+                        column, variable_count,
+                    ),
+                });
+            }
+            if std::mem::replace(&mut last_objective[column], i) == i {
+                return Err(SolveInputError {
+                    details: format!("Objective {} repeats column {}", i, column),
+                });
+            }
+        }
+    }
+
+    Ok(())
+}
+
+/// Check the polyhedron and MIP gap of a solve request
+pub fn validate_solve_request(req: &SolveRequest) -> Result<(), SolveInputError> {
+    validate_polyhedron(&req.polyhedron)?;
+    validate_mip_gap(req.mip_gap)
+}
+
+/// Check that a requested MIP gap is a non-negative number
+pub fn validate_mip_gap(mip_gap: Option<f64>) -> Result<(), SolveInputError> {
+    if let Some(gap) = mip_gap {
+        if !gap.is_finite() || gap < 0.0 {
+            return Err(SolveInputError {
+                details: format!("MIP gap must be a non-negative number, got {}", gap),
+            });
+        }
+    }
+    Ok(())
+}
+
+/// Check the shape, size limits, index bounds and uniqueness of variable
+/// ids and matrix entries of a polyhedron
+pub fn validate_polyhedron(polyhedron: &SparseLEIntegerPolyhedron) -> Result<(), SolveInputError> {
+    let variable_count = polyhedron.variables.len();
+    let column_count = polyhedron.a.shape.ncols;
+    if variable_count != column_count {
+        return Err(SolveInputError {
+            details: format!(
+                "Number of variables must match number of columns in A got {} variables and {} columns",
+                variable_count, column_count
+            ),
+        });
+    }
+
+    let b_count = polyhedron.b.len();
+    let row_count = polyhedron.a.shape.nrows;
+    if b_count != row_count {
+        return Err(SolveInputError {
+            details: format!(
+                "Number of values in b must match number of rows in A got {} values and {} rows",
+                b_count, row_count
+            ),
+        });
+    }
+
+    // Validate sparse matrix arrays have same length
+    let rows_len = polyhedron.a.rows.len();
+    let cols_len = polyhedron.a.cols.len();
+    let vals_len = polyhedron.a.vals.len();
+    if rows_len != cols_len || rows_len != vals_len {
+        return Err(SolveInputError {
+            details: format!(
+                "Sparse matrix arrays must have same length: got rows={}, cols={}, vals={}",
+                rows_len, cols_len, vals_len
+            ),
+        });
+    }
+
+    // Input size limits (prevent DoS/OOM), checked before any O(nnz) scan
+    const MAX_VARIABLES: usize = 100_000;
+    const MAX_CONSTRAINTS: usize = 100_000;
+    const MAX_NONZEROS: usize = 1_000_000;
+
+    if variable_count > MAX_VARIABLES {
+        return Err(SolveInputError {
+            details: format!(
+                "Too many variables: {} exceeds limit of {}",
+                variable_count, MAX_VARIABLES
+            ),
+        });
+    }
+
+    if row_count > MAX_CONSTRAINTS {
+        return Err(SolveInputError {
+            details: format!(
+                "Too many constraints: {} exceeds limit of {}",
+                row_count, MAX_CONSTRAINTS
+            ),
+        });
+    }
+
+    if rows_len > MAX_NONZEROS {
+        return Err(SolveInputError {
+            details: format!(
+                "Too many non-zero elements: {} exceeds limit of {}",
+                rows_len, MAX_NONZEROS
+            ),
+        });
+    }
+
+    // Validate sparse matrix indices are within bounds; the branch-free
+    // min/max scans only fall back to a position search on failure
+    let in_range = |indices: &[i32], count: usize| {
+        let (min, max) = indices
+            .iter()
+            .fold((i32::MAX, i32::MIN), |(min, max), &index| {
+                (min.min(index), max.max(index))
+            });
+        indices.is_empty() || (min >= 0 && (max as i64) < count as i64)
+    };
+    if !in_range(&polyhedron.a.rows, row_count) || !in_range(&polyhedron.a.cols, column_count) {
+        return Err(first_index_out_of_bounds(polyhedron));
+    }
+
+    let mut variable_ids: HashSet<&str> = HashSet::with_capacity(variable_count);
+    for variable in &polyhedron.variables {
+        if !variable_ids.insert(variable.id.as_str()) {
+            return Err(SolveInputError {
+                details: format!("Duplicate variable id {}", variable.id),
+            });
+        }
+    }
+
+    // Solvers reject or abort on repeated (row, column) entries. Rows are
+    // grouped as for the solver builds, and each column remembers the last
+    // row it was seen in.
+    sparse::with_csr(&polyhedron.a, |csr| {
+        let mut last_row = vec![usize::MAX; column_count];
+        for row in 0..csr.major_len() {
+            for &col in csr.slice(row).0 {
+                if std::mem::replace(&mut last_row[col as usize], row) == row {
+                    return Err(SolveInputError {
+                        details: format!("Duplicate entry at row {} column {}", row, col),
+                    });
+                }
+            }
+        }
+        Ok(())
+    })
+}
+
+/// Error of the first sparse matrix position with an out of bounds index
+fn first_index_out_of_bounds(polyhedron: &SparseLEIntegerPolyhedron) -> SolveInputError {
+    let row_count = polyhedron.a.shape.nrows;
+    let column_count = polyhedron.a.shape.ncols;
+    for (i, (&row, &col)) in polyhedron.a.rows.iter().zip(&polyhedron.a.cols).enumerate() {
+        if row < 0 || row >= row_count as i32 {
+            return SolveInputError {
+                details: format!(
+                    "Row index {} at position {} is out of bounds [0, {})",
+                    row, i, row_count
+                ),
+            };
+        }
+
+        if col < 0 || col >= column_count as i32 {
+            return SolveInputError {
+                details: format!(
+                    "Column index {} at position {} is out of bounds [0, {})",
+                    col, i, column_count
+                ),
+            };
+        }
+    }
+    unreachable!("an index is out of bounds")
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::models::{ApiIntegerSparseMatrix, ApiShape};
 
     #[test]
     fn test_validate_objectives_given_valid_objectives() {
         let variables = vec![
-            Variable {
-                id: "x1",
+            ApiVariable {
+                id: "x1".to_string(),
                 bound: (0, 1),
             },
-            Variable {
-                id: "x2",
+            ApiVariable {
+                id: "x2".to_string(),
                 bound: (0, 1),
             },
         ];
@@ -62,12 +248,12 @@ mod tests {
     #[test]
     fn test_validate_objectives_given_missing_variable() {
         let variables = vec![
-            Variable {
-                id: "x1",
+            ApiVariable {
+                id: "x1".to_string(),
                 bound: (0, 1),
             },
-            Variable {
-                id: "x2",
+            ApiVariable {
+                id: "x2".to_string(),
                 bound: (0, 1),
             },
         ];
@@ -77,4 +263,92 @@ mod tests {
         ])];
         assert!(validate_objectives_owned(&variables, &objectives).is_err());
     }
+
+    fn create_test_polyhedron() -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0, 0, 1],
+                cols: vec![0, 1, 1],
+                vals: vec![1, 1, 1],
+                shape: ApiShape { nrows: 2, ncols: 2 },
+            },
+            b: vec![1, 1],
+            variables: vec![
+                ApiVariable {
+                    id: "x1".to_string(),
+                    bound: (0, 1),
+                },
+                ApiVariable {
+                    id: "x2".to_string(),
+                    bound: (0, 1),
+                },
+            ],
+        }
+    }
+
+    fn details(polyhedron: &SparseLEIntegerPolyhedron) -> String {
+        match validate_polyhedron(polyhedron) {
+            Ok(()) => String::new(),
+            Err(error) => error.details,
+        }
+    }
+
+    #[test]
+    fn test_validate_polyhedron_reports_first_out_of_bounds_index() {
+        let mut polyhedron = create_test_polyhedron();
+        assert_eq!(details(&polyhedron), "");
+
+        polyhedron.a.cols[2] = 2;
+        polyhedron.a.rows[1] = -1;
+        assert_eq!(
+            details(&polyhedron),
+            "Row index -1 at position 1 is out of bounds [0, 2)"
+        );
+        polyhedron.a.rows[1] = 0;
+        assert_eq!(
+            details(&polyhedron),
+            "Column index 2 at position 2 is out of bounds [0, 2)"
+        );
+    }
+
+    #[test]
+    fn test_validate_polyhedron_checks_limits_before_indices() {
+        let mut polyhedron = create_test_polyhedron();
+        polyhedron.a.rows = vec![-1; 1_000_001];
+        polyhedron.a.cols = vec![0; 1_000_001];
+        polyhedron.a.vals = vec![1; 1_000_001];
+        assert!(details(&polyhedron).starts_with("Too many non-zero elements"));
+    }
+
+    #[test]
+    fn test_validate_polyhedron_rejects_duplicates() {
+        let mut polyhedron = create_test_polyhedron();
+        polyhedron.variables[1].id = "x1".to_string();
+        assert_eq!(details(&polyhedron), "Duplicate variable id x1");
+
+        let mut polyhedron = create_test_polyhedron();
+        polyhedron.a.rows.push(1);
+        polyhedron.a.cols.push(1);
+        polyhedron.a.vals.push(2);
+        assert_eq!(details(&polyhedron), "Duplicate entry at row 1 column 1");
+    }
+
+    #[test]
+    fn test_validate_objectives_indexed_given_out_of_bounds_column() {
+        let objectives = vec![vec![(0, 1.0), (1, 2.0)]];
+        assert!(validate_objectives_indexed(2, &objectives).is_ok());
+        assert!(validate_objectives_indexed(1, &objectives).is_err());
+    }
+
+    #[test]
+    fn test_validate_objectives_indexed_rejects_repeated_column() {
+        let objectives = vec![vec![(0, 1.0)], vec![(0, 3.0), (1, 2.0)]];
+        assert!(validate_objectives_indexed(2, &objectives).is_ok());
+
+        let objectives = vec![vec![(0, 1.0)], vec![(0, 3.0), (1, 2.0), (0, -1.0)]];
+        match validate_objectives_indexed(2, &objectives) {
+            Ok(()) => panic!("repeated column accepted"),
+            Err(error) => assert_eq!(error.details, "Objective 1 repeats column 0"),
+        }
+    }
 }
@@ -0,0 +1,12 @@
+//! Wire types, conversions and solver backends of the solver API, shared by
+//! the server binary, the benchmarks and the examples.
+
+pub mod binary;
+pub mod coalesce;
+pub mod convert;
+pub mod domain;
+pub mod metrics;
+pub mod models;
+pub mod registry;
+pub mod scheduler;
+pub mod warmup;
@@ -1,188 +1,798 @@
-mod convert;
-mod domain;
-mod models;
-
-use models::SolveRequest;
+use rust_solver_api::models::{
+    ApiSolution, ApiStreamedSolution, BatchSolveRequest, ModelSolveRequest, RegisterModelRequest,
+    SolveRequest, SparseLEIntegerPolyhedron,
+};
+use rust_solver_api::registry::ModelRegistry;
+use rust_solver_api::{binary, metrics, warmup};
 
-use domain::solver::Solver;
-use domain::solver_factory::{create_solver_with_cache, SolverType};
+use rust_solver_api::coalesce::{CoalesceConfig, Coalescer, SolveFailure, SolveOutcome};
+use rust_solver_api::domain::fingerprint::{Fingerprint, SolveKey};
+use rust_solver_api::domain::model_cache::ModelCacheConfig;
+use rust_solver_api::domain::reduction::ReducingSolver;
+use rust_solver_api::domain::solution_cache::CachingSolver;
+use rust_solver_api::domain::solver::{CancelToken, SolveLimits, SolveOptions, Solver};
+use rust_solver_api::domain::solver_factory::{create_solver_with_cache, SolverType};
+use rust_solver_api::domain::validate;
+use rust_solver_api::metrics::Phase;
+use rust_solver_api::scheduler::{
+    cost_units, Job, Permits, Priority, Rejection, Scheduler, SchedulerConfig, ThreadBudget,
+    ThreadPolicy,
+};
 
 use actix_web::body::BoxBody;
-use actix_web::http::header::HeaderName;
-use actix_web::middleware::{from_fn, Condition, Logger, Next};
+use actix_web::dev::Payload;
+use actix_web::http::header::{ContentEncoding, ContentType, HeaderName, ACCEPT, RETRY_AFTER};
+use actix_web::middleware::{from_fn, Compress, Condition, Logger, Next};
 use actix_web::{
     dev::{ServiceRequest, ServiceResponse},
     Error,
 };
-use actix_web::{web, App, HttpResponse, HttpServer, Responder};
+use actix_web::{
+    web, App, FromRequest, HttpMessage, HttpRequest, HttpResponse, HttpServer, Responder,
+};
+use futures_util::future::LocalBoxFuture;
+use futures_util::StreamExt;
 
 use dotenv::dotenv;
+use std::convert::Infallible;
 use std::env;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::time::{Duration, Instant};
 
 use sentry_actix::Sentry;
 use std::sync::Arc;
 use subtle::ConstantTimeEq;
 
-// ---------- Route handlers ----------
-/// POST /solve
-pub async fn solve(
-    req: web::Json<SolveRequest>,
-    solver: web::Data<Box<dyn Solver>>,
-    use_presolve: web::Data<bool>,
-    solver_semaphore: web::Data<Arc<tokio::sync::Semaphore>>,
-) -> impl Responder {
-    match validate_solve_request(&req) {
-        Ok(_) => (),
-        Err(response) => return response,
+/// Server-wide solve configuration
+#[derive(Clone, Copy)]
+struct SolveSettings {
+    use_presolve: bool,
+    /// Spread the objectives of one request over idle solver slots
+    parallel_objectives: bool,
+    /// Deadline of requests without an `X-Deadline-Ms` header
+    default_deadline: Option<Duration>,
+    /// Default and upper bound of the per-request time limit
+    time_limit: Option<Duration>,
+    /// MIP gap of requests that do not set one
+    mip_gap: Option<f64>,
+    /// Threads of each solver instance, `ThreadBudget::threads_per_slot`
+    threads: usize,
+    /// Solver slots, the number of `/solve/batch` items solved at once
+    slots: usize,
+    /// Default and upper bound of the time to live of registered models
+    model_ttl: Duration,
+}
+
+impl SolveSettings {
+    /// Limits of `req`: its own time limit capped by the server's, and its
+    /// MIP gap or the server default
+    fn limits_for(&self, req: &SolveRequest) -> SolveLimits {
+        let requested = req.time_limit_ms.map(Duration::from_millis);
+        SolveLimits {
+            time_limit: match (requested, self.time_limit) {
+                (Some(requested), Some(limit)) => Some(requested.min(limit)),
+                (requested, limit) => requested.or(limit),
+            },
+            mip_gap: req.mip_gap.or(self.mip_gap),
+        }
     }
+}
 
-    // Acquire an owned permit asynchronously before spawning the blocking task.
-    let sem = solver_semaphore.get_ref().clone();
-    let permit = match sem.acquire_owned().await {
-        Ok(p) => p,
-        Err(e) => {
-            sentry::capture_message(
-                &format!("Failed to acquire semaphore permit: {}", e),
-                sentry::Level::Error,
-            );
-            return HttpResponse::InternalServerError()
-                .json(serde_json::json!({ "error": "Something went wrong"}));
+/// Solutions buffered per streaming request before the solver waits for the client
+const STREAM_BUFFER: usize = 16;
+
+// ---------- Request bodies ----------
+/// A solve request in either wire format.
+///
+/// Bodies with the `binary::CONTENT_TYPE` content type are decoded from the
+/// binary format (limited by `PayloadConfig`), anything else goes through
+/// `web::Json` and its `JsonConfig`. `binary_response` is set when the client
+/// accepts a binary response.
+pub struct SolvePayload {
+    request: SolveRequest,
+    binary_response: bool,
+}
+
+impl FromRequest for SolvePayload {
+    type Error = Error;
+    type Future = LocalBoxFuture<'static, Result<Self, Self::Error>>;
+
+    fn from_request(req: &HttpRequest, payload: &mut Payload) -> Self::Future {
+        let binary_response = req
+            .headers()
+            .get(ACCEPT)
+            .and_then(|accept| accept.to_str().ok())
+            .is_some_and(|accept| accept.contains(binary::CONTENT_TYPE));
+
+        let start = Instant::now();
+        if req.content_type() == binary::CONTENT_TYPE {
+            let body = web::Bytes::from_request(req, payload);
+            Box::pin(async move {
+                let decoded = binary::decode_request(&body.await?);
+                metrics::global().observe(Phase::Parse, start.elapsed());
+                let request = decoded.map_err(|e| {
+                    let response =
+                        HttpResponse::BadRequest().json(serde_json::json!({ "error": e.details }));
+                    actix_web::error::InternalError::from_response(e.details, response)
+                })?;
+                Ok(SolvePayload {
+                    request,
+                    binary_response,
+                })
+            })
+        } else {
+            let json = web::Json::<SolveRequest>::from_request(req, payload);
+            Box::pin(async move {
+                let request = json.await;
+                metrics::global().observe(Phase::Parse, start.elapsed());
+                Ok(SolvePayload {
+                    request: request?.into_inner(),
+                    binary_response,
+                })
+            })
         }
+    }
+}
+
+// ---------- Route handlers ----------
+static X_PRIORITY: HeaderName = HeaderName::from_static("x-priority");
+static X_DEADLINE_MS: HeaderName = HeaderName::from_static("x-deadline-ms");
+
+/// Scheduling class, estimated cost and deadline of a request.
+///
+/// Missing or unparsable `X-Priority` headers mean normal priority, and
+/// `X-Deadline-Ms` falls back to `SOLVE_DEADLINE_MS`.
+fn job_for(
+    http_req: &HttpRequest,
+    polyhedron: &SparseLEIntegerPolyhedron,
+    objective_count: usize,
+    settings: &SolveSettings,
+) -> Job {
+    let header = |name: &HeaderName| {
+        http_req
+            .headers()
+            .get(name)
+            .and_then(|value| value.to_str().ok())
+    };
+    let priority = header(&X_PRIORITY)
+        .and_then(Priority::parse)
+        .unwrap_or(Priority::Normal);
+    let deadline = header(&X_DEADLINE_MS)
+        .and_then(|ms| ms.trim().parse::<u64>().ok())
+        .map(Duration::from_millis)
+        .or(settings.default_deadline)
+        .map(|budget| Instant::now() + budget);
+    Job {
+        priority,
+        units: cost_units(
+            polyhedron.a.vals.len(),
+            polyhedron.a.shape.nrows,
+            polyhedron.a.shape.ncols,
+            objective_count,
+        ),
+        deadline,
+    }
+}
+
+/// Acquire the solver permits for one request.
+///
+/// Waits in the scheduler queue for a single permit, then opportunistically
+/// takes extra idle permits (never waiting) so a request with many objectives
+/// can solve them on several threads at once.
+async fn acquire_solver_permits(
+    scheduler: &Scheduler,
+    settings: &SolveSettings,
+    job: Job,
+    objective_count: usize,
+) -> Result<Permits, Rejection> {
+    let metrics = metrics::global();
+    let start = Instant::now();
+    metrics.queue_entered();
+    let extra = if settings.parallel_objectives {
+        objective_count.saturating_sub(1)
+    } else {
+        0
     };
+    let acquired = scheduler.acquire(job, extra).await;
+    metrics.queue_left();
+    metrics.observe(Phase::Queue, start.elapsed());
+    acquired
+}
+
+fn rejection_message(rejection: &Rejection) -> &'static str {
+    match rejection {
+        Rejection::QueueFull { .. } => "Too many queued solve requests",
+        Rejection::Deadline { .. } => "Solve cannot finish before its deadline",
+    }
+}
+
+/// 429 for a full queue, 503 for a missed deadline, both with `Retry-After`
+fn rejected_response(rejection: Rejection) -> HttpResponse {
+    let error = rejection_message(&rejection);
+    let mut response = match rejection {
+        Rejection::QueueFull { .. } => HttpResponse::TooManyRequests(),
+        Rejection::Deadline { .. } => HttpResponse::ServiceUnavailable(),
+    };
+    let retry_after = rejection.retry_after().as_secs_f64().ceil().max(1.0) as u64;
+    response
+        .insert_header((RETRY_AFTER, retry_after.to_string()))
+        .json(serde_json::json!({ "error": error }))
+}
+
+/// Acquire permits and run one solve on a blocking thread
+async fn run_solve(
+    req: SolveRequest,
+    fingerprint: Fingerprint,
+    job: Job,
+    solver: web::Data<Box<dyn Solver>>,
+    settings: &SolveSettings,
+    scheduler: web::Data<Scheduler>,
+) -> SolveOutcome {
+    // Acquire owned permits asynchronously before spawning the blocking task.
+    let permits = acquire_solver_permits(&scheduler, settings, job, req.objectives.count())
+        .await
+        .map_err(SolveFailure::Rejected)?;
 
+    let limits = settings.limits_for(&req);
     let SolveRequest {
         polyhedron,
         objectives,
         direction,
-    } = req.into_inner();
+        hint,
+        ..
+    } = req;
+    let cancel = CancelToken::default();
+    let options = SolveOptions {
+        use_presolve: settings.use_presolve,
+        parallelism: permits.count(),
+        threads: settings.threads,
+        hint,
+        limits,
+        cancel: cancel.clone(),
+    };
+
+    // Dropping this future (the client went away) stops the blocking solve
+    let _cancel_on_drop = cancel.cancel_on_drop();
     let solve_task_result = tokio::task::spawn_blocking(move || {
-        // Hold the permit for the duration of the blocking solver call by moving
-        // it into the closure. It will be released automatically when dropped.
-        let _permit = permit;
-        solver.solve(polyhedron, objectives, direction, *use_presolve.get_ref())
+        // Hold the permits for the duration of the blocking solver call by moving
+        // them into the closure. They will be released automatically when dropped.
+        let _permits = permits;
+        let start = Instant::now();
+        let solved = solver.solve(polyhedron, fingerprint, objectives, direction, options);
+        scheduler.record(job.units, start.elapsed());
+        if solved.is_err() && cancel.is_cancelled() {
+            metrics::global().solve_cancelled();
+        }
+        solved
     })
     .await;
 
-    let solve_result = match solve_task_result {
+    match solve_task_result {
         Err(e) => {
             sentry::capture_message(
                 &format!("Solver thread did not complete successfully: {}", e),
                 sentry::Level::Error,
             );
-            return HttpResponse::InternalServerError().json(serde_json::json!({
-                "error": "Something went wrong",
-            }));
+            Err(SolveFailure::Internal)
         }
-        Ok(res) => res,
+        Ok(Ok(api_solutions)) => Ok(Arc::new(api_solutions)),
+        Ok(Err(error)) => {
+            // Capture error with breadcrumb context
+            sentry::capture_message(
+                &format!("Solve failed: {}", error.details),
+                sentry::Level::Error,
+            );
+            Err(SolveFailure::Input(error.details))
+        }
+    }
+}
+
+/// POST /solve
+///
+/// Identical requests in flight at the same time share one solve, and with
+/// `RESULT_CACHE_TTL_MS` set recent results are answered without solving.
+pub async fn solve(
+    http_req: HttpRequest,
+    payload: SolvePayload,
+    solver: web::Data<Box<dyn Solver>>,
+    settings: web::Data<SolveSettings>,
+    scheduler: web::Data<Scheduler>,
+    coalescer: web::Data<Coalescer>,
+) -> impl Responder {
+    let SolvePayload {
+        request: req,
+        binary_response,
+    } = payload;
+    match metrics::timed(Phase::Validate, || validate_solve_request(&req)) {
+        Ok(_) => (),
+        Err(response) => return response,
+    }
+
+    // Binary responses lay out solution values in request variable order
+    let variable_ids: Vec<String> = if binary_response {
+        req.polyhedron
+            .variables
+            .iter()
+            .map(|v| v.id.clone())
+            .collect()
+    } else {
+        Vec::new()
     };
 
+    // Computed once here so solvers never hash the full polyhedron themselves
+    let fingerprint = Fingerprint::of(&req.polyhedron);
+    let key = SolveKey::of(
+        fingerprint,
+        &req.objectives,
+        req.direction,
+        req.hint.as_ref(),
+        settings.limits_for(&req),
+    );
+    let job = job_for(
+        &http_req,
+        &req.polyhedron,
+        req.objectives.count(),
+        &settings,
+    );
+    let solve_result = coalescer
+        .run(key, || {
+            run_solve(req, fingerprint, job, solver, &settings, scheduler)
+        })
+        .await;
+
+    match solve_result {
+        Ok(api_solutions) if binary_response => {
+            let body = metrics::timed(Phase::Serialize, || {
+                binary::encode_response(&api_solutions, &variable_ids)
+            });
+            HttpResponse::Ok()
+                .content_type(binary::CONTENT_TYPE)
+                .body(body)
+        }
+        solve_result => json_response(solve_result),
+    }
+}
+
+/// JSON response of a finished `/solve`: the solutions or an error status
+fn json_response(solve_result: SolveOutcome) -> HttpResponse {
     match solve_result {
         Ok(api_solutions) => {
-            HttpResponse::Ok().json(serde_json::json!({ "solutions": api_solutions }))
+            let body = metrics::timed(Phase::Serialize, || {
+                serde_json::to_vec(&serde_json::json!({ "solutions": *api_solutions }))
+            });
+            match body {
+                Ok(body) => HttpResponse::Ok()
+                    .content_type(ContentType::json())
+                    .body(body),
+                Err(e) => {
+                    sentry::capture_message(
+                        &format!("Failed to serialize solutions: {}", e),
+                        sentry::Level::Error,
+                    );
+                    HttpResponse::InternalServerError().json(serde_json::json!({
+                        "error": "Something went wrong",
+                    }))
+                }
+            }
         }
-        Err(error) => {
-            // Capture error with breadcrumb context
+        Err(SolveFailure::Input(details)) => {
+            HttpResponse::UnprocessableEntity().json(serde_json::json!({
+                "error": details,
+            }))
+        }
+        Err(SolveFailure::Rejected(rejection)) => rejected_response(rejection),
+        Err(SolveFailure::Internal) => {
+            HttpResponse::InternalServerError().json(serde_json::json!({
+                "error": "Something went wrong",
+            }))
+        }
+    }
+}
+
+/// POST /models
+///
+/// Validates a polyhedron, builds its model and keeps it in the model cache
+/// under the returned id until `DELETE /models/{id}` or until it has not
+/// been used for `ttl_ms` (default and upper bound `MODEL_TTL_MS`). Uploads
+/// that would take the registered models over `MODEL_REGISTRY_BYTES` get 507.
+pub async fn register_model(
+    http_req: HttpRequest,
+    body: web::Json<RegisterModelRequest>,
+    solver: web::Data<Box<dyn Solver>>,
+    settings: web::Data<SolveSettings>,
+    scheduler: web::Data<Scheduler>,
+    registry: web::Data<ModelRegistry>,
+) -> HttpResponse {
+    let RegisterModelRequest { polyhedron, ttl_ms } = body.into_inner();
+    if let Err(error) = metrics::timed(Phase::Validate, || {
+        validate::validate_polyhedron(&polyhedron)
+    }) {
+        return HttpResponse::UnprocessableEntity()
+            .json(serde_json::json!({ "error": error.details }));
+    }
+
+    // Building a model is solver work, so it waits for a permit like a solve
+    let job = job_for(&http_req, &polyhedron, 1, &settings);
+    let permits = match acquire_solver_permits(&scheduler, &settings, job, 1).await {
+        Ok(permits) => permits,
+        Err(rejection) => return rejected_response(rejection),
+    };
+
+    let ttl = ttl_ms.map_or(settings.model_ttl, |ms| {
+        Duration::from_millis(ms).min(settings.model_ttl)
+    });
+    let fingerprint = Fingerprint::of(&polyhedron);
+    let polyhedron = Arc::new(polyhedron);
+    // Pinned before it is built, so the build cannot be evicted right away
+    let registration = match registry.register(
+        solver.get_ref().as_ref(),
+        polyhedron.clone(),
+        fingerprint,
+        ttl,
+    ) {
+        Ok(registration) => registration,
+        Err(full) => {
+            return HttpResponse::InsufficientStorage().json(serde_json::json!({
+                "error": format!(
+                    "Registered models use {} of {} bytes, no room for {} more",
+                    full.registered_bytes, full.budget_bytes, full.model_bytes
+                ),
+            }))
+        }
+    };
+    let id = registration.id;
+    let use_presolve = settings.use_presolve;
+    let warm_solver = solver.clone();
+    let built = tokio::task::spawn_blocking(move || {
+        let _permits = permits;
+        warm_solver.warm(&polyhedron, fingerprint, use_presolve)
+    })
+    .await;
+
+    match built {
+        Ok(Ok(())) => HttpResponse::Created().json(serde_json::json!({
+            "id": id,
+            "ttl_ms": ttl.as_millis() as u64,
+        })),
+        Ok(Err(error)) => {
+            // An earlier registration of the polyhedron stays valid
+            if registration.created {
+                registry.remove(solver.get_ref().as_ref(), &id);
+            }
+            HttpResponse::UnprocessableEntity().json(serde_json::json!({ "error": error.details }))
+        }
+        Err(e) => {
+            if registration.created {
+                registry.remove(solver.get_ref().as_ref(), &id);
+            }
             sentry::capture_message(
-                &format!("Solve failed: {}", error.details),
+                &format!("Model build thread did not complete successfully: {}", e),
                 sentry::Level::Error,
             );
-            HttpResponse::UnprocessableEntity().json(serde_json::json!({
-                "error": error.details,
+            HttpResponse::InternalServerError().json(serde_json::json!({
+                "error": "Something went wrong",
             }))
         }
     }
 }
 
-fn validate_solve_request(req: &SolveRequest) -> Result<(), HttpResponse> {
-    let variable_count = req.polyhedron.variables.len();
-    let column_count = req.polyhedron.a.shape.ncols;
-    if variable_count != column_count {
-        return Err(HttpResponse::UnprocessableEntity().json(
-            serde_json::json!({
-                "error": format!("Number of variables must match number of columns in A got {} variables and {} columns", variable_count, column_count)
-            }),
-        ));
+fn model_not_found() -> HttpResponse {
+    HttpResponse::NotFound().json(serde_json::json!({ "error": "Model not found" }))
+}
+
+/// POST /models/{id}/solve
+///
+/// Solves objectives against a registered model. The body is a `/solve`
+/// request without `polyhedron`; the response is the same as from `/solve`.
+pub async fn solve_model(
+    http_req: HttpRequest,
+    body: web::Json<ModelSolveRequest>,
+    solver: web::Data<Box<dyn Solver>>,
+    settings: web::Data<SolveSettings>,
+    scheduler: web::Data<Scheduler>,
+    coalescer: web::Data<Coalescer>,
+    registry: web::Data<ModelRegistry>,
+) -> HttpResponse {
+    let Some(model) = registry.get(http_req.match_info().query("id")) else {
+        return model_not_found();
+    };
+    let body = body.into_inner();
+    if let Err(error) = validate::validate_mip_gap(body.mip_gap) {
+        return HttpResponse::UnprocessableEntity()
+            .json(serde_json::json!({ "error": error.details }));
     }
 
-    let b_count = req.polyhedron.b.len();
-    let row_count = req.polyhedron.a.shape.nrows;
-    if b_count != row_count {
-        return Err(HttpResponse::UnprocessableEntity().json(
-            serde_json::json!({
-                "error": format!("Number of values in b must match number of rows in A got {} values and {} rows", b_count, row_count)
-            }),
-        ));
+    // The polyhedron was validated and fingerprinted when it was registered
+    let req = body.with_polyhedron(model.polyhedron.clone());
+    let key = SolveKey::of(
+        model.fingerprint,
+        &req.objectives,
+        req.direction,
+        req.hint.as_ref(),
+        settings.limits_for(&req),
+    );
+    let job = job_for(
+        &http_req,
+        &req.polyhedron,
+        req.objectives.count(),
+        &settings,
+    );
+    let solve_result = coalescer
+        .run(key, || {
+            run_solve(req, model.fingerprint, job, solver, &settings, scheduler)
+        })
+        .await;
+    json_response(solve_result)
+}
+
+/// DELETE /models/{id}
+///
+/// Drops a registered model and releases it in the model cache
+pub async fn delete_model(
+    id: web::Path<String>,
+    solver: web::Data<Box<dyn Solver>>,
+    registry: web::Data<ModelRegistry>,
+) -> HttpResponse {
+    if registry.remove(solver.get_ref().as_ref(), &id) {
+        HttpResponse::NoContent().finish()
+    } else {
+        model_not_found()
     }
+}
 
-    // Validate sparse matrix arrays have same length
-    let rows_len = req.polyhedron.a.rows.len();
-    let cols_len = req.polyhedron.a.cols.len();
-    let vals_len = req.polyhedron.a.vals.len();
-    if rows_len != cols_len || rows_len != vals_len {
-        return Err(HttpResponse::UnprocessableEntity().json(
-            serde_json::json!({
-                "error": format!("Sparse matrix arrays must have same length: got rows={}, cols={}, vals={}", rows_len, cols_len, vals_len)
-            }),
-        ));
+/// POST /solve/stream
+///
+/// Responds with newline-delimited JSON, one `{"index": .., "solution": ..}`
+/// line per objective as soon as it is solved (in completion order). Input
+/// errors get the same 422 response as `/solve`; a failure after the first
+/// solution ends the stream with an `{"error": ..}` line.
+pub async fn solve_stream(
+    http_req: HttpRequest,
+    payload: SolvePayload,
+    solver: web::Data<Box<dyn Solver>>,
+    settings: web::Data<SolveSettings>,
+    scheduler: web::Data<Scheduler>,
+) -> HttpResponse {
+    let req = payload.request;
+    if let Err(response) = metrics::timed(Phase::Validate, || validate_solve_request(&req)) {
+        return response;
     }
 
-    // Validate sparse matrix indices are within bounds
-    for i in 0..rows_len {
-        let row = req.polyhedron.a.rows[i];
-        let col = req.polyhedron.a.cols[i];
+    let job = job_for(
+        &http_req,
+        &req.polyhedron,
+        req.objectives.count(),
+        &settings,
+    );
+    let permits =
+        match acquire_solver_permits(&scheduler, &settings, job, req.objectives.count()).await {
+            Ok(permits) => permits,
+            Err(rejection) => return rejected_response(rejection),
+        };
 
-        if row < 0 || row >= row_count as i32 {
-            return Err(HttpResponse::UnprocessableEntity().json(
-                serde_json::json!({
-                    "error": format!("Row index {} at position {} is out of bounds [0, {})", row, i, row_count)
-                }),
-            ));
+    let limits = settings.limits_for(&req);
+    let SolveRequest {
+        polyhedron,
+        objectives,
+        direction,
+        hint,
+        ..
+    } = req;
+    let cancel = CancelToken::default();
+    let options = SolveOptions {
+        use_presolve: settings.use_presolve,
+        parallelism: permits.count(),
+        threads: settings.threads,
+        hint,
+        limits,
+        cancel: cancel.clone(),
+    };
+    let fingerprint = Fingerprint::of(&polyhedron);
+    // Held by the handler and then the response stream, so a client that
+    // goes away stops the blocking solve
+    let cancel_on_drop = cancel.cancel_on_drop();
+
+    // A bounded channel keeps memory flat: a slow client stalls the solver
+    // instead of piling up serialized solutions
+    let (tx, mut rx) =
+        tokio::sync::mpsc::channel::<Result<(usize, ApiSolution), String>>(STREAM_BUFFER);
+    tokio::task::spawn_blocking(move || {
+        let _permits = permits;
+        let start = Instant::now();
+        let result = solver.solve_each(
+            polyhedron,
+            fingerprint,
+            objectives,
+            direction,
+            options,
+            &|index, solution| {
+                // A closed channel means the client went away
+                let _ = tx.blocking_send(Ok((index, solution)));
+            },
+        );
+        scheduler.record(job.units, start.elapsed());
+        if let Err(error) = result {
+            if cancel.is_cancelled() {
+                metrics::global().solve_cancelled();
+            }
+            let _ = tx.blocking_send(Err(error.details));
         }
+    });
 
-        if col < 0 || col >= column_count as i32 {
-            return Err(HttpResponse::UnprocessableEntity().json(
-                serde_json::json!({
-                    "error": format!("Column index {} at position {} is out of bounds [0, {})", col, i, column_count)
-                }),
-            ));
+    // Wait for the first event so input errors still get a proper status code
+    let first = match rx.recv().await {
+        Some(Err(details)) => {
+            sentry::capture_message(&format!("Solve failed: {}", details), sentry::Level::Error);
+            return HttpResponse::UnprocessableEntity()
+                .json(serde_json::json!({ "error": details }));
         }
-    }
+        first => first,
+    };
 
-    // Input size limits (prevent DoS/OOM)
-    const MAX_VARIABLES: usize = 100_000;
-    const MAX_CONSTRAINTS: usize = 100_000;
-    const MAX_NONZEROS: usize = 1_000_000;
+    let lines = futures_util::stream::unfold(
+        (first, rx, cancel_on_drop),
+        |(pending, mut rx, cancel_on_drop)| async move {
+            let event = match pending {
+                Some(event) => event,
+                None => rx.recv().await?,
+            };
+            Some((
+                Ok::<_, Infallible>(ndjson_line(event)),
+                (None, rx, cancel_on_drop),
+            ))
+        },
+    );
 
-    if variable_count > MAX_VARIABLES {
-        return Err(HttpResponse::UnprocessableEntity().json(
-            serde_json::json!({
-                "error": format!("Too many variables: {} exceeds limit of {}", variable_count, MAX_VARIABLES)
-            }),
-        ));
+    // Compressed encoders hold back short lines, so solutions are streamed
+    // as they are found without content encoding
+    HttpResponse::Ok()
+        .content_type("application/x-ndjson")
+        .insert_header(ContentEncoding::Identity)
+        .streaming(lines)
+}
+
+/// Serialize one streamed solve event as a JSON line
+fn ndjson_line(event: Result<(usize, ApiSolution), String>) -> web::Bytes {
+    let start = Instant::now();
+    let mut line = match event {
+        Ok((index, solution)) => serde_json::to_vec(&ApiStreamedSolution { index, solution }),
+        Err(details) => {
+            sentry::capture_message(&format!("Solve failed: {}", details), sentry::Level::Error);
+            serde_json::to_vec(&serde_json::json!({ "error": details }))
+        }
     }
+    .unwrap_or_default();
+    line.push(b'\n');
+    metrics::global().observe(Phase::Serialize, start.elapsed());
+    web::Bytes::from(line)
+}
 
-    if row_count > MAX_CONSTRAINTS {
-        return Err(HttpResponse::UnprocessableEntity().json(
-            serde_json::json!({
-                "error": format!("Too many constraints: {} exceeds limit of {}", row_count, MAX_CONSTRAINTS)
-            }),
-        ));
+/// Items of a `/solve/batch` body: a JSON array, or one request per line
+fn parse_batch(body: &[u8], ndjson: bool) -> Result<Vec<BatchSolveRequest>, String> {
+    if !ndjson {
+        return serde_json::from_slice(body).map_err(|e| e.to_string());
     }
+    body.split(|&byte| byte == b'\n')
+        .enumerate()
+        .filter(|(_, line)| !line.iter().all(u8::is_ascii_whitespace))
+        .map(|(idx, line)| {
+            serde_json::from_slice(line).map_err(|e| format!("Line {}: {}", idx + 1, e))
+        })
+        .collect()
+}
 
-    if rows_len > MAX_NONZEROS {
-        return Err(HttpResponse::UnprocessableEntity().json(
-            serde_json::json!({
-                "error": format!("Too many non-zero elements: {} exceeds limit of {}", rows_len, MAX_NONZEROS)
-            }),
-        ));
+/// POST /solve/batch
+///
+/// Solves many independent requests, each tagged with an `"id"`, sent as a
+/// JSON array or as NDJSON (`application/x-ndjson`). Items go through the
+/// same validation and scheduler as `/solve`, at most one per solver slot
+/// at a time, and the next items are only started as the client reads the
+/// results. Responds with one NDJSON line per item in completion order,
+/// `{"id": .., "solutions": [..]}` or `{"id": .., "error": ..}`.
+pub async fn solve_batch(
+    http_req: HttpRequest,
+    body: web::Bytes,
+    solver: web::Data<Box<dyn Solver>>,
+    settings: web::Data<SolveSettings>,
+    scheduler: web::Data<Scheduler>,
+) -> HttpResponse {
+    let start = Instant::now();
+    let parsed = parse_batch(&body, http_req.content_type() == "application/x-ndjson");
+    metrics::global().observe(Phase::Parse, start.elapsed());
+    let items = match parsed {
+        Ok(items) => items,
+        Err(error) => {
+            return HttpResponse::BadRequest().json(serde_json::json!({ "error": error }))
+        }
+    };
+
+    let slots = settings.slots;
+    let lines = futures_util::stream::iter(items)
+        .map(move |BatchSolveRequest { id, request }| {
+            let job = job_for(
+                &http_req,
+                &request.polyhedron,
+                request.objectives.count(),
+                &settings,
+            );
+            let solver = solver.clone();
+            let settings = settings.clone();
+            let scheduler = scheduler.clone();
+            async move {
+                let solved = match metrics::timed(Phase::Validate, || {
+                    validate::validate_solve_request(&request)
+                }) {
+                    Ok(()) => {
+                        let fingerprint = Fingerprint::of(&request.polyhedron);
+                        run_solve(request, fingerprint, job, solver, &settings, scheduler).await
+                    }
+                    Err(error) => Err(SolveFailure::Input(error.details)),
+                };
+                Ok::<_, Infallible>(batch_line(id, solved))
+            }
+        })
+        .buffer_unordered(slots);
+
+    // Compressed encoders hold back short lines, so solutions are streamed
+    // as they are found without content encoding
+    HttpResponse::Ok()
+        .content_type("application/x-ndjson")
+        .insert_header(ContentEncoding::Identity)
+        .streaming(lines)
+}
+
+/// Serialize the result of one batch item as a JSON line
+fn batch_line(id: String, solved: SolveOutcome) -> web::Bytes {
+    let start = Instant::now();
+    let mut line = match solved {
+        Ok(solutions) => {
+            serde_json::to_vec(&serde_json::json!({ "id": id, "solutions": *solutions }))
+        }
+        Err(failure) => {
+            let error = match &failure {
+                SolveFailure::Input(details) => details.as_str(),
+                SolveFailure::Rejected(rejection) => rejection_message(rejection),
+                SolveFailure::Internal => "Something went wrong",
+            };
+            serde_json::to_vec(&serde_json::json!({ "id": id, "error": error }))
+        }
     }
+    .unwrap_or_default();
+    line.push(b'\n');
+    metrics::global().observe(Phase::Serialize, start.elapsed());
+    web::Bytes::from(line)
+}
 
-    Ok(())
+fn validate_solve_request(req: &SolveRequest) -> Result<(), HttpResponse> {
+    validate::validate_solve_request(req).map_err(|error| {
+        HttpResponse::UnprocessableEntity().json(serde_json::json!({ "error": error.details }))
+    })
 }
 
 /// GET /health
-pub async fn health_check() -> impl Responder {
-    HttpResponse::Ok().body("OK")
+///
+/// Answers 503 until the model cache warm-up has finished
+pub async fn health_check(ready: web::Data<AtomicBool>) -> impl Responder {
+    if ready.load(Ordering::Acquire) {
+        HttpResponse::Ok().body("OK")
+    } else {
+        HttpResponse::ServiceUnavailable().body("Warming up")
+    }
+}
+
+/// GET /metrics
+///
+/// Prometheus text exposition of per-phase solve latencies, solver queue
+/// depth and model cache counters
+pub async fn metrics_endpoint(
+    solver: web::Data<Box<dyn Solver>>,
+    scheduler: web::Data<Scheduler>,
+) -> impl Responder {
+    let body = metrics::global().render(solver.name(), scheduler.available());
+    HttpResponse::Ok()
+        .content_type("text/plain; version=0.0.4")
+        .body(body)
 }
 
 /// GET /docs
@@ -295,6 +905,16 @@ async fn main() -> std::io::Result<()> {
         .and_then(|v| v.parse::<usize>().ok())
         .unwrap_or(2 * 1024 * 1024); // default 2 MB
 
+    let binary_limit = env::var("BINARY_PAYLOAD_LIMIT")
+        .ok()
+        .and_then(|v| v.parse::<usize>().ok())
+        .unwrap_or(16 * 1024 * 1024); // default 16 MB
+
+    let batch_limit = env::var("BATCH_PAYLOAD_LIMIT")
+        .ok()
+        .and_then(|v| v.parse::<usize>().ok())
+        .unwrap_or(64 * 1024 * 1024); // default 64 MB
+
     let protect = env::var("PROTECT")
         .ok()
         .and_then(|s| s.parse::<bool>().ok())
@@ -328,12 +948,143 @@ async fn main() -> std::io::Result<()> {
         .and_then(|s| s.parse::<bool>().ok())
         .unwrap_or(true);
 
+    // Configure parallel solving of multi-objective requests (default: false)
+    let parallel_objectives = env::var("PARALLEL_OBJECTIVES")
+        .ok()
+        .and_then(|s| s.parse::<bool>().ok())
+        .unwrap_or(false);
+
+    // Configure removal of redundant rows and fixed or unused columns before solving (default: false)
+    let reduce_polyhedra = env::var("REDUCE_POLYHEDRA")
+        .ok()
+        .and_then(|s| s.parse::<bool>().ok())
+        .unwrap_or(false);
+
     // Configure model cache size (default: 0 disabled, set to enable)
     let cache_size = env::var("MODEL_CACHE_SIZE")
         .ok()
         .and_then(|s| s.parse::<usize>().ok());
 
-    let solver = create_solver_with_cache(solver_type, cache_size);
+    // Configure estimated memory budget of the model cache (default: unbounded)
+    let cache_bytes = env::var("MODEL_CACHE_BYTES")
+        .ok()
+        .and_then(|s| s.parse::<usize>().ok());
+
+    // Configure independent model replicas per cached polyhedron (default: 1)
+    let model_replicas = env::var("MODEL_REPLICAS")
+        .ok()
+        .and_then(|s| s.parse::<usize>().ok())
+        .unwrap_or(1);
+
+    // Configure a JSONL file of requests whose models are built at startup (default: none)
+    let warmup_file = env::var("MODEL_WARMUP_FILE").ok().map(PathBuf::from);
+
+    // Configure where cached model fingerprints are saved on shutdown (default: none)
+    let snapshot_file = env::var("MODEL_SNAPSHOT_FILE").ok().map(PathBuf::from);
+
+    // Configure the maximum number of requests waiting for a solver (default: unlimited)
+    let solve_queue_limit = env::var("SOLVE_QUEUE_LIMIT")
+        .ok()
+        .and_then(|s| s.parse::<usize>().ok());
+
+    // Configure the deadline of requests without X-Deadline-Ms (default: none)
+    let solve_deadline_ms = env::var("SOLVE_DEADLINE_MS")
+        .ok()
+        .and_then(|s| s.parse::<u64>().ok());
+
+    // Configure the default and maximum solve time limit (default: none)
+    let solve_time_limit_ms = env::var("SOLVE_TIME_LIMIT_MS")
+        .ok()
+        .and_then(|s| s.parse::<u64>().ok());
+
+    // Configure the MIP gap of requests that do not set one (default: solver default)
+    let solve_mip_gap = env::var("SOLVE_MIP_GAP")
+        .ok()
+        .and_then(|s| s.parse::<f64>().ok())
+        .filter(|gap| gap.is_finite() && *gap >= 0.0);
+
+    // Configure how long unused registered models are kept (default: 1 hour)
+    let model_ttl_ms = env::var("MODEL_TTL_MS")
+        .ok()
+        .and_then(|s| s.parse::<u64>().ok())
+        .unwrap_or(60 * 60 * 1000);
+
+    // Configure estimated memory budget of registered models (default: 1 GiB)
+    let model_registry_bytes = env::var("MODEL_REGISTRY_BYTES")
+        .ok()
+        .and_then(|s| s.parse::<usize>().ok())
+        .unwrap_or(1 << 30);
+
+    // Let identical in-flight requests share one solve (default: true)
+    let coalesce = env::var("COALESCE_REQUESTS")
+        .ok()
+        .and_then(|s| s.parse::<bool>().ok())
+        .unwrap_or(true);
+
+    // Configure how long solve results are reused (default: 0 disabled)
+    let result_cache_ttl_ms = env::var("RESULT_CACHE_TTL_MS")
+        .ok()
+        .and_then(|s| s.parse::<u64>().ok())
+        .unwrap_or(0);
+
+    // Configure the maximum number of reused results (default: 1024)
+    let result_cache_size = env::var("RESULT_CACHE_SIZE")
+        .ok()
+        .and_then(|s| s.parse::<usize>().ok())
+        .unwrap_or(1024);
+
+    // Configure memory budget of the per-objective solution cache (default: 0 disabled)
+    let solution_cache_bytes = env::var("SOLUTION_CACHE_BYTES")
+        .ok()
+        .and_then(|s| s.parse::<usize>().ok())
+        .unwrap_or(0);
+
+    // Either budget enables the model cache; an unset one does not limit it
+    let cache_config = (cache_size.is_some() || cache_bytes.is_some()).then(|| ModelCacheConfig {
+        capacity: cache_size.unwrap_or(usize::MAX),
+        replicas_per_model: model_replicas,
+        budget_bytes: cache_bytes,
+    });
+    // Configure the cores available to solvers (default: all available)
+    let cpu_budget = env::var("CPU_BUDGET")
+        .ok()
+        .and_then(|s| s.parse::<usize>().ok())
+        .filter(|&n| n > 0)
+        .unwrap_or_else(|| {
+            std::thread::available_parallelism()
+                .map(|n| n.get())
+                .unwrap_or(1)
+        });
+
+    // Configure how the budget is split between solves (default: latency)
+    let thread_policy = env::var("THREAD_POLICY")
+        .ok()
+        .and_then(|s| ThreadPolicy::parse(&s))
+        .unwrap_or(ThreadPolicy::Latency);
+
+    // Configure maximum concurrent blocking solver threads via env var.
+    // Defaults by THREAD_POLICY unless the user supplies a value. If the env
+    // var is set but invalid (non-integer or < 1) the server will panic with
+    // an error to avoid silently running with unexpected configuration.
+    let max_blocking_threads = env::var("MAX_BLOCKING_THREADS")
+        .ok()
+        .and_then(|s| s.parse::<i32>().ok());
+    let budget = match max_blocking_threads {
+        Some(n) if n < 1 => panic!("MAX_BLOCKING_THREADS must be >= 1"),
+        n => ThreadBudget::new(cpu_budget, thread_policy, n.map(|n| n as usize)),
+    };
+
+    let solver = create_solver_with_cache(solver_type, cache_config, budget.slots)
+        .map_err(|e| std::io::Error::other(e.details))?;
+    let solver: Box<dyn Solver> = if reduce_polyhedra {
+        Box::new(ReducingSolver::new(solver))
+    } else {
+        solver
+    };
+    let solver: Box<dyn Solver> = match solution_cache_bytes {
+        0 => solver,
+        bytes => Box::new(CachingSolver::new(solver, bytes)),
+    };
 
     println!(
         "Server is {}",
@@ -344,37 +1095,139 @@ async fn main() -> std::io::Result<()> {
         "Presolve: {}",
         if use_presolve { "enabled" } else { "disabled" }
     );
-    match cache_size {
-        Some(cs) => println!("LRU Model builder cache: {} entries", cs),
-        None => println!("LRU Model builder cache: disabled"),
+    println!(
+        "Parallel objectives: {}",
+        if parallel_objectives {
+            "enabled"
+        } else {
+            "disabled"
+        }
+    );
+    println!(
+        "Polyhedron reduction: {}",
+        if reduce_polyhedra {
+            "enabled"
+        } else {
+            "disabled"
+        }
+    );
+    match (cache_size, cache_bytes) {
+        (None, None) => println!("Model builder cache: disabled"),
+        (size, bytes) => println!(
+            "Model builder cache: {} replicas, {} bytes ({} per model)",
+            size.map_or("unlimited".to_string(), |s| s.to_string()),
+            bytes.map_or("unlimited".to_string(), |b| b.to_string()),
+            model_replicas
+        ),
+    }
+    match solution_cache_bytes {
+        0 => println!("Solution cache: disabled"),
+        bytes => println!("Solution cache: {} bytes", bytes),
+    }
+    println!(
+        "Request coalescing: {}",
+        if coalesce { "enabled" } else { "disabled" }
+    );
+    match result_cache_ttl_ms {
+        0 => println!("Result cache: disabled"),
+        ttl => println!("Result cache: {} results for {} ms", result_cache_size, ttl),
+    }
+    match solve_queue_limit {
+        Some(limit) => println!("Solve queue limit: {} requests", limit),
+        None => println!("Solve queue limit: unlimited"),
+    }
+    match solve_deadline_ms {
+        Some(ms) => println!("Default solve deadline: {} ms", ms),
+        None => println!("Default solve deadline: none"),
+    }
+    match solve_time_limit_ms {
+        Some(ms) => println!("Solve time limit: {} ms", ms),
+        None => println!("Solve time limit: none"),
+    }
+    match solve_mip_gap {
+        Some(gap) => println!("Default MIP gap: {}", gap),
+        None => println!("Default MIP gap: solver default"),
     }
+    println!("Registered model TTL: {} ms", model_ttl_ms);
+    println!("Registered model budget: {} bytes", model_registry_bytes);
+
+    metrics::global().set_thread_budget(budget.cores, budget.slots, budget.threads_per_slot);
+    println!(
+        "CPU budget: {} cores, {} solver slots of {} threads ({:?} policy)",
+        budget.cores, budget.slots, budget.threads_per_slot, thread_policy
+    );
     println!("Starting server on http://127.0.0.1:{}", port);
 
-    // Clone solver and presolve flag for use in the closure
+    // Clone solver and solve settings for use in the closure
     let solver_data = web::Data::new(solver);
-    let presolve_data = web::Data::new(use_presolve);
+    let settings_data = web::Data::new(SolveSettings {
+        use_presolve,
+        parallel_objectives,
+        default_deadline: solve_deadline_ms.map(Duration::from_millis),
+        time_limit: solve_time_limit_ms.map(Duration::from_millis),
+        mip_gap: solve_mip_gap,
+        threads: budget.threads_per_slot,
+        slots: budget.slots,
+        model_ttl: Duration::from_millis(model_ttl_ms),
+    });
+    let coalescer_data = web::Data::new(Coalescer::new(CoalesceConfig {
+        coalesce,
+        result_ttl: std::time::Duration::from_millis(result_cache_ttl_ms),
+        result_capacity: result_cache_size,
+    }));
 
-    // Configure maximum concurrent blocking solver threads via env var.
-    // Default to 1 unless the user supplies a value. If the env var is set
-    // but invalid (non-integer or < 1) the server will panic with an error
-    // to avoid silently running with unexpected configuration.
+    let scheduler_data = web::Data::new(Scheduler::new(SchedulerConfig {
+        permits: budget.slots,
+        queue_limit: solve_queue_limit,
+    }));
 
-    let max_blocking_threads = env::var("MAX_BLOCKING_THREADS")
-        .ok()
-        .and_then(|s| s.parse::<i32>().ok())
-        .unwrap_or(1);
-    let solver_semaphore = match max_blocking_threads {
-        n if n < 1 => panic!("MAX_BLOCKING_THREADS must be >= 1"),
-        n => Arc::new(tokio::sync::Semaphore::new(n as usize)),
-    };
+    let ready = web::Data::new(AtomicBool::new(warmup_file.is_none()));
+    if let Some(warmup_file) = warmup_file {
+        let solver = solver_data.clone();
+        let ready = ready.clone();
+        let snapshot_file = snapshot_file.clone();
+        let threads = budget.slots;
+        tokio::task::spawn_blocking(move || {
+            warm_up_model_cache(
+                solver.get_ref().as_ref(),
+                &warmup_file,
+                snapshot_file,
+                threads,
+                use_presolve,
+            );
+            ready.store(true, Ordering::Release);
+        });
+    }
+    let shutdown_solver = solver_data.clone();
 
-    HttpServer::new(move || {
+    // Drop expired registered models, releasing their pinned cache entries
+    let registry_data = web::Data::new(ModelRegistry::new(model_registry_bytes));
+    {
+        let registry = registry_data.clone();
+        let solver = solver_data.clone();
+        actix_web::rt::spawn(async move {
+            let mut sweep = tokio::time::interval(Duration::from_secs(1));
+            loop {
+                sweep.tick().await;
+                registry.expire(solver.get_ref().as_ref());
+            }
+        });
+    }
+
+    let server = HttpServer::new(move || {
         App::new()
             .wrap(Logger::default())
             .wrap(Condition::new(sentry_enabled, Sentry::new()))
+            // Responses are gzip, zstd or brotli encoded per Accept-Encoding;
+            // compressed request bodies are decoded by the body extractors
+            .wrap(Compress::default())
             .app_data(solver_data.clone())
-            .app_data(presolve_data.clone())
-            .app_data(web::Data::new(solver_semaphore.clone()))
+            .app_data(settings_data.clone())
+            .app_data(coalescer_data.clone())
+            .app_data(ready.clone())
+            .app_data(scheduler_data.clone())
+            .app_data(registry_data.clone())
+            .app_data(web::PayloadConfig::new(binary_limit))
             .app_data(
                 web::JsonConfig::default()
                     .limit(json_limit)
@@ -393,16 +1246,79 @@ async fn main() -> std::io::Result<()> {
             }))
             .route("/", web::get().to(root_redirect))
             .route("/health", web::get().to(health_check))
+            .route("/metrics", web::get().to(metrics_endpoint))
             .route("/docs", web::get().to(docs))
             .service(
                 web::scope("")
                     .wrap(Condition::new(protect, from_fn(token_auth)))
-                    .route("/solve", web::post().to(solve)),
+                    .route("/solve", web::post().to(solve))
+                    .route("/solve/stream", web::post().to(solve_stream))
+                    .route("/models", web::post().to(register_model))
+                    .route("/models/{id}/solve", web::post().to(solve_model))
+                    .route("/models/{id}", web::delete().to(delete_model))
+                    .service(
+                        web::resource("/solve/batch")
+                            .app_data(web::PayloadConfig::new(batch_limit))
+                            .route(web::post().to(solve_batch)),
+                    ),
             )
     })
-    .bind(("0.0.0.0", port))?
+    // Accepts HTTP/1.1 and cleartext HTTP/2 with prior knowledge, so
+    // clients can multiplex solves over one connection
+    .bind_auto_h2c(("0.0.0.0", port))?
     .run()
-    .await
+    .await;
+
+    if let Some(snapshot_file) = snapshot_file {
+        let cached = shutdown_solver.cached_models();
+        match warmup::write_snapshot(&snapshot_file, &cached) {
+            Ok(()) => println!("Saved {} cached model fingerprints", cached.len()),
+            Err(e) => eprintln!("Failed to write {}: {}", snapshot_file.display(), e),
+        }
+    }
+    server
+}
+
+/// Build the models of the warm-up file, limited to the snapshot if one exists
+fn warm_up_model_cache(
+    solver: &dyn Solver,
+    warmup_file: &Path,
+    snapshot_file: Option<PathBuf>,
+    threads: usize,
+    use_presolve: bool,
+) {
+    let start = Instant::now();
+    let (polyhedra, skipped) = match warmup::read_requests(warmup_file) {
+        Ok(read) => read,
+        Err(e) => {
+            eprintln!(
+                "Skipping warm-up, failed to read {}: {}",
+                warmup_file.display(),
+                e
+            );
+            return;
+        }
+    };
+    let snapshot = match snapshot_file.as_deref().map(warmup::read_snapshot) {
+        Some(Ok(snapshot)) => snapshot,
+        Some(Err(e)) => {
+            eprintln!("Ignoring unreadable model snapshot: {}", e);
+            None
+        }
+        None => None,
+    };
+    let polyhedra = match snapshot {
+        Some(snapshot) => warmup::select(polyhedra, &snapshot),
+        None => polyhedra,
+    };
+    let failed = warmup::warm_up(solver, &polyhedra, threads, use_presolve);
+    println!(
+        "Warmed up {} models in {:?} ({} failed, {} invalid requests skipped)",
+        polyhedra.len() - failed,
+        start.elapsed(),
+        failed,
+        skipped
+    );
 }
 
 #[cfg(test)]
@@ -411,13 +1327,13 @@ mod tests {
     use actix_web::http::StatusCode;
     use std::collections::HashMap;
 
-    use models::{
+    use rust_solver_api::models::{
         ApiIntegerSparseMatrix, ApiShape, ApiVariable, SolverDirection, SparseLEIntegerPolyhedron,
     };
 
     fn make_valid_request() -> SolveRequest {
         SolveRequest {
-            polyhedron: SparseLEIntegerPolyhedron {
+            polyhedron: Arc::new(SparseLEIntegerPolyhedron {
                 a: ApiIntegerSparseMatrix {
                     rows: vec![0, 1, 2],
                     cols: vec![0, 1, 2],
@@ -439,14 +1355,18 @@ mod tests {
                         bound: (0, 100),
                     },
                 ],
-            },
+            }),
             objectives: vec![{
                 let mut obj = HashMap::new();
                 obj.insert("x1".to_string(), 1.0);
                 obj.insert("x2".to_string(), 2.0);
                 obj
-            }],
+            }]
+            .into(),
             direction: SolverDirection::Maximize,
+            hint: None,
+            time_limit_ms: None,
+            mip_gap: None,
         }
     }
 
@@ -459,7 +1379,7 @@ mod tests {
     #[test]
     fn validate_solve_request_mismatch_variables_vs_columns_should_return_422() {
         let mut req = make_valid_request();
-        req.polyhedron.variables.pop();
+        Arc::make_mut(&mut req.polyhedron).variables.pop();
         let resp = validate_solve_request(&req).unwrap_err();
         assert_eq!(resp.status(), StatusCode::UNPROCESSABLE_ENTITY);
     }
@@ -467,7 +1387,45 @@ mod tests {
     #[test]
     fn validate_solve_request_mismatch_b_vs_rows_should_return_422() {
         let mut req = make_valid_request();
-        req.polyhedron.b.pop();
+        Arc::make_mut(&mut req.polyhedron).b.pop();
+        let resp = validate_solve_request(&req).unwrap_err();
+        assert_eq!(resp.status(), StatusCode::UNPROCESSABLE_ENTITY);
+    }
+
+    #[test]
+    fn parse_batch_accepts_json_arrays_and_ndjson() {
+        let item = |id: &str| {
+            serde_json::json!({
+                "id": id,
+                "polyhedron": {
+                    "A": {"rows": [0], "cols": [0], "vals": [1], "shape": {"nrows": 1, "ncols": 1}},
+                    "b": [1],
+                    "variables": [{"id": "x", "bound": [0, 1]}]
+                },
+                "objectives": [{"x": 1.0}],
+                "direction": "maximize"
+            })
+        };
+        let array = serde_json::to_vec(&[item("a"), item("b")]).unwrap();
+        let ids = |items: Vec<BatchSolveRequest>| -> Vec<String> {
+            items.into_iter().map(|item| item.id).collect()
+        };
+        assert_eq!(ids(parse_batch(&array, false).unwrap()), ["a", "b"]);
+
+        let ndjson = format!("{}\n\n{}\n", item("a"), item("b"));
+        assert_eq!(
+            ids(parse_batch(ndjson.as_bytes(), true).unwrap()),
+            ["a", "b"]
+        );
+
+        let error = parse_batch(b"{}\nnot json", true).unwrap_err();
+        assert!(error.starts_with("Line 1:"), "{}", error);
+    }
+
+    #[test]
+    fn validate_solve_request_negative_mip_gap_should_return_422() {
+        let mut req = make_valid_request();
+        req.mip_gap = Some(-0.1);
         let resp = validate_solve_request(&req).unwrap_err();
         assert_eq!(resp.status(), StatusCode::UNPROCESSABLE_ENTITY);
     }
@@ -0,0 +1,442 @@
+//! Process-wide solve metrics, exposed on `/metrics` in the Prometheus text
+//! exposition format.
+//!
+//! Everything is a plain atomic so recording from solver threads never blocks;
+//! the solver backend label is added when rendering since a process runs a
+//! single backend.
+
+use std::fmt::Write;
+use std::sync::atomic::{AtomicI64, AtomicU64, AtomicUsize, Ordering};
+use std::sync::OnceLock;
+use std::time::{Duration, Instant};
+
+/// Stages of a solve request with their own latency histogram
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Phase {
+    /// Reading and decoding the request body (JSON or binary)
+    Parse,
+    /// `validate_solve_request`
+    Validate,
+    /// Waiting for a solver semaphore permit
+    Queue,
+    /// Building a solver model on a cache miss
+    Build,
+    /// The solver run itself, per objective (per chunk for GLPK)
+    Solve,
+    /// Encoding the response body
+    Serialize,
+}
+
+const PHASES: [Phase; 6] = [
+    Phase::Parse,
+    Phase::Validate,
+    Phase::Queue,
+    Phase::Build,
+    Phase::Solve,
+    Phase::Serialize,
+];
+
+impl Phase {
+    fn name(self) -> &'static str {
+        match self {
+            Phase::Parse => "parse",
+            Phase::Validate => "validate",
+            Phase::Queue => "queue",
+            Phase::Build => "build",
+            Phase::Solve => "solve",
+            Phase::Serialize => "serialize",
+        }
+    }
+}
+
+/// Upper bounds of the latency buckets, in seconds
+const LATENCY_BUCKETS: [f64; 14] = [
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0,
+];
+
+/// Latency histogram with fixed buckets
+struct Histogram {
+    /// Observations per bucket, not cumulative; the last slot is `+Inf`
+    buckets: [AtomicU64; LATENCY_BUCKETS.len() + 1],
+    sum_micros: AtomicU64,
+    count: AtomicU64,
+}
+
+impl Histogram {
+    fn new() -> Self {
+        Histogram {
+            buckets: std::array::from_fn(|_| AtomicU64::new(0)),
+            sum_micros: AtomicU64::new(0),
+            count: AtomicU64::new(0),
+        }
+    }
+
+    fn observe(&self, elapsed: Duration) {
+        let seconds = elapsed.as_secs_f64();
+        let bucket = LATENCY_BUCKETS
+            .iter()
+            .position(|&le| seconds <= le)
+            .unwrap_or(LATENCY_BUCKETS.len());
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+        self.sum_micros
+            .fetch_add(elapsed.as_micros() as u64, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+    }
+
+    fn render(&self, out: &mut String, name: &str, labels: &str) {
+        let mut cumulative = 0;
+        for (i, bucket) in self.buckets.iter().enumerate() {
+            cumulative += bucket.load(Ordering::Relaxed);
+            let le = match LATENCY_BUCKETS.get(i) {
+                Some(le) => le.to_string(),
+                None => "+Inf".to_string(),
+            };
+            let _ = writeln!(out, "{name}_bucket{{{labels},le=\"{le}\"}} {cumulative}");
+        }
+        let sum = self.sum_micros.load(Ordering::Relaxed) as f64 / 1e6;
+        let _ = writeln!(out, "{name}_sum{{{labels}}} {sum}");
+        let count = self.count.load(Ordering::Relaxed);
+        let _ = writeln!(out, "{name}_count{{{labels}}} {count}");
+    }
+}
+
+pub struct Metrics {
+    phases: [Histogram; PHASES.len()],
+    /// Requests waiting for a solver permit
+    queue_depth: AtomicI64,
+    cache_hits: AtomicU64,
+    cache_misses: AtomicU64,
+    /// Replicas added for parallel objective workers of a checked out model
+    cache_spare_builds: AtomicU64,
+    cache_evictions: AtomicU64,
+    /// Estimated memory of all cached model replicas
+    cache_bytes: AtomicU64,
+    coalesced: AtomicU64,
+    result_cache_hits: AtomicU64,
+    solution_cache_hits: AtomicU64,
+    solution_cache_misses: AtomicU64,
+    model_patches: AtomicU64,
+    reduced_rows: AtomicU64,
+    reduced_columns: AtomicU64,
+    rejected_queue_full: AtomicU64,
+    rejected_deadline: AtomicU64,
+    cancelled: AtomicU64,
+    cpu_budget: AtomicUsize,
+    solver_slots: AtomicUsize,
+    threads_per_slot: AtomicUsize,
+}
+
+/// The process-wide metrics
+pub fn global() -> &'static Metrics {
+    static METRICS: OnceLock<Metrics> = OnceLock::new();
+    METRICS.get_or_init(Metrics::new)
+}
+
+/// Run `f`, recording its duration under `phase`
+pub fn timed<T>(phase: Phase, f: impl FnOnce() -> T) -> T {
+    let start = Instant::now();
+    let result = f();
+    global().observe(phase, start.elapsed());
+    result
+}
+
+impl Metrics {
+    fn new() -> Self {
+        Metrics {
+            phases: std::array::from_fn(|_| Histogram::new()),
+            queue_depth: AtomicI64::new(0),
+            cache_hits: AtomicU64::new(0),
+            cache_misses: AtomicU64::new(0),
+            cache_spare_builds: AtomicU64::new(0),
+            cache_evictions: AtomicU64::new(0),
+            cache_bytes: AtomicU64::new(0),
+            coalesced: AtomicU64::new(0),
+            result_cache_hits: AtomicU64::new(0),
+            solution_cache_hits: AtomicU64::new(0),
+            solution_cache_misses: AtomicU64::new(0),
+            model_patches: AtomicU64::new(0),
+            reduced_rows: AtomicU64::new(0),
+            reduced_columns: AtomicU64::new(0),
+            rejected_queue_full: AtomicU64::new(0),
+            rejected_deadline: AtomicU64::new(0),
+            cancelled: AtomicU64::new(0),
+            cpu_budget: AtomicUsize::new(0),
+            solver_slots: AtomicUsize::new(0),
+            threads_per_slot: AtomicUsize::new(0),
+        }
+    }
+
+    pub fn observe(&self, phase: Phase, elapsed: Duration) {
+        self.phases[phase as usize].observe(elapsed);
+    }
+
+    pub fn queue_entered(&self) {
+        self.queue_depth.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub fn queue_left(&self) {
+        self.queue_depth.fetch_sub(1, Ordering::Relaxed);
+    }
+
+    pub fn cache_hit(&self) {
+        self.cache_hits.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub fn cache_miss(&self) {
+        self.cache_misses.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub fn cache_spare_build(&self) {
+        self.cache_spare_builds.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub fn cache_evicted(&self, pools: u64) {
+        self.cache_evictions.fetch_add(pools, Ordering::Relaxed);
+    }
+
+    pub fn set_cache_bytes(&self, bytes: u64) {
+        self.cache_bytes.store(bytes, Ordering::Relaxed);
+    }
+
+    pub fn solve_coalesced(&self) {
+        self.coalesced.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub fn result_cache_hit(&self) {
+        self.result_cache_hits.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Count a request the scheduler turned away, for its deadline or a full queue
+    pub fn solve_rejected(&self, deadline: bool) {
+        let counter = if deadline {
+            &self.rejected_deadline
+        } else {
+            &self.rejected_queue_full
+        };
+        counter.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub fn solve_cancelled(&self) {
+        self.cancelled.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Record how the CPU budget is split, see `scheduler::ThreadBudget`
+    pub fn set_thread_budget(&self, cores: usize, slots: usize, threads_per_slot: usize) {
+        self.cpu_budget.store(cores, Ordering::Relaxed);
+        self.solver_slots.store(slots, Ordering::Relaxed);
+        self.threads_per_slot
+            .store(threads_per_slot, Ordering::Relaxed);
+    }
+
+    pub fn model_patched(&self) {
+        self.model_patches.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Record the rows and columns one reduction removed from a polyhedron
+    pub fn polyhedron_reduced(&self, rows: u64, columns: u64) {
+        self.reduced_rows.fetch_add(rows, Ordering::Relaxed);
+        self.reduced_columns.fetch_add(columns, Ordering::Relaxed);
+    }
+
+    /// Record the objectives of one request found and not found in the solution cache
+    pub fn solution_cache_lookups(&self, hits: u64, misses: u64) {
+        self.solution_cache_hits.fetch_add(hits, Ordering::Relaxed);
+        self.solution_cache_misses
+            .fetch_add(misses, Ordering::Relaxed);
+    }
+
+    /// Render all metrics, labelled with the solver backend name.
+    ///
+    /// `permits_available` is the semaphore's current number of idle permits.
+    pub fn render(&self, solver: &str, permits_available: usize) -> String {
+        let solver = solver.replace('\\', "\\\\").replace('"', "\\\"");
+        let labels = format!("solver=\"{solver}\"");
+        let mut out = String::new();
+
+        let name = "solver_phase_duration_seconds";
+        let _ = writeln!(
+            out,
+            "# HELP {name} Time spent in each phase of a solve request"
+        );
+        let _ = writeln!(out, "# TYPE {name} histogram");
+        for phase in PHASES {
+            let phase_labels = format!("{labels},phase=\"{}\"", phase.name());
+            self.phases[phase as usize].render(&mut out, name, &phase_labels);
+        }
+
+        let slots = self.solver_slots.load(Ordering::Relaxed);
+        let threads_per_slot = self.threads_per_slot.load(Ordering::Relaxed);
+        let gauges = [
+            (
+                "solver_queue_depth",
+                "Requests waiting for a solver permit",
+                self.queue_depth.load(Ordering::Relaxed),
+            ),
+            (
+                "solver_permits_available",
+                "Idle MAX_BLOCKING_THREADS permits",
+                permits_available as i64,
+            ),
+            (
+                "solver_cpu_budget",
+                "Cores shared by all solves (CPU_BUDGET)",
+                self.cpu_budget.load(Ordering::Relaxed) as i64,
+            ),
+            (
+                "solver_threads_per_slot",
+                "Solver threads each permit may use",
+                threads_per_slot as i64,
+            ),
+            (
+                "solver_threads_busy",
+                "Solver threads of the permits currently held",
+                (slots.saturating_sub(permits_available) * threads_per_slot) as i64,
+            ),
+            (
+                "model_cache_bytes",
+                "Estimated memory held by cached model replicas",
+                self.cache_bytes.load(Ordering::Relaxed) as i64,
+            ),
+        ];
+        for (name, help, value) in gauges {
+            let _ = writeln!(out, "# HELP {name} {help}");
+            let _ = writeln!(out, "# TYPE {name} gauge");
+            let _ = writeln!(out, "{name}{{{labels}}} {value}");
+        }
+
+        let counters = [
+            (
+                "model_cache_hits_total",
+                "Model checkouts served by a cached replica",
+                &self.cache_hits,
+            ),
+            (
+                "model_cache_misses_total",
+                "Model checkouts that built a new replica",
+                &self.cache_misses,
+            ),
+            (
+                "model_cache_spare_builds_total",
+                "Replicas built for parallel objective workers of a checked out model",
+                &self.cache_spare_builds,
+            ),
+            (
+                "model_cache_evictions_total",
+                "Cached polyhedra evicted to stay within MODEL_CACHE_SIZE or MODEL_CACHE_BYTES",
+                &self.cache_evictions,
+            ),
+            (
+                "model_cache_patches_total",
+                "Model checkouts that updated rhs or bounds in place",
+                &self.model_patches,
+            ),
+            (
+                "reduction_rows_removed_total",
+                "Constraint rows removed before solving (REDUCE_POLYHEDRA)",
+                &self.reduced_rows,
+            ),
+            (
+                "reduction_columns_removed_total",
+                "Variables removed before solving (REDUCE_POLYHEDRA)",
+                &self.reduced_columns,
+            ),
+            (
+                "solve_rejected_queue_full_total",
+                "Requests rejected with 429 because SOLVE_QUEUE_LIMIT requests were waiting",
+                &self.rejected_queue_full,
+            ),
+            (
+                "solve_rejected_deadline_total",
+                "Requests rejected with 503 because they could not finish before their deadline",
+                &self.rejected_deadline,
+            ),
+            (
+                "solve_cancelled_total",
+                "Solves stopped early because their client went away",
+                &self.cancelled,
+            ),
+            (
+                "solve_coalesced_total",
+                "Requests answered by an identical in-flight solve",
+                &self.coalesced,
+            ),
+            (
+                "solve_result_cache_hits_total",
+                "Requests answered from the solve result cache",
+                &self.result_cache_hits,
+            ),
+            (
+                "solution_cache_hits_total",
+                "Objectives answered from the per-objective solution cache",
+                &self.solution_cache_hits,
+            ),
+            (
+                "solution_cache_misses_total",
+                "Objectives passed on to the solver by the solution cache",
+                &self.solution_cache_misses,
+            ),
+        ];
+        for (name, help, value) in counters {
+            let _ = writeln!(out, "# HELP {name} {help}");
+            let _ = writeln!(out, "# TYPE {name} counter");
+            let _ = writeln!(out, "{name}{{{labels}}} {}", value.load(Ordering::Relaxed));
+        }
+
+        out
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_histogram_buckets_are_cumulative() {
+        let metrics = Metrics::new();
+        metrics.observe(Phase::Solve, Duration::from_micros(300));
+        metrics.observe(Phase::Solve, Duration::from_millis(20));
+        metrics.observe(Phase::Solve, Duration::from_secs(60));
+
+        let rendered = metrics.render("HiGHS", 2);
+        let labels = "solver=\"HiGHS\",phase=\"solve\"";
+        for line in [
+            format!("solver_phase_duration_seconds_bucket{{{labels},le=\"0.0005\"}} 1"),
+            format!("solver_phase_duration_seconds_bucket{{{labels},le=\"0.025\"}} 2"),
+            format!("solver_phase_duration_seconds_bucket{{{labels},le=\"10\"}} 2"),
+            format!("solver_phase_duration_seconds_bucket{{{labels},le=\"+Inf\"}} 3"),
+            format!("solver_phase_duration_seconds_count{{{labels}}} 3"),
+        ] {
+            assert!(rendered.contains(&line), "missing {line}");
+        }
+    }
+
+    #[test]
+    fn test_render_gauges_and_counters() {
+        let metrics = Metrics::new();
+        metrics.queue_entered();
+        metrics.cache_hit();
+        metrics.cache_miss();
+        metrics.cache_miss();
+        metrics.cache_spare_build();
+        metrics.cache_evicted(1);
+        metrics.set_cache_bytes(4096);
+        metrics.solve_coalesced();
+        metrics.set_thread_budget(8, 4, 2);
+
+        let rendered = metrics.render("GLPK", 3);
+        for line in [
+            "solver_queue_depth{solver=\"GLPK\"} 1",
+            "solver_permits_available{solver=\"GLPK\"} 3",
+            "solver_cpu_budget{solver=\"GLPK\"} 8",
+            "solver_threads_busy{solver=\"GLPK\"} 2",
+            "model_cache_bytes{solver=\"GLPK\"} 4096",
+            "model_cache_hits_total{solver=\"GLPK\"} 1",
+            "model_cache_misses_total{solver=\"GLPK\"} 2",
+            "model_cache_spare_builds_total{solver=\"GLPK\"} 1",
+            "model_cache_evictions_total{solver=\"GLPK\"} 1",
+            "solve_coalesced_total{solver=\"GLPK\"} 1",
+        ] {
+            assert!(rendered.contains(line), "missing {line}");
+        }
+    }
+}
@@ -1,11 +1,12 @@
 use serde::{Deserialize, Serialize};
 use std::collections::HashMap;
+use std::sync::Arc;
 
 use glpk_rust::Bound;
 
 // ---------- API response types (decoupled from the lib) ----------
 
-#[derive(Serialize, Deserialize)]
+#[derive(Serialize, Deserialize, Clone, Copy)]
 pub enum Status {
     Undefined = 1,
     Feasible = 2,
@@ -16,16 +17,34 @@ pub enum Status {
     SimplexFailed = 7,
     MIPFailed = 8,
     EmptySpace = 9,
+    /// The time limit ran out; the solution is the best one found, if any
+    TimeLimit = 10,
 }
 
-#[derive(Serialize, Deserialize)]
+/// Solution values keyed by variable id, or dense in request variable order
+#[derive(Serialize, Deserialize, Clone, Debug, PartialEq, Eq)]
+#[serde(untagged)]
+pub enum ApiValues {
+    Named(HashMap<String, i32>),
+    Dense(Vec<i32>),
+}
+
+#[derive(Serialize, Deserialize, Clone)]
 pub struct ApiSolution {
     pub status: Status,
     pub objective: i32,
-    pub solution: HashMap<String, i32>,
+    pub solution: ApiValues,
     pub error: Option<String>,
 }
 
+/// One line of a `/solve/stream` response
+#[derive(Serialize)]
+pub struct ApiStreamedSolution {
+    /// Position of the solved objective in the request
+    pub index: usize,
+    pub solution: ApiSolution,
+}
+
 // ---------- API (wire) types: owned & serde-friendly ----------
 
 #[derive(Serialize, Deserialize, Clone, PartialEq, Eq, Hash)]
@@ -57,11 +76,102 @@ pub enum SolverDirection {
 
 pub type ObjectiveOwned = HashMap<String, f64>;
 
+/// Objective as `(column index, coefficient)` pairs
+pub type IndexedObjective = Vec<(usize, f64)>;
+
+/// Objectives keyed by variable id, or by column index.
+///
+/// Indexed objectives also switch the solutions to `ApiValues::Dense`, so
+/// neither side of the request hashes variable ids.
+#[derive(Deserialize, Clone, Debug, PartialEq)]
+#[serde(untagged)]
+pub enum ApiObjectives {
+    Named(Vec<ObjectiveOwned>),
+    Indexed(Vec<IndexedObjective>),
+}
+
+impl ApiObjectives {
+    /// Number of objectives
+    pub fn count(&self) -> usize {
+        match self {
+            ApiObjectives::Named(objectives) => objectives.len(),
+            ApiObjectives::Indexed(objectives) => objectives.len(),
+        }
+    }
+
+    pub fn is_indexed(&self) -> bool {
+        matches!(self, ApiObjectives::Indexed(_))
+    }
+}
+
+impl From<Vec<ObjectiveOwned>> for ApiObjectives {
+    fn from(objectives: Vec<ObjectiveOwned>) -> Self {
+        ApiObjectives::Named(objectives)
+    }
+}
+
+/// Known (ideally feasible) assignment of variable ids to values
+pub type Assignment = HashMap<String, i32>;
+
 #[derive(Deserialize)]
 pub struct SolveRequest {
+    /// Shared, so solves of a registered model use it without a copy
+    pub polyhedron: Arc<SparseLEIntegerPolyhedron>,
+    pub objectives: ApiObjectives,
+    pub direction: SolverDirection,
+    /// Optional MIP start for the first objective
+    #[serde(default)]
+    pub hint: Option<Assignment>,
+    /// Wall-clock limit of the whole request in milliseconds
+    #[serde(default)]
+    pub time_limit_ms: Option<u64>,
+    /// Relative MIP gap at which an objective counts as solved
+    #[serde(default)]
+    pub mip_gap: Option<f64>,
+}
+
+/// Body of `POST /models`
+#[derive(Deserialize)]
+pub struct RegisterModelRequest {
     pub polyhedron: SparseLEIntegerPolyhedron,
-    pub objectives: Vec<ObjectiveOwned>,
+    /// Keep the model this long after its last use instead of the server default
+    #[serde(default)]
+    pub ttl_ms: Option<u64>,
+}
+
+/// Body of `POST /models/{id}/solve`: a `SolveRequest` without its polyhedron
+#[derive(Deserialize)]
+pub struct ModelSolveRequest {
+    pub objectives: ApiObjectives,
     pub direction: SolverDirection,
+    #[serde(default)]
+    pub hint: Option<Assignment>,
+    #[serde(default)]
+    pub time_limit_ms: Option<u64>,
+    #[serde(default)]
+    pub mip_gap: Option<f64>,
+}
+
+impl ModelSolveRequest {
+    pub fn with_polyhedron(self, polyhedron: Arc<SparseLEIntegerPolyhedron>) -> SolveRequest {
+        SolveRequest {
+            polyhedron,
+            objectives: self.objectives,
+            direction: self.direction,
+            hint: self.hint,
+            time_limit_ms: self.time_limit_ms,
+            mip_gap: self.mip_gap,
+        }
+    }
+}
+
+/// One item of a `/solve/batch` request: a solve request tagged with the
+/// caller's id, which is echoed on its result line
+#[derive(Deserialize)]
+pub struct BatchSolveRequest {
+    pub id: String,
+    #[serde(flatten)]
+    pub request: SolveRequest,
 }
 
 #[derive(Serialize, Deserialize, Clone, PartialEq, Eq, Hash)]
@@ -0,0 +1,316 @@
+//! Polyhedra uploaded once through `POST /models` and solved by id.
+//!
+//! A model's id is `Fingerprint::id` of its polyhedron, so uploading the
+//! same polyhedron again returns the same id. Every registered polyhedron
+//! pins its model in the solver's model cache until it is deleted or
+//! expires. Each use restarts its time to live. Since pinned models are never
+//! evicted, the registry keeps their estimated bytes within its own budget.
+
+use crate::domain::fingerprint::Fingerprint;
+use crate::domain::solver::Solver;
+use crate::models::SparseLEIntegerPolyhedron;
+use parking_lot::Mutex;
+use std::collections::HashMap;
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+/// A registered polyhedron and its precomputed fingerprint
+#[derive(Clone)]
+pub struct RegisteredModel {
+    pub polyhedron: Arc<SparseLEIntegerPolyhedron>,
+    pub fingerprint: Fingerprint,
+}
+
+/// A successful `ModelRegistry::register`
+pub struct Registration {
+    pub id: String,
+    /// Whether this call added the model, rather than refreshing an earlier
+    /// registration of the same polyhedron
+    pub created: bool,
+}
+
+/// A registration that would exceed the registry's byte budget
+#[derive(Debug)]
+pub struct RegistryFull {
+    pub model_bytes: usize,
+    pub registered_bytes: usize,
+    pub budget_bytes: usize,
+}
+
+struct Entry {
+    model: RegisteredModel,
+    ttl: Duration,
+    expires: Instant,
+}
+
+#[derive(Default)]
+struct Models {
+    entries: HashMap<String, Entry>,
+    /// `Fingerprint::model_bytes` of every entry
+    bytes: usize,
+}
+
+pub struct ModelRegistry {
+    models: Mutex<Models>,
+    budget_bytes: usize,
+}
+
+impl ModelRegistry {
+    /// Registry pinning models of at most `budget_bytes` estimated bytes
+    pub fn new(budget_bytes: usize) -> Self {
+        ModelRegistry {
+            models: Mutex::default(),
+            budget_bytes,
+        }
+    }
+
+    /// Register `polyhedron` for `ttl` after its last use and return its id.
+    ///
+    /// A polyhedron that is already registered keeps its pin and gets the
+    /// new time to live. A new one is rejected when its model would take the
+    /// registered models over the byte budget.
+    pub fn register(
+        &self,
+        solver: &dyn Solver,
+        polyhedron: Arc<SparseLEIntegerPolyhedron>,
+        fingerprint: Fingerprint,
+        ttl: Duration,
+    ) -> Result<Registration, RegistryFull> {
+        let id = fingerprint.id();
+        let expires = Instant::now() + ttl;
+        let mut models = self.models.lock();
+        let Models { entries, bytes } = &mut *models;
+        let created = match entries.get_mut(&id) {
+            Some(entry) => {
+                entry.ttl = ttl;
+                entry.expires = expires;
+                false
+            }
+            None => {
+                let model_bytes = fingerprint.model_bytes();
+                if *bytes + model_bytes > self.budget_bytes {
+                    return Err(RegistryFull {
+                        model_bytes,
+                        registered_bytes: *bytes,
+                        budget_bytes: self.budget_bytes,
+                    });
+                }
+                *bytes += model_bytes;
+                solver.pin(fingerprint);
+                let model = RegisteredModel {
+                    polyhedron,
+                    fingerprint,
+                };
+                entries.insert(
+                    id.clone(),
+                    Entry {
+                        model,
+                        ttl,
+                        expires,
+                    },
+                );
+                true
+            }
+        };
+        Ok(Registration { id, created })
+    }
+
+    /// The model registered under `id`, restarting its time to live
+    pub fn get(&self, id: &str) -> Option<RegisteredModel> {
+        let now = Instant::now();
+        let mut models = self.models.lock();
+        let entry = models
+            .entries
+            .get_mut(id)
+            .filter(|entry| entry.expires > now)?;
+        entry.expires = now + entry.ttl;
+        Some(entry.model.clone())
+    }
+
+    /// Drop the model registered under `id`, returning whether there was one
+    pub fn remove(&self, solver: &dyn Solver, id: &str) -> bool {
+        let removed = {
+            let mut models = self.models.lock();
+            let removed = models.entries.remove(id);
+            if let Some(entry) = &removed {
+                models.bytes -= entry.model.fingerprint.model_bytes();
+            }
+            removed
+        };
+        if let Some(entry) = &removed {
+            solver.unpin(entry.model.fingerprint);
+        }
+        removed.is_some()
+    }
+
+    /// Drop every expired model, returning how many there were
+    pub fn expire(&self, solver: &dyn Solver) -> usize {
+        let now = Instant::now();
+        let mut expired = Vec::new();
+        {
+            let mut models = self.models.lock();
+            models.entries.retain(|_, entry| {
+                let keep = entry.expires > now;
+                if !keep {
+                    expired.push(entry.model.fingerprint);
+                }
+                keep
+            });
+            models.bytes -= expired.iter().map(Fingerprint::model_bytes).sum::<usize>();
+        }
+        for fingerprint in &expired {
+            solver.unpin(*fingerprint);
+        }
+        expired.len()
+    }
+
+    pub fn len(&self) -> usize {
+        self.models.lock().entries.len()
+    }
+
+    /// Estimated bytes of the registered models
+    pub fn bytes(&self) -> usize {
+        self.models.lock().bytes
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::solver::{SolutionSink, SolveOptions};
+    use crate::domain::validate::SolveInputError;
+    use crate::models::{
+        ApiIntegerSparseMatrix, ApiObjectives, ApiShape, ApiVariable, SolverDirection,
+    };
+    use std::sync::atomic::{AtomicI64, Ordering};
+
+    /// Counts outstanding pins
+    #[derive(Default)]
+    struct PinCountingSolver {
+        pins: AtomicI64,
+    }
+
+    impl Solver for PinCountingSolver {
+        fn solve_each(
+            &self,
+            _polyhedron: Arc<SparseLEIntegerPolyhedron>,
+            _fingerprint: Fingerprint,
+            _objectives: ApiObjectives,
+            _direction: SolverDirection,
+            _options: SolveOptions,
+            _on_solution: &SolutionSink,
+        ) -> Result<(), SolveInputError> {
+            Ok(())
+        }
+
+        fn pin(&self, _fingerprint: Fingerprint) {
+            self.pins.fetch_add(1, Ordering::SeqCst);
+        }
+
+        fn unpin(&self, _fingerprint: Fingerprint) {
+            self.pins.fetch_sub(1, Ordering::SeqCst);
+        }
+
+        fn name(&self) -> &str {
+            "PinCounting"
+        }
+    }
+
+    fn polyhedron(rhs: i32) -> Arc<SparseLEIntegerPolyhedron> {
+        Arc::new(SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0],
+                cols: vec![0],
+                vals: vec![1],
+                shape: ApiShape { nrows: 1, ncols: 1 },
+            },
+            b: vec![rhs],
+            variables: vec![ApiVariable {
+                id: "x".to_string(),
+                bound: (0, 1),
+            }],
+        })
+    }
+
+    fn register(registry: &ModelRegistry, solver: &dyn Solver, rhs: i32, ttl: Duration) -> String {
+        let polyhedron = polyhedron(rhs);
+        let fingerprint = Fingerprint::of(&polyhedron);
+        registry
+            .register(solver, polyhedron, fingerprint, ttl)
+            .unwrap()
+            .id
+    }
+
+    #[test]
+    fn test_register_pins_once_per_polyhedron() {
+        let registry = ModelRegistry::new(usize::MAX);
+        let solver = PinCountingSolver::default();
+        let ttl = Duration::from_secs(60);
+
+        let id = register(&registry, &solver, 1, ttl);
+        assert_eq!(register(&registry, &solver, 1, ttl), id);
+        let other = register(&registry, &solver, 2, ttl);
+        assert_ne!(other, id);
+        assert_eq!(solver.pins.load(Ordering::SeqCst), 2);
+
+        let model = registry.get(&id).unwrap();
+        assert_eq!(model.fingerprint, Fingerprint::of(&polyhedron(1)));
+
+        assert!(registry.remove(&solver, &id));
+        assert!(!registry.remove(&solver, &id));
+        assert!(registry.get(&id).is_none());
+        assert_eq!(solver.pins.load(Ordering::SeqCst), 1);
+    }
+
+    #[test]
+    fn test_expired_models_are_unpinned() {
+        let registry = ModelRegistry::new(usize::MAX);
+        let solver = PinCountingSolver::default();
+        let expired = register(&registry, &solver, 1, Duration::ZERO);
+        register(&registry, &solver, 2, Duration::from_secs(60));
+
+        assert!(registry.get(&expired).is_none());
+        assert_eq!(registry.expire(&solver), 1);
+        assert_eq!(registry.len(), 1);
+        assert_eq!(solver.pins.load(Ordering::SeqCst), 1);
+    }
+
+    #[test]
+    fn test_register_keeps_pinned_bytes_within_budget() {
+        let model_bytes = Fingerprint::of(&polyhedron(1)).model_bytes();
+        let registry = ModelRegistry::new(2 * model_bytes);
+        let solver = PinCountingSolver::default();
+        let ttl = Duration::from_secs(60);
+
+        let first = polyhedron(1);
+        let fingerprint = Fingerprint::of(&first);
+        let registration = registry
+            .register(&solver, first.clone(), fingerprint, ttl)
+            .unwrap();
+        assert!(registration.created);
+        assert!(
+            !registry
+                .register(&solver, first, fingerprint, ttl)
+                .unwrap()
+                .created
+        );
+        register(&registry, &solver, 2, ttl);
+        assert_eq!(registry.bytes(), 2 * model_bytes);
+
+        let third = polyhedron(3);
+        let full = registry
+            .register(&solver, third.clone(), Fingerprint::of(&third), ttl)
+            .err()
+            .unwrap();
+        assert_eq!(full.registered_bytes, 2 * model_bytes);
+        assert_eq!(solver.pins.load(Ordering::SeqCst), 2);
+
+        assert!(registry.remove(&solver, &registration.id));
+        assert_eq!(registry.bytes(), model_bytes);
+        register(&registry, &solver, 3, ttl);
+    }
+}
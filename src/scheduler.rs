@@ -0,0 +1,516 @@
+//! Admission control and priority scheduling of blocking solves.
+//!
+//! Requests wait in one FIFO queue per priority class and freed solver slots
+//! go to the highest class first. The cost of every request is estimated
+//! from its size and objective count, calibrated by observed solve times.
+//! A request that finds the queue full, or that would have to wait so long
+//! it could not finish before its deadline, is rejected right away with a
+//! retry hint instead of waiting indefinitely.
+
+use crate::metrics;
+use parking_lot::Mutex;
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+use tokio::sync::oneshot;
+
+/// Priority class of a request, from the `X-Priority` header
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Priority {
+    High,
+    Normal,
+    Low,
+}
+
+const PRIORITIES: [Priority; 3] = [Priority::High, Priority::Normal, Priority::Low];
+
+impl Priority {
+    /// Parse a priority name (case-insensitive)
+    pub fn parse(s: &str) -> Option<Self> {
+        match s.trim().to_lowercase().as_str() {
+            "high" => Some(Priority::High),
+            "normal" => Some(Priority::Normal),
+            "low" => Some(Priority::Low),
+            _ => None,
+        }
+    }
+}
+
+/// Size of a request in cost units: every objective touches the whole model
+pub fn cost_units(nnz: usize, nrows: usize, ncols: usize, objectives: usize) -> f64 {
+    ((nnz + nrows + ncols) * objectives.max(1)) as f64
+}
+
+/// What the scheduler knows about a request before running it
+#[derive(Clone, Copy, Debug)]
+pub struct Job {
+    pub priority: Priority,
+    /// See `cost_units`
+    pub units: f64,
+    /// Latest time the solve should be finished by
+    pub deadline: Option<Instant>,
+}
+
+/// Why a request was not admitted
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Rejection {
+    /// `SOLVE_QUEUE_LIMIT` requests are already waiting
+    QueueFull { retry_after: Duration },
+    /// The request would not finish before its deadline
+    Deadline { retry_after: Duration },
+}
+
+impl Rejection {
+    pub fn retry_after(&self) -> Duration {
+        match self {
+            Rejection::QueueFull { retry_after } | Rejection::Deadline { retry_after } => {
+                *retry_after
+            }
+        }
+    }
+}
+
+/// Scheduler sizing
+#[derive(Clone, Copy, Debug)]
+pub struct SchedulerConfig {
+    /// Solver slots, `MAX_BLOCKING_THREADS`
+    pub permits: usize,
+    /// Maximum number of waiting requests
+    pub queue_limit: Option<usize>,
+}
+
+/// How the CPU budget is split between concurrent solves, from `THREAD_POLICY`
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum ThreadPolicy {
+    /// Many narrow solves: a solver slot per core, one solver thread each
+    Throughput,
+    /// Few wide solves: a single solver slot by default, using every core
+    Latency,
+}
+
+impl ThreadPolicy {
+    /// Parse a policy name (case-insensitive)
+    pub fn parse(s: &str) -> Option<Self> {
+        match s.trim().to_lowercase().as_str() {
+            "throughput" => Some(ThreadPolicy::Throughput),
+            "latency" => Some(ThreadPolicy::Latency),
+            _ => None,
+        }
+    }
+}
+
+/// Solver slots and solver threads per slot within a CPU budget.
+///
+/// A request holding `n` slots (parallel objectives) runs `n` solver
+/// instances of `threads_per_slot` threads, so at most `slots *
+/// threads_per_slot` solver threads run at once.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct ThreadBudget {
+    /// Cores shared by all solves, `CPU_BUDGET`
+    pub cores: usize,
+    /// Concurrent solver instances, the scheduler's permits
+    pub slots: usize,
+    pub threads_per_slot: usize,
+}
+
+impl ThreadBudget {
+    /// Split `cores` by `policy`; an explicit slot count
+    /// (`MAX_BLOCKING_THREADS`) takes precedence over the policy's
+    pub fn new(cores: usize, policy: ThreadPolicy, slots: Option<usize>) -> Self {
+        let cores = cores.max(1);
+        let slots = slots
+            .unwrap_or(match policy {
+                ThreadPolicy::Throughput => cores,
+                ThreadPolicy::Latency => 1,
+            })
+            .max(1);
+        ThreadBudget {
+            cores,
+            slots,
+            threads_per_slot: (cores / slots).max(1),
+        }
+    }
+}
+
+/// Initial guess of solve seconds per cost unit, before any solve finished
+const INITIAL_SECONDS_PER_UNIT: f64 = 1e-7;
+/// Weight of the latest observation in the seconds per unit average
+const CALIBRATION_WEIGHT: f64 = 0.1;
+
+struct Waiter {
+    id: u64,
+    job: Job,
+    /// Estimated solve seconds
+    estimate: f64,
+    grant: oneshot::Sender<Result<(), Rejection>>,
+}
+
+struct State {
+    available: usize,
+    queues: [VecDeque<Waiter>; PRIORITIES.len()],
+    /// Estimated seconds of the queued work per priority class
+    queued_seconds: [f64; PRIORITIES.len()],
+    /// Estimated seconds of the admitted work
+    running_seconds: f64,
+    next_id: u64,
+}
+
+impl State {
+    fn queued(&self) -> usize {
+        self.queues.iter().map(VecDeque::len).sum()
+    }
+}
+
+struct Inner {
+    state: Mutex<State>,
+    permits: usize,
+    queue_limit: Option<usize>,
+    /// Calibrated solve seconds per cost unit, as `f64` bits
+    seconds_per_unit: AtomicU64,
+}
+
+pub struct Scheduler {
+    inner: Arc<Inner>,
+}
+
+/// Solver slots held by one request, returned to the scheduler on drop
+pub struct Permits {
+    inner: Arc<Inner>,
+    count: usize,
+    estimate: f64,
+}
+
+impl Permits {
+    /// Number of slots held, at least one
+    pub fn count(&self) -> usize {
+        self.count
+    }
+}
+
+impl Drop for Permits {
+    fn drop(&mut self) {
+        self.inner.release(self.count, self.estimate);
+    }
+}
+
+/// Removes a cancelled request from its queue, or returns a slot that was
+/// granted to it after it stopped waiting
+struct PendingGrant<'a> {
+    inner: &'a Arc<Inner>,
+    id: u64,
+    priority: Priority,
+    estimate: f64,
+    grant: Option<oneshot::Receiver<Result<(), Rejection>>>,
+}
+
+impl Drop for PendingGrant<'_> {
+    fn drop(&mut self) {
+        let Some(mut grant) = self.grant.take() else {
+            return;
+        };
+        let mut state = self.inner.state.lock();
+        let queue = &mut state.queues[self.priority as usize];
+        if let Some(pos) = queue.iter().position(|waiter| waiter.id == self.id) {
+            queue.remove(pos);
+            let class = self.priority as usize;
+            state.queued_seconds[class] = (state.queued_seconds[class] - self.estimate).max(0.0);
+            return;
+        }
+        // Grants are sent under the state lock, so one sent is visible now
+        drop(state);
+        grant.close();
+        if let Ok(Ok(())) = grant.try_recv() {
+            self.inner.release(1, self.estimate);
+        }
+    }
+}
+
+impl Scheduler {
+    pub fn new(config: SchedulerConfig) -> Self {
+        let permits = config.permits.max(1);
+        Scheduler {
+            inner: Arc::new(Inner {
+                state: Mutex::new(State {
+                    available: permits,
+                    queues: Default::default(),
+                    queued_seconds: [0.0; PRIORITIES.len()],
+                    running_seconds: 0.0,
+                    next_id: 0,
+                }),
+                permits,
+                queue_limit: config.queue_limit,
+                seconds_per_unit: AtomicU64::new(INITIAL_SECONDS_PER_UNIT.to_bits()),
+            }),
+        }
+    }
+
+    /// Idle solver slots
+    pub fn available(&self) -> usize {
+        self.inner.state.lock().available
+    }
+
+    /// Wait for a solver slot for `job`, or reject it.
+    ///
+    /// Once admitted, up to `extra` more idle slots are taken without
+    /// waiting, and only while nobody is queued for them.
+    pub async fn acquire(&self, job: Job, extra: usize) -> Result<Permits, Rejection> {
+        let estimate = self.estimate(job.units);
+        let (id, grant) = {
+            let mut state = self.inner.state.lock();
+            if state.available > 0 {
+                state.available -= 1;
+                state.running_seconds += estimate;
+                let extra = extra.min(state.available);
+                state.available -= extra;
+                return Ok(self.permits(1 + extra, estimate));
+            }
+
+            // Queued work of the same or a higher class starts first
+            let ahead: f64 = state.queued_seconds[..=job.priority as usize].iter().sum();
+            let wait = Duration::from_secs_f64(
+                ((ahead + state.running_seconds) / self.inner.permits as f64).max(0.0),
+            );
+            if self
+                .inner
+                .queue_limit
+                .is_some_and(|limit| state.queued() >= limit)
+            {
+                metrics::global().solve_rejected(false);
+                return Err(Rejection::QueueFull { retry_after: wait });
+            }
+            let finish = Instant::now() + wait + Duration::from_secs_f64(estimate);
+            if job.deadline.is_some_and(|deadline| finish > deadline) {
+                metrics::global().solve_rejected(true);
+                return Err(Rejection::Deadline { retry_after: wait });
+            }
+
+            let (sender, grant) = oneshot::channel();
+            let id = state.next_id;
+            state.next_id += 1;
+            state.queued_seconds[job.priority as usize] += estimate;
+            state.queues[job.priority as usize].push_back(Waiter {
+                id,
+                job,
+                estimate,
+                grant: sender,
+            });
+            (id, grant)
+        };
+
+        let mut pending = PendingGrant {
+            inner: &self.inner,
+            id,
+            priority: job.priority,
+            estimate,
+            grant: Some(grant),
+        };
+        let granted = pending
+            .grant
+            .as_mut()
+            .expect("grant present until drop")
+            .await;
+        pending.grant = None;
+        match granted {
+            Ok(Ok(())) => {
+                let mut state = self.inner.state.lock();
+                let extra = if state.queued() == 0 {
+                    extra.min(state.available)
+                } else {
+                    0
+                };
+                state.available -= extra;
+                drop(state);
+                Ok(self.permits(1 + extra, estimate))
+            }
+            Ok(Err(rejection)) => Err(rejection),
+            // Senders are only dropped unsent for receivers that are gone
+            Err(_) => Err(Rejection::QueueFull {
+                retry_after: Duration::ZERO,
+            }),
+        }
+    }
+
+    /// Calibrate the cost model with the wall time of a finished solve
+    pub fn record(&self, units: f64, elapsed: Duration) {
+        if units <= 0.0 {
+            return;
+        }
+        let observed = elapsed.as_secs_f64() / units;
+        let _ = self.inner.seconds_per_unit.fetch_update(
+            Ordering::Relaxed,
+            Ordering::Relaxed,
+            |bits| {
+                let current = f64::from_bits(bits);
+                Some((current + CALIBRATION_WEIGHT * (observed - current)).to_bits())
+            },
+        );
+    }
+
+    /// Estimated solve seconds of `units`
+    fn estimate(&self, units: f64) -> f64 {
+        units * f64::from_bits(self.inner.seconds_per_unit.load(Ordering::Relaxed))
+    }
+
+    fn permits(&self, count: usize, estimate: f64) -> Permits {
+        Permits {
+            inner: Arc::clone(&self.inner),
+            count,
+            estimate,
+        }
+    }
+}
+
+impl Inner {
+    /// Hand `count` freed slots to the queued requests, highest class first
+    fn release(&self, count: usize, estimate: f64) {
+        let mut state = self.state.lock();
+        state.running_seconds = (state.running_seconds - estimate).max(0.0);
+        let mut free = count;
+        while free > 0 {
+            let Some(waiter) = PRIORITIES
+                .iter()
+                .find_map(|&priority| state.queues[priority as usize].pop_front())
+            else {
+                break;
+            };
+            let class = waiter.job.priority as usize;
+            state.queued_seconds[class] = (state.queued_seconds[class] - waiter.estimate).max(0.0);
+
+            // Waiting used up the time this request had
+            let finish = Instant::now() + Duration::from_secs_f64(waiter.estimate);
+            if waiter
+                .job
+                .deadline
+                .is_some_and(|deadline| finish > deadline)
+            {
+                metrics::global().solve_rejected(true);
+                let _ = waiter.grant.send(Err(Rejection::Deadline {
+                    retry_after: Duration::from_secs_f64(
+                        state.running_seconds / self.permits as f64,
+                    ),
+                }));
+                continue;
+            }
+            if waiter.grant.send(Ok(())).is_ok() {
+                state.running_seconds += waiter.estimate;
+                free -= 1;
+            }
+        }
+        state.available += free;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_thread_budget_split_by_policy() {
+        assert_eq!(
+            ThreadBudget::new(8, ThreadPolicy::Throughput, None),
+            ThreadBudget {
+                cores: 8,
+                slots: 8,
+                threads_per_slot: 1,
+            }
+        );
+        assert_eq!(
+            ThreadBudget::new(8, ThreadPolicy::Latency, None),
+            ThreadBudget {
+                cores: 8,
+                slots: 1,
+                threads_per_slot: 8,
+            }
+        );
+        // Explicit slots win; more slots than cores still get one thread
+        assert_eq!(
+            ThreadBudget::new(8, ThreadPolicy::Latency, Some(3)).threads_per_slot,
+            2
+        );
+        assert_eq!(
+            ThreadBudget::new(2, ThreadPolicy::Latency, Some(4)).threads_per_slot,
+            1
+        );
+    }
+
+    fn job(priority: Priority) -> Job {
+        Job {
+            priority,
+            units: 1.0,
+            deadline: None,
+        }
+    }
+
+    fn scheduler(permits: usize, queue_limit: Option<usize>) -> Scheduler {
+        Scheduler::new(SchedulerConfig {
+            permits,
+            queue_limit,
+        })
+    }
+
+    #[tokio::test]
+    async fn test_higher_priority_is_served_first() {
+        let scheduler = scheduler(1, None);
+        let running = scheduler.acquire(job(Priority::Normal), 0).await.unwrap();
+
+        let order = Mutex::new(Vec::new());
+        let waiter = |priority| {
+            let (scheduler, order) = (&scheduler, &order);
+            async move {
+                let permits = scheduler.acquire(job(priority), 0).await.unwrap();
+                order.lock().push(priority);
+                drop(permits);
+            }
+        };
+        tokio::join!(waiter(Priority::Low), waiter(Priority::High), async {
+            tokio::task::yield_now().await;
+            drop(running);
+        });
+        assert_eq!(*order.lock(), vec![Priority::High, Priority::Low]);
+        assert_eq!(scheduler.available(), 1);
+    }
+
+    #[tokio::test]
+    async fn test_full_queue_rejects() {
+        let scheduler = scheduler(1, Some(0));
+        let _running = scheduler.acquire(job(Priority::Normal), 0).await.unwrap();
+        let rejected = scheduler.acquire(job(Priority::High), 0).await;
+        assert!(matches!(rejected, Err(Rejection::QueueFull { .. })));
+    }
+
+    #[tokio::test]
+    async fn test_request_that_cannot_meet_its_deadline_is_rejected() {
+        let scheduler = scheduler(1, None);
+        // Calibrate to one second per unit
+        for _ in 0..200 {
+            scheduler.record(1.0, Duration::from_secs(1));
+        }
+        let _running = scheduler.acquire(job(Priority::Normal), 0).await.unwrap();
+
+        let urgent = Job {
+            deadline: Some(Instant::now() + Duration::from_millis(500)),
+            ..job(Priority::High)
+        };
+        let rejected = scheduler.acquire(urgent, 0).await;
+        assert!(
+            matches!(rejected, Err(Rejection::Deadline { retry_after }) if retry_after > Duration::ZERO)
+        );
+    }
+
+    #[tokio::test]
+    async fn test_cancelled_waiter_leaves_the_queue() {
+        let scheduler = scheduler(1, Some(1));
+        let running = scheduler.acquire(job(Priority::Normal), 0).await.unwrap();
+        {
+            let waiting = scheduler.acquire(job(Priority::Normal), 0);
+            let cancelled = tokio::time::timeout(Duration::from_millis(10), waiting).await;
+            assert!(cancelled.is_err());
+        }
+        // The cancelled request no longer counts against the limit
+        drop(running);
+        let permits = scheduler.acquire(job(Priority::Normal), 3).await.unwrap();
+        assert_eq!(permits.count(), 1);
+        assert_eq!(scheduler.available(), 0);
+    }
+}
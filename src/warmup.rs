@@ -0,0 +1,203 @@
+//! Model cache warm-up at startup.
+//!
+//! The warm-up file is a JSONL file of `/solve` request bodies, the format
+//! recorded for `BENCH_CAPTURE` and replayed by `examples/replay.rs`. Their
+//! polyhedra are built into the model cache before `/health` reports ready.
+//!
+//! A snapshot lists the model cache keys (`Fingerprint::structure`) that
+//! were cached when the previous process shut down. When one exists, only
+//! the warm-up polyhedra it lists are built, most valuable first, so a
+//! restart warms the set that was actually in use.
+
+use crate::domain::fingerprint::Fingerprint;
+use crate::domain::solver::Solver;
+use crate::domain::validate::validate_solve_request;
+use crate::models::{SolveRequest, SparseLEIntegerPolyhedron};
+use std::collections::{HashMap, HashSet};
+use std::io;
+use std::path::Path;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Arc;
+
+/// Valid polyhedra of a warm-up file with distinct structure, in file order.
+///
+/// Lines that do not parse or fail validation are skipped and counted in
+/// the second return value.
+pub fn read_requests(
+    path: &Path,
+) -> io::Result<(Vec<(Fingerprint, SparseLEIntegerPolyhedron)>, usize)> {
+    let content = std::fs::read_to_string(path)?;
+    let mut seen = HashSet::new();
+    let mut polyhedra = Vec::new();
+    let mut skipped = 0;
+    for line in content.lines().filter(|line| !line.trim().is_empty()) {
+        let request: SolveRequest = match serde_json::from_str(line) {
+            Ok(request) => request,
+            Err(_) => {
+                skipped += 1;
+                continue;
+            }
+        };
+        if validate_solve_request(&request).is_err() {
+            skipped += 1;
+            continue;
+        }
+        let fingerprint = Fingerprint::of(&request.polyhedron);
+        if seen.insert(fingerprint.structure()) {
+            polyhedra.push((fingerprint, Arc::unwrap_or_clone(request.polyhedron)));
+        }
+    }
+    Ok((polyhedra, skipped))
+}
+
+/// Fingerprints listed in a snapshot file, or `None` if there is none yet
+pub fn read_snapshot(path: &Path) -> io::Result<Option<Vec<String>>> {
+    match std::fs::read_to_string(path) {
+        Ok(content) => Ok(Some(
+            content
+                .lines()
+                .map(str::trim)
+                .filter(|line| !line.is_empty())
+                .map(str::to_string)
+                .collect(),
+        )),
+        Err(e) if e.kind() == io::ErrorKind::NotFound => Ok(None),
+        Err(e) => Err(e),
+    }
+}
+
+/// Write `fingerprints` to a snapshot file, replacing it atomically
+pub fn write_snapshot(path: &Path, fingerprints: &[Fingerprint]) -> io::Result<()> {
+    let content: String = fingerprints
+        .iter()
+        .map(|fingerprint| format!("{}\n", fingerprint))
+        .collect();
+    let partial = path.with_extension("partial");
+    std::fs::write(&partial, content)?;
+    std::fs::rename(&partial, path)
+}
+
+/// Keep the polyhedra whose structure is listed in `snapshot`, in snapshot order
+pub fn select(
+    polyhedra: Vec<(Fingerprint, SparseLEIntegerPolyhedron)>,
+    snapshot: &[String],
+) -> Vec<(Fingerprint, SparseLEIntegerPolyhedron)> {
+    let rank: HashMap<&str, usize> = snapshot
+        .iter()
+        .enumerate()
+        .map(|(rank, fingerprint)| (fingerprint.as_str(), rank))
+        .collect();
+    let mut selected: Vec<_> = polyhedra
+        .into_iter()
+        .filter_map(|(fingerprint, polyhedron)| {
+            rank.get(fingerprint.structure().to_string().as_str())
+                .map(|&rank| (rank, fingerprint, polyhedron))
+        })
+        .collect();
+    selected.sort_unstable_by_key(|(rank, _, _)| *rank);
+    selected
+        .into_iter()
+        .map(|(_, fingerprint, polyhedron)| (fingerprint, polyhedron))
+        .collect()
+}
+
+/// Build the models of `polyhedra` on up to `threads` threads.
+///
+/// Returns the number of models that failed to build.
+pub fn warm_up(
+    solver: &dyn Solver,
+    polyhedra: &[(Fingerprint, SparseLEIntegerPolyhedron)],
+    threads: usize,
+    use_presolve: bool,
+) -> usize {
+    let next = AtomicUsize::new(0);
+    let failed = AtomicUsize::new(0);
+    std::thread::scope(|scope| {
+        for _ in 0..threads.clamp(1, polyhedra.len().max(1)) {
+            scope.spawn(|| {
+                while let Some((fingerprint, polyhedron)) =
+                    polyhedra.get(next.fetch_add(1, Ordering::Relaxed))
+                {
+                    if solver.warm(polyhedron, *fingerprint, use_presolve).is_err() {
+                        failed.fetch_add(1, Ordering::Relaxed);
+                    }
+                }
+            });
+        }
+    });
+    failed.into_inner()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::models::{ApiIntegerSparseMatrix, ApiShape, ApiVariable};
+    use serde_json::json;
+
+    fn polyhedron(coeff: i32) -> SparseLEIntegerPolyhedron {
+        SparseLEIntegerPolyhedron {
+            a: ApiIntegerSparseMatrix {
+                rows: vec![0],
+                cols: vec![0],
+                vals: vec![coeff],
+                shape: ApiShape { nrows: 1, ncols: 1 },
+            },
+            b: vec![1],
+            variables: vec![ApiVariable {
+                id: "x".to_string(),
+                bound: (0, 1),
+            }],
+        }
+    }
+
+    fn temp_path(name: &str) -> std::path::PathBuf {
+        std::env::temp_dir().join(format!("warmup-{}-{}", std::process::id(), name))
+    }
+
+    #[test]
+    fn test_read_requests_skips_duplicates_and_invalid_lines() {
+        let request = |coeff: i32| {
+            json!({
+                "polyhedron": polyhedron(coeff),
+                "objectives": [{"x": 1.0}],
+                "direction": "maximize"
+            })
+            .to_string()
+        };
+        let path = temp_path("requests.jsonl");
+        let lines = [request(1), "not json".to_string(), request(2), request(1)];
+        std::fs::write(&path, lines.join("\n")).unwrap();
+
+        let (polyhedra, skipped) = read_requests(&path).unwrap();
+        std::fs::remove_file(&path).unwrap();
+        let fingerprints: Vec<_> = polyhedra.iter().map(|(fp, _)| *fp).collect();
+        assert_eq!(
+            fingerprints,
+            vec![
+                Fingerprint::of(&polyhedron(1)),
+                Fingerprint::of(&polyhedron(2))
+            ]
+        );
+        assert_eq!(skipped, 1);
+    }
+
+    #[test]
+    fn test_snapshot_selects_and_orders_polyhedra() {
+        let polyhedra: Vec<_> = (1..=3)
+            .map(|coeff| (Fingerprint::of(&polyhedron(coeff)), polyhedron(coeff)))
+            .collect();
+        let path = temp_path("snapshot");
+        assert!(read_snapshot(&path).unwrap().is_none());
+
+        let keys = [polyhedra[2].0.structure(), polyhedra[0].0.structure()];
+        write_snapshot(&path, &keys).unwrap();
+        let snapshot = read_snapshot(&path).unwrap().unwrap();
+        std::fs::remove_file(&path).unwrap();
+
+        let selected: Vec<_> = select(polyhedra.clone(), &snapshot)
+            .into_iter()
+            .map(|(fp, _)| fp)
+            .collect();
+        assert_eq!(selected, vec![polyhedra[2].0, polyhedra[0].0]);
+    }
+}
@@ -91,6 +91,24 @@ async fn test_health_endpoint() {
     assert_eq!(body, "OK");
 }
 
+#[tokio::test]
+#[serial]
+async fn test_metrics_endpoint() {
+    let _server = TestServer::start();
+    let client = reqwest::Client::new();
+
+    let response = client
+        .get(&format!("{}/metrics", _server.base_url()))
+        .send()
+        .await
+        .expect("Failed to send request");
+
+    assert_eq!(response.status(), 200);
+    let body = response.text().await.expect("Failed to read response body");
+    assert!(body.contains("# TYPE solver_phase_duration_seconds histogram"));
+    assert!(body.contains("solver_queue_depth{solver="));
+}
+
 #[tokio::test]
 #[serial]
 async fn test_solve_valid_request() {
@@ -204,6 +222,300 @@ async fn test_solve_minimize_direction() {
     assert!(body["solutions"].is_array());
 }
 
+#[tokio::test]
+#[serial]
+async fn test_solve_identical_concurrent_requests_share_result() {
+    let _server = TestServer::start();
+    let client = reqwest::Client::new();
+
+    let request_body = json!({
+        "polyhedron": {
+            "A": {
+                "rows": [0, 0],
+                "cols": [0, 1],
+                "vals": [1, 1],
+                "shape": {"nrows": 1, "ncols": 2}
+            },
+            "b": [1],
+            "variables": [
+                {"id": "x1", "bound": [0, 1]},
+                {"id": "x2", "bound": [0, 1]}
+            ]
+        },
+        "objectives": [
+            {"x1": 1, "x2": 2}
+        ],
+        "direction": "maximize"
+    });
+
+    let url = format!("{}/solve", _server.base_url());
+    let (first, second) = tokio::join!(
+        client.post(&url).json(&request_body).send(),
+        client.post(&url).json(&request_body).send()
+    );
+    let first = first.expect("Failed to send request");
+    let second = second.expect("Failed to send request");
+    assert_eq!(first.status(), 200);
+    assert_eq!(second.status(), 200);
+
+    let first: serde_json::Value = first.json().await.expect("Failed to parse JSON response");
+    let second: serde_json::Value = second.json().await.expect("Failed to parse JSON response");
+    assert_eq!(first, second);
+    assert_eq!(first["solutions"][0]["solution"]["x2"], 1);
+}
+
+#[tokio::test]
+#[serial]
+async fn test_solve_indexed_objectives_return_dense_solutions() {
+    let _server = TestServer::start();
+    let client = reqwest::Client::new();
+
+    let request_body = json!({
+        "polyhedron": {
+            "A": {
+                "rows": [0, 0],
+                "cols": [0, 1],
+                "vals": [1, 1],
+                "shape": {"nrows": 1, "ncols": 2}
+            },
+            "b": [1],
+            "variables": [
+                {"id": "x1", "bound": [0, 1]},
+                {"id": "x2", "bound": [0, 1]}
+            ]
+        },
+        "objectives": [
+            [[1, 1.0]]
+        ],
+        "direction": "maximize"
+    });
+
+    let response = client
+        .post(&format!("{}/solve", _server.base_url()))
+        .json(&request_body)
+        .send()
+        .await
+        .expect("Failed to send request");
+
+    assert_eq!(response.status(), 200);
+
+    let body: serde_json::Value = response
+        .json()
+        .await
+        .expect("Failed to parse JSON response");
+
+    assert_eq!(body["solutions"][0]["solution"], json!([0, 1]));
+}
+
+#[tokio::test]
+#[serial]
+async fn test_solve_stream_returns_one_line_per_objective() {
+    let _server = TestServer::start();
+    let client = reqwest::Client::new();
+
+    let request_body = json!({
+        "polyhedron": {
+            "A": {
+                "rows": [0, 0],
+                "cols": [0, 1],
+                "vals": [1, 1],
+                "shape": {"nrows": 1, "ncols": 2}
+            },
+            "b": [2],
+            "variables": [
+                {"id": "x1", "bound": [0, 5]},
+                {"id": "x2", "bound": [0, 5]}
+            ]
+        },
+        "objectives": [
+            {"x1": 1},
+            {"x1": 1, "x2": 1},
+            {"x2": 1}
+        ],
+        "direction": "maximize"
+    });
+
+    let response = client
+        .post(&format!("{}/solve/stream", _server.base_url()))
+        .json(&request_body)
+        .send()
+        .await
+        .expect("Failed to send request");
+
+    assert_eq!(response.status(), 200);
+    assert_eq!(response.headers()["content-type"], "application/x-ndjson");
+
+    let body = response.text().await.expect("Failed to read response body");
+    let mut indices: Vec<u64> = body
+        .lines()
+        .map(|line| {
+            let event: serde_json::Value =
+                serde_json::from_str(line).expect("Failed to parse JSON line");
+            assert!(event["solution"].is_object());
+            event["index"].as_u64().expect("index is a number")
+        })
+        .collect();
+    indices.sort();
+    assert_eq!(indices, vec![0, 1, 2]);
+}
+
+#[tokio::test]
+#[serial]
+async fn test_solve_stream_invalid_objective_returns_422() {
+    let _server = TestServer::start();
+    let client = reqwest::Client::new();
+
+    let request_body = json!({
+        "polyhedron": {
+            "A": {
+                "rows": [0],
+                "cols": [0],
+                "vals": [1],
+                "shape": {"nrows": 1, "ncols": 1}
+            },
+            "b": [1],
+            "variables": [
+                {"id": "x1", "bound": [0, 1]}
+            ]
+        },
+        "objectives": [
+            {"unknown": 1}
+        ],
+        "direction": "maximize"
+    });
+
+    let response = client
+        .post(&format!("{}/solve/stream", _server.base_url()))
+        .json(&request_body)
+        .send()
+        .await
+        .expect("Failed to send request");
+
+    assert_eq!(response.status(), 422);
+}
+
+#[tokio::test]
+#[serial]
+async fn test_solve_batch_returns_one_line_per_item() {
+    let _server = TestServer::start();
+    let client = reqwest::Client::new();
+
+    let item = |id: &str, objective: serde_json::Value| {
+        json!({
+            "id": id,
+            "polyhedron": {
+                "A": {
+                    "rows": [0, 0],
+                    "cols": [0, 1],
+                    "vals": [1, 1],
+                    "shape": {"nrows": 1, "ncols": 2}
+                },
+                "b": [1],
+                "variables": [
+                    {"id": "x1", "bound": [0, 1]},
+                    {"id": "x2", "bound": [0, 1]}
+                ]
+            },
+            "objectives": [objective],
+            "direction": "maximize"
+        })
+    };
+    let request_body = json!([
+        item("first", json!({"x1": 1})),
+        item("second", json!({"x2": 1})),
+        item("invalid", json!({"unknown": 1}))
+    ]);
+
+    let response = client
+        .post(&format!("{}/solve/batch", _server.base_url()))
+        .json(&request_body)
+        .send()
+        .await
+        .expect("Failed to send request");
+
+    assert_eq!(response.status(), 200);
+    assert_eq!(response.headers()["content-type"], "application/x-ndjson");
+
+    let body = response.text().await.expect("Failed to read response body");
+    let mut lines: Vec<serde_json::Value> = body
+        .lines()
+        .map(|line| serde_json::from_str(line).expect("Failed to parse JSON line"))
+        .collect();
+    lines.sort_by_key(|line| line["id"].as_str().unwrap_or_default().to_string());
+    assert_eq!(lines.len(), 3);
+    assert_eq!(
+        lines[0]["solutions"][0]["solution"],
+        json!({"x1": 1, "x2": 0})
+    );
+    assert!(lines[1]["error"].is_string());
+    assert_eq!(
+        lines[2]["solutions"][0]["solution"],
+        json!({"x1": 0, "x2": 1})
+    );
+}
+
+#[tokio::test]
+#[serial]
+async fn test_registered_model_solve_and_delete() {
+    let _server = TestServer::start();
+    let client = reqwest::Client::new();
+
+    let register_body = json!({
+        "polyhedron": {
+            "A": {
+                "rows": [0, 0],
+                "cols": [0, 1],
+                "vals": [1, 1],
+                "shape": {"nrows": 1, "ncols": 2}
+            },
+            "b": [1],
+            "variables": [
+                {"id": "x1", "bound": [0, 1]},
+                {"id": "x2", "bound": [0, 1]}
+            ]
+        }
+    });
+    let response = client
+        .post(&format!("{}/models", _server.base_url()))
+        .json(&register_body)
+        .send()
+        .await
+        .expect("Failed to send request");
+    assert_eq!(response.status(), 201);
+    let registered: serde_json::Value = response.json().await.expect("Failed to parse JSON");
+    let id = registered["id"].as_str().expect("id is a string").to_string();
+
+    let solve_url = format!("{}/models/{}/solve", _server.base_url(), id);
+    let solve_body = json!({
+        "objectives": [{"x2": 1}],
+        "direction": "maximize"
+    });
+    let response = client
+        .post(&solve_url)
+        .json(&solve_body)
+        .send()
+        .await
+        .expect("Failed to send request");
+    assert_eq!(response.status(), 200);
+    let body: serde_json::Value = response.json().await.expect("Failed to parse JSON");
+    assert_eq!(body["solutions"][0]["solution"], json!({"x1": 0, "x2": 1}));
+
+    let response = client
+        .delete(&format!("{}/models/{}", _server.base_url(), id))
+        .send()
+        .await
+        .expect("Failed to send request");
+    assert_eq!(response.status(), 204);
+
+    let response = client
+        .post(&solve_url)
+        .json(&solve_body)
+        .send()
+        .await
+        .expect("Failed to send request");
+    assert_eq!(response.status(), 404);
+}
+
 #[tokio::test]
 #[serial]
 async fn test_nonexistent_endpoint() {